@@ -5,6 +5,7 @@
 #ifndef CARBON_EXPLORER_AST_AST_NODE_H_
 #define CARBON_EXPLORER_AST_AST_NODE_H_
 
+#include "common/check.h"
 #include "explorer/ast/ast_rtti.h"
 #include "explorer/base/source_location.h"
 #include "llvm/Support/Casting.h"
@@ -66,6 +67,18 @@ class AstNode : public Printable<AstNode> {
   // The location of the code described by this node.
   auto source_loc() const -> SourceLocation { return source_loc_; }
 
+  // A number identifying this node among those in the same Arena, which holds
+  // a single program. Ids are assigned densely by the Arena, including for
+  // clones, so side tables for AST nodes can be vectors indexed by id, sized by
+  // `Arena::num_numbered()`.
+  auto id() const -> int {
+    CARBON_CHECK(id_ >= 0) << "AST node not allocated in an Arena";
+    return id_;
+  }
+
+  // Enables `Arena` to number AST nodes.
+  using EnableNumberedAllocation = void;
+
  protected:
   // Constructs an AstNode representing code at the given location. `kind`
   // must be the enumerator that exactly matches the concrete type being
@@ -82,8 +95,13 @@ class AstNode : public Printable<AstNode> {
   auto root_kind() const -> AstNodeKind { return kind_; }
 
  private:
+  friend class Arena;
+
+  void set_arena_id(int id) { id_ = id; }
+
   AstNodeKind kind_;
   SourceLocation source_loc_;
+  int id_ = -1;
 };
 
 }  // namespace Carbon
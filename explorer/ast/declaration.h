@@ -5,6 +5,7 @@
 #ifndef CARBON_EXPLORER_AST_DECLARATION_H_
 #define CARBON_EXPLORER_AST_DECLARATION_H_
 
+#include <atomic>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -106,13 +107,13 @@ class Declaration : public AstNode {
   }
 
   // Returns whether this node has been fully type-checked.
-  auto is_type_checked() const -> bool { return is_type_checked_; }
+  auto is_type_checked() const -> bool { return is_type_checked_.load(); }
 
   // Set that this node is type-checked. Should only be called once, by the
   // type-checker, once full type-checking is complete.
   void set_is_type_checked() {
-    CARBON_CHECK(!is_type_checked_) << "should not be type-checked twice";
-    is_type_checked_ = true;
+    bool was_type_checked = is_type_checked_.exchange(true);
+    CARBON_CHECK(!was_type_checked) << "should not be type-checked twice";
   }
 
  protected:
@@ -127,13 +128,14 @@ class Declaration : public AstNode {
         static_type_(context.Clone(other.static_type_)),
         constant_value_(context.Clone(other.constant_value_)),
         is_declared_(other.is_declared_),
-        is_type_checked_(other.is_type_checked_) {}
+        is_type_checked_(other.is_type_checked_.load()) {}
 
  private:
   std::optional<Nonnull<const Value*>> static_type_;
   std::optional<Nonnull<const Value*>> constant_value_;
   bool is_declared_ = false;
-  bool is_type_checked_ = false;
+  // Function bodies may be type-checked on several threads.
+  std::atomic<bool> is_type_checked_ = false;
 };
 
 // Determine whether two declarations declare the same entity.
@@ -45,6 +45,9 @@ auto IntrinsicExpression::FindIntrinsic(std::string_view name,
        {"int_right_shift", Intrinsic::IntRightShift},
        {"str_eq", Intrinsic::StrEq},
        {"str_compare", Intrinsic::StrCompare},
+       {"str_concat", Intrinsic::StrConcat},
+       {"str_length", Intrinsic::StrLength},
+       {"str_slice", Intrinsic::StrSlice},
        {"assert", Intrinsic::Assert}});
   name.remove_prefix(std::strlen("__intrinsic_"));
   auto it = intrinsic_map.find(name);
@@ -91,6 +94,12 @@ auto IntrinsicExpression::name() const -> std::string_view {
       return "__intrinsic_str_eq";
     case IntrinsicExpression::Intrinsic::StrCompare:
       return "__intrinsic_str_compare";
+    case IntrinsicExpression::Intrinsic::StrConcat:
+      return "__intrinsic_str_concat";
+    case IntrinsicExpression::Intrinsic::StrLength:
+      return "__intrinsic_str_length";
+    case IntrinsicExpression::Intrinsic::StrSlice:
+      return "__intrinsic_str_slice";
     case IntrinsicExpression::Intrinsic::Assert:
       return "__intrinsic_assert";
   }
@@ -6,8 +6,10 @@
 #define CARBON_EXPLORER_AST_EXPRESSION_H_
 
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -21,6 +23,7 @@
 #include "explorer/ast/value_node.h"
 #include "explorer/base/arena.h"
 #include "explorer/base/source_location.h"
+#include "explorer/base/string_buffer.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/Compiler.h"
 
@@ -535,21 +538,31 @@ class BoolLiteral : public Expression {
 
 class StringLiteral : public Expression {
  public:
-  explicit StringLiteral(SourceLocation source_loc, std::string value)
+  explicit StringLiteral(SourceLocation source_loc, std::string_view value)
       : Expression(AstNodeKind::StringLiteral, source_loc),
-        value_(std::move(value)) {}
+        storage_(StringBuffer::Make(value)),
+        value_(storage_->prefix(value.size())) {}
 
   explicit StringLiteral(CloneContext& context, const StringLiteral& other)
-      : Expression(context, other), value_(other.value_) {}
+      : Expression(context, other),
+        storage_(other.storage_),
+        value_(other.value_) {}
 
   static auto classof(const AstNode* node) -> bool {
     return InheritsFromStringLiteral(node->kind());
   }
 
-  auto value() const -> const std::string& { return value_; }
+  auto value() const -> std::string_view { return value_; }
+
+  // The storage that `value()` points into, which is shared with the
+  // `StringValue`s that evaluating this literal produces.
+  auto storage() const -> const std::shared_ptr<StringBuffer>& {
+    return storage_;
+  }
 
  private:
-  std::string value_;
+  std::shared_ptr<StringBuffer> storage_;
+  std::string_view value_;
 };
 
 class StringTypeLiteral : public Expression {
@@ -865,6 +878,9 @@ class IntrinsicExpression : public RewritableMixin<Expression> {
     IntEq,
     StrEq,
     StrCompare,
+    StrConcat,
+    StrLength,
+    StrSlice,
     IntCompare,
     IntBitAnd,
     IntBitOr,
@@ -24,6 +24,7 @@
 namespace Carbon {
 
 class CallableDeclaration;
+class MatchDecisionTree;
 
 class Statement : public AstNode {
  public:
@@ -561,7 +562,8 @@ class Match : public Statement {
   explicit Match(CloneContext& context, const Match& other)
       : Statement(context, other),
         expression_(context.Clone(other.expression_)),
-        clauses_(context.Clone(other.clauses_)) {}
+        clauses_(context.Clone(other.clauses_)),
+        decision_tree_(other.decision_tree_) {}
 
   static auto classof(const AstNode* node) -> bool {
     return InheritsFromMatch(node->kind());
@@ -577,9 +579,22 @@ class Match : public Statement {
     expression_ = expression;
   }
 
+  // The decision tree used to select clauses, if the type checker could build
+  // one. Otherwise each clause is tried in turn.
+  auto decision_tree() const
+      -> std::optional<Nonnull<const MatchDecisionTree*>> {
+    return decision_tree_;
+  }
+
+  // Can only be called by type-checking.
+  void set_decision_tree(Nonnull<const MatchDecisionTree*> decision_tree) {
+    decision_tree_ = decision_tree;
+  }
+
  private:
   Nonnull<Expression*> expression_;
   std::vector<Clause> clauses_;
+  std::optional<Nonnull<const MatchDecisionTree*>> decision_tree_;
 };
 
 }  // namespace Carbon
@@ -16,6 +16,7 @@
 #include "explorer/ast/value_transform.h"
 #include "explorer/base/arena.h"
 #include "explorer/base/error_builders.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Casting.h"
@@ -92,6 +93,10 @@ struct NestedValueVisitor {
   auto Visit(Address) -> bool { return true; }
   auto Visit(ExpressionCategory) -> bool { return true; }
   auto Visit(const std::string&) -> bool { return true; }
+  auto Visit(std::string_view) -> bool { return true; }
+  auto Visit(const std::shared_ptr<StringBuffer>&) -> bool {
+    return true;
+  }
   auto Visit(Nonnull<const NominalClassValue**>) -> bool {
     // This is the pointer to the most-derived value within a class value,
     // which is not "within" this value, so we shouldn't visit it.
@@ -836,6 +841,207 @@ void IntrinsicConstraint::Print(llvm::raw_ostream& out) const {
   }
 }
 
+namespace {
+// Computes the structural hash of a value from the parts that `TypeEqual` and
+// `ValueEqual` compare. Anything those functions compare by identity, such as
+// declarations, is hashed by address.
+struct StructuralHasher {
+  auto Hash(Nonnull<const Value*> value) -> llvm::hash_code {
+    has_dependent_parts |= value->has_dependent_parts();
+    return value->structural_hash();
+  }
+
+  auto Hash(const BindingMap& map) -> llvm::hash_code {
+    llvm::hash_code hash = llvm::hash_value(map.size());
+    for (const auto& [binding, value] : map) {
+      hash = llvm::hash_combine(hash, binding, Hash(value));
+    }
+    return hash;
+  }
+
+  auto Hash(std::optional<Nonnull<const Statement*>> body) -> llvm::hash_code {
+    return llvm::hash_value(body ? *body : nullptr);
+  }
+
+  auto Compute(const Value& value) -> llvm::hash_code;
+
+  bool has_dependent_parts = false;
+};
+}  // namespace
+
+auto StructuralHasher::Compute(const Value& value) -> llvm::hash_code {
+  llvm::hash_code kind = llvm::hash_value(static_cast<int>(value.kind()));
+  switch (value.kind()) {
+    case Value::Kind::PointerType:
+      return llvm::hash_combine(
+          kind, Hash(&cast<PointerType>(value).pointee_type()));
+    case Value::Kind::FunctionType: {
+      const auto& fn = cast<FunctionType>(value);
+      llvm::hash_code hash = llvm::hash_combine(
+          kind, Hash(&fn.parameters()), Hash(&fn.return_type()));
+      if (auto self = fn.method_self()) {
+        hash = llvm::hash_combine(hash, self->addr_self, Hash(self->self_type));
+      }
+      return hash;
+    }
+    case Value::Kind::StructType: {
+      llvm::hash_code hash = kind;
+      for (const NamedValue& field : cast<StructType>(value).fields()) {
+        hash = llvm::hash_combine(hash, field.name, Hash(field.value));
+      }
+      return hash;
+    }
+    case Value::Kind::NominalClassType: {
+      const auto& class_type = cast<NominalClassType>(value);
+      return llvm::hash_combine(kind, &class_type.declaration(),
+                                Hash(class_type.bindings().args()));
+    }
+    case Value::Kind::InterfaceType: {
+      const auto& iface = cast<InterfaceType>(value);
+      return llvm::hash_combine(kind, &iface.declaration(),
+                                Hash(iface.bindings().args()));
+    }
+    case Value::Kind::NamedConstraintType: {
+      const auto& constraint = cast<NamedConstraintType>(value);
+      return llvm::hash_combine(kind, &constraint.declaration(),
+                                Hash(constraint.bindings().args()));
+    }
+    case Value::Kind::ConstraintType: {
+      const auto& constraint = cast<ConstraintType>(value);
+      llvm::hash_code hash = kind;
+      for (const auto& impls : constraint.impls_constraints()) {
+        hash = llvm::hash_combine(hash, Hash(impls.type),
+                                  Hash(impls.interface));
+      }
+      for (const auto& equality : constraint.equality_constraints()) {
+        hash = llvm::hash_combine(hash, equality.values.size());
+        for (Nonnull<const Value*> equal_value : equality.values) {
+          hash = llvm::hash_combine(hash, Hash(equal_value));
+        }
+      }
+      for (const auto& context : constraint.lookup_contexts()) {
+        hash = llvm::hash_combine(hash, Hash(context.context));
+      }
+      return hash;
+    }
+    case Value::Kind::ChoiceType: {
+      const auto& choice = cast<ChoiceType>(value);
+      return llvm::hash_combine(kind, &choice.declaration(),
+                                Hash(choice.type_args()));
+    }
+    case Value::Kind::TupleType:
+    case Value::Kind::TupleValue: {
+      llvm::hash_code hash = kind;
+      for (Nonnull<const Value*> element :
+           cast<TupleValueBase>(value).elements()) {
+        hash = llvm::hash_combine(hash, Hash(element));
+      }
+      return hash;
+    }
+    case Value::Kind::VariableType:
+      has_dependent_parts = true;
+      return llvm::hash_combine(kind, &cast<VariableType>(value).binding());
+    case Value::Kind::StaticArrayType: {
+      const auto& array = cast<StaticArrayType>(value);
+      return llvm::hash_combine(kind, Hash(&array.element_type()),
+                                array.has_size() ? array.size() : 0);
+    }
+    case Value::Kind::AssociatedConstant: {
+      // The witness value is not part of determining value equality.
+      has_dependent_parts = true;
+      const auto& assoc = cast<AssociatedConstant>(value);
+      return llvm::hash_combine(kind, &assoc.constant(), Hash(&assoc.base()),
+                                Hash(&assoc.interface()));
+    }
+    case Value::Kind::IntValue:
+      return llvm::hash_combine(kind, cast<IntValue>(value).value());
+    case Value::Kind::BoolValue:
+      return llvm::hash_combine(kind, cast<BoolValue>(value).value());
+    case Value::Kind::StringValue:
+      return llvm::hash_combine(
+          kind, llvm::StringRef(cast<StringValue>(value).value()));
+    case Value::Kind::FunctionValue:
+      return llvm::hash_combine(
+          kind, Hash(cast<FunctionValue>(value).declaration().body()));
+    case Value::Kind::BoundMethodValue: {
+      const auto& method = cast<BoundMethodValue>(value);
+      return llvm::hash_combine(kind, Hash(method.receiver()),
+                                Hash(method.declaration().body()));
+    }
+    case Value::Kind::StructValue: {
+      llvm::hash_code hash = kind;
+      for (const NamedValue& element : cast<StructValue>(value).elements()) {
+        hash = llvm::hash_combine(hash, element.name, Hash(element.value));
+      }
+      return hash;
+    }
+    case Value::Kind::AlternativeValue: {
+      const auto& alt = cast<AlternativeValue>(value);
+      llvm::hash_code hash =
+          llvm::hash_combine(kind, Hash(&alt.choice()), &alt.alternative());
+      if (alt.argument()) {
+        hash = llvm::hash_combine(hash, Hash(*alt.argument()));
+      }
+      return hash;
+    }
+    case Value::Kind::ParameterizedEntityName: {
+      std::optional<std::string_view> name =
+          GetName(cast<ParameterizedEntityName>(value).declaration());
+      return llvm::hash_combine(kind, llvm::StringRef(name.value_or("")));
+    }
+    case Value::Kind::IntType:
+    case Value::Kind::BoolType:
+    case Value::Kind::TypeType:
+    case Value::Kind::StringType:
+    case Value::Kind::AutoType:
+    case Value::Kind::DestructorValue:
+    case Value::Kind::NominalClassValue:
+    case Value::Kind::AlternativeConstructorValue:
+    case Value::Kind::PointerValue:
+    case Value::Kind::LocationValue:
+    case Value::Kind::ReferenceExpressionValue:
+    case Value::Kind::BindingPlaceholderValue:
+    case Value::Kind::AddrValue:
+    case Value::Kind::UninitializedValue:
+    case Value::Kind::MemberName:
+    case Value::Kind::TypeOfParameterizedEntityName:
+    case Value::Kind::TypeOfMemberName:
+    case Value::Kind::MixinPseudoType:
+    case Value::Kind::TypeOfMixinPseudoType:
+    case Value::Kind::TypeOfNamespaceName:
+    case Value::Kind::ImplWitness:
+    case Value::Kind::BindingWitness:
+    case Value::Kind::ConstraintWitness:
+    case Value::Kind::ConstraintImplWitness:
+      // These are either only equal to values of the same kind, or aren't
+      // compared structurally.
+      return kind;
+  }
+}
+
+auto Value::ComputeHashState() const -> uint64_t {
+  StructuralHasher hasher;
+  uint64_t hash = static_cast<size_t>(hasher.Compute(*this));
+  uint64_t state = (hash << HashShift) | HashComputedBit;
+  if (hasher.has_dependent_parts) {
+    state |= HashDependentBit;
+  }
+  hash_state_.store(state, std::memory_order_relaxed);
+  return state;
+}
+
+// Returns false if the structural hashes of `v1` and `v2` show that they're
+// not equal, which avoids walking both values when they differ.
+static auto MayBeEqual(
+    Nonnull<const Value*> v1, Nonnull<const Value*> v2,
+    std::optional<Nonnull<const EqualityContext*>> equality_ctx) -> bool {
+  if (equality_ctx &&
+      (v1->has_dependent_parts() || v2->has_dependent_parts())) {
+    return true;
+  }
+  return v1->structural_hash() == v2->structural_hash();
+}
+
 // Check whether two binding maps, which are assumed to have the same keys, are
 // equal.
 static auto BindingMapEqual(
@@ -856,6 +1062,9 @@ auto TypeEqual(Nonnull<const Value*> t1, Nonnull<const Value*> t2,
   if (t1 == t2) {
     return true;
   }
+  if (!MayBeEqual(t1, t2, equality_ctx)) {
+    return false;
+  }
   if (t1->kind() != t2->kind()) {
     if (IsValueKindDependent(t1) || IsValueKindDependent(t2)) {
       return ValueEqual(t1, t2, equality_ctx);
@@ -1185,6 +1394,9 @@ auto ValueEqual(Nonnull<const Value*> v1, Nonnull<const Value*> v2,
   if (v1 == v2) {
     return true;
   }
+  if (!MayBeEqual(v1, v2, equality_ctx)) {
+    return false;
+  }
 
   // If we're given an equality context, check to see if it knows these values
   // are equal. Only perform the check if one or the other value is an
@@ -5,8 +5,12 @@
 #ifndef CARBON_EXPLORER_AST_VALUE_H_
 #define CARBON_EXPLORER_AST_VALUE_H_
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -18,7 +22,9 @@
 #include "explorer/ast/element_path.h"
 #include "explorer/ast/expression_category.h"
 #include "explorer/ast/statement.h"
+#include "explorer/base/arena.h"
 #include "explorer/base/nonnull.h"
+#include "explorer/base/string_buffer.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
 
@@ -102,13 +108,42 @@ class Value : public Printable<Value> {
   // object.
   auto kind() const -> Kind { return kind_; }
 
+  // Returns a hash of the parts of this value that `TypeEqual` and
+  // `ValueEqual` compare, so that values they consider equal without an
+  // equality context have the same hash. Computed on first use and cached.
+  auto structural_hash() const -> uint64_t {
+    return GetHashState() >> HashShift;
+  }
+
+  // Returns whether this value contains a value whose kind depends on a
+  // generic parameter. An equality context can find such a value to be equal
+  // to a value with a different structural hash.
+  auto has_dependent_parts() const -> bool {
+    return (GetHashState() & HashDependentBit) != 0;
+  }
+
  protected:
   // Constructs a Value. `kind` must be the enumerator corresponding to the
   // most-derived type being constructed.
   explicit Value(Kind kind) : kind_(kind) {}
 
  private:
+  static constexpr uint64_t HashComputedBit = 1;
+  static constexpr uint64_t HashDependentBit = 2;
+  static constexpr int HashShift = 2;
+
+  // Returns `hash_state_`, computing it if needed.
+  auto GetHashState() const -> uint64_t {
+    uint64_t state = hash_state_.load(std::memory_order_relaxed);
+    return (state & HashComputedBit) ? state : ComputeHashState();
+  }
+  auto ComputeHashState() const -> uint64_t;
+
   const Kind kind_;
+  // The structural hash, followed by `HashDependentBit` and `HashComputedBit`.
+  // Values are shared between threads, and may compute this concurrently; they
+  // all store the same result.
+  mutable std::atomic<uint64_t> hash_state_ = 0;
 };
 
 // Returns whether the fully-resolved kind that this value will eventually have
@@ -1573,11 +1608,54 @@ class StringType : public Value {
   }
 };
 
+// Canonicalize string values by the identity of their storage and the
+// position of their characters in it, so that allocating one doesn't copy or
+// hash the characters.
+template <>
+struct ArgKey<std::shared_ptr<StringBuffer>> {
+  using type = struct StringBufferProxy {
+    StringBufferProxy(std::shared_ptr<StringBuffer> storage)
+        : storage(std::move(storage)) {}
+    friend auto operator==(const StringBufferProxy& lhs,
+                           const StringBufferProxy& rhs) -> bool {
+      return lhs.storage == rhs.storage;
+    }
+    friend auto hash_value(const StringBufferProxy& proxy) -> llvm::hash_code {
+      return llvm::hash_value(proxy.storage.get());
+    }
+
+    std::shared_ptr<StringBuffer> storage;
+  };
+};
+
+template <>
+struct ArgKey<std::string_view> {
+  using type = struct StringViewProxy {
+    StringViewProxy(std::string_view str) : str(str) {}
+    friend auto operator==(StringViewProxy lhs, StringViewProxy rhs) -> bool {
+      return lhs.str.data() == rhs.str.data() &&
+             lhs.str.size() == rhs.str.size();
+    }
+    friend auto hash_value(StringViewProxy proxy) -> llvm::hash_code {
+      return llvm::hash_combine(proxy.str.data(), proxy.str.size());
+    }
+
+    std::string_view str;
+  };
+};
+
 // A string value.
+//
+// The characters are held in reference-counted, append-only storage, so that
+// copying a string value, or taking a substring of it, doesn't copy them, and
+// appending to a string that ends at the end of its storage doesn't copy the
+// string.
 class StringValue : public Value {
  public:
-  explicit StringValue(std::string value)
-      : Value(Kind::StringValue), value_(std::move(value)) {}
+  // Makes a string value for `value`, which must point into `storage`.
+  explicit StringValue(std::shared_ptr<StringBuffer> storage,
+                       std::string_view value)
+      : Value(Kind::StringValue), storage_(std::move(storage)), value_(value) {}
 
   static auto classof(const Value* value) -> bool {
     return value->kind() == Kind::StringValue;
@@ -1585,13 +1663,19 @@ class StringValue : public Value {
 
   template <typename F>
   auto Decompose(F f) const {
-    return f(value_);
+    return f(storage_, value_);
   }
 
-  auto value() const -> const std::string& { return value_; }
+  auto value() const -> std::string_view { return value_; }
+
+  // The storage that `value()` points into.
+  auto storage() const -> const std::shared_ptr<StringBuffer>& {
+    return storage_;
+  }
 
  private:
-  std::string value_;
+  std::shared_ptr<StringBuffer> storage_;
+  std::string_view value_;
 };
 
 class TypeOfMixinPseudoType : public Value {
@@ -0,0 +1,223 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "explorer/ast/value.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "explorer/ast/bindings.h"
+#include "explorer/ast/declaration.h"
+#include "explorer/ast/expression.h"
+#include "explorer/ast/impl_binding.h"
+#include "explorer/ast/pattern.h"
+#include "explorer/base/arena.h"
+
+namespace Carbon {
+namespace {
+
+static auto FakeSourceLoc(int line_num) -> SourceLocation {
+  return SourceLocation("<test>", line_num, FileKind::Main);
+}
+
+// An equality context which knows that each pair of values is equal.
+class FakeEqualityContext : public EqualityContext {
+ public:
+  explicit FakeEqualityContext(
+      std::vector<std::pair<Nonnull<const Value*>, Nonnull<const Value*>>>
+          equal_values)
+      : equal_values_(std::move(equal_values)) {}
+
+  auto VisitEqualValues(
+      Nonnull<const Value*> value,
+      llvm::function_ref<bool(Nonnull<const Value*>)> visitor) const
+      -> bool override {
+    for (auto [value1, value2] : equal_values_) {
+      if (value == value1 && !visitor(value2)) {
+        return false;
+      }
+      if (value == value2 && !visitor(value1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  std::vector<std::pair<Nonnull<const Value*>, Nonnull<const Value*>>>
+      equal_values_;
+};
+
+// `TypeEqual` and `ValueEqual` reject values with different structural hashes
+// without comparing them, unless an equality context may apply. These tests
+// build values which are equal but not identical, and check that their hashes
+// agree.
+class ValueTest : public ::testing::Test {
+ protected:
+  auto MakeGenericBinding(std::string name) -> Nonnull<GenericBinding*> {
+    return arena.New<GenericBinding>(loc, std::move(name),
+                                     arena.New<TypeTypeLiteral>(loc),
+                                     GenericBinding::BindingKind::Checked);
+  }
+
+  // Returns a witness for a new impl binding, so each call returns a different
+  // witness.
+  auto MakeWitness() -> Nonnull<const Witness*> {
+    return arena.New<BindingWitness>(
+        arena.New<ImplBinding>(loc, t_binding, std::nullopt));
+  }
+
+  // Returns `C(T = arg)`. Each call creates new bindings, so the class types
+  // that are returned are equal but not identical.
+  auto MakeClassType(Nonnull<const Value*> arg,
+                     std::optional<Nonnull<const Value*>> witness =
+                         std::nullopt) -> Nonnull<const NominalClassType*> {
+    ImplWitnessMap witnesses;
+    if (witness) {
+      witnesses.insert({t_impl_binding, *witness});
+    }
+    auto* bindings =
+        arena.New<Bindings>(BindingMap{{t_binding, arg}}, std::move(witnesses));
+    return arena.New<NominalClassType>(class_decl, bindings, std::nullopt,
+                                       EmptyVTable());
+  }
+
+  // Checks that `value1` and `value2` are equal and have the same hash, but
+  // aren't the same value.
+  void ExpectEqualWithSameHash(Nonnull<const Value*> value1,
+                               Nonnull<const Value*> value2) {
+    EXPECT_NE(value1, value2);
+    EXPECT_TRUE(TypeEqual(value1, value2, std::nullopt));
+    EXPECT_TRUE(ValueEqual(value1, value2, std::nullopt));
+    EXPECT_EQ(value1->structural_hash(), value2->structural_hash());
+  }
+
+  Arena arena;
+  SourceLocation loc = FakeSourceLoc(1);
+  Nonnull<GenericBinding*> t_binding = MakeGenericBinding("T");
+  Nonnull<const ImplBinding*> t_impl_binding =
+      arena.New<ImplBinding>(loc, t_binding, std::nullopt);
+  Nonnull<const ClassDeclaration*> class_decl = arena.New<ClassDeclaration>(
+      loc, DeclaredName(loc, "C"), arena.New<SelfDeclaration>(loc),
+      ClassExtensibility::None, std::nullopt,
+      std::vector<Nonnull<Declaration*>>());
+  Nonnull<const InterfaceDeclaration*> interface_decl =
+      arena.New<InterfaceDeclaration>(&arena, loc, DeclaredName(loc, "I"),
+                                      std::nullopt,
+                                      std::vector<Nonnull<Declaration*>>());
+  Nonnull<const Value*> int_type = arena.New<IntType>();
+  Nonnull<const Value*> bool_type = arena.New<BoolType>();
+};
+
+TEST_F(ValueTest, NominalClassTypeWithBindings) {
+  ExpectEqualWithSameHash(MakeClassType(int_type), MakeClassType(int_type));
+  // Witnesses aren't compared.
+  ExpectEqualWithSameHash(MakeClassType(int_type, MakeWitness()),
+                          MakeClassType(int_type));
+  // Bindings are compared structurally.
+  ExpectEqualWithSameHash(MakeClassType(MakeClassType(bool_type)),
+                          MakeClassType(MakeClassType(bool_type)));
+
+  EXPECT_FALSE(
+      TypeEqual(MakeClassType(int_type), MakeClassType(bool_type), std::nullopt));
+}
+
+TEST_F(ValueTest, StructTypeFieldNames) {
+  auto make_struct = [&](std::string name) {
+    return arena.New<StructType>(std::vector<NamedValue>{
+        {std::move(name), MakeClassType(int_type)},
+        {"y", MakeClassType(bool_type)}});
+  };
+  ExpectEqualWithSameHash(make_struct("x"), make_struct("x"));
+
+  EXPECT_FALSE(TypeEqual(make_struct("x"), make_struct("z"), std::nullopt));
+}
+
+TEST_F(ValueTest, FunctionTypeWithMethodSelf) {
+  auto make_method = [&](bool addr_self) {
+    return arena.New<FunctionType>(
+        FunctionType::MethodSelf{.addr_self = addr_self,
+                                 .self_type = MakeClassType(int_type)},
+        arena.New<TupleType>(
+            std::vector<Nonnull<const Value*>>{MakeClassType(bool_type)}),
+        MakeClassType(int_type));
+  };
+  ExpectEqualWithSameHash(make_method(false), make_method(false));
+  ExpectEqualWithSameHash(make_method(true), make_method(true));
+
+  EXPECT_FALSE(TypeEqual(make_method(false), make_method(true), std::nullopt));
+}
+
+TEST_F(ValueTest, AssociatedConstantWithoutEqualityContext) {
+  auto* constant_decl =
+      arena.New<AssociatedConstantDeclaration>(loc, MakeGenericBinding("N"));
+  auto* interface_type = arena.New<InterfaceType>(interface_decl);
+  // The witness isn't compared.
+  auto make_constant = [&]() {
+    return arena.New<AssociatedConstant>(MakeClassType(int_type),
+                                         interface_type, constant_decl,
+                                         MakeWitness());
+  };
+  ExpectEqualWithSameHash(make_constant(), make_constant());
+  EXPECT_TRUE(make_constant()->has_dependent_parts());
+}
+
+TEST_F(ValueTest, VariableTypeWithoutEqualityContext) {
+  auto* variable_type = arena.New<VariableType>(t_binding);
+  auto make_tuple = [&]() {
+    return arena.New<TupleType>(std::vector<Nonnull<const Value*>>{
+        variable_type, MakeClassType(int_type)});
+  };
+  ExpectEqualWithSameHash(make_tuple(), make_tuple());
+  EXPECT_TRUE(make_tuple()->has_dependent_parts());
+}
+
+TEST_F(ValueTest, AssociatedConstantWithEqualityContext) {
+  auto* constant_decl =
+      arena.New<AssociatedConstantDeclaration>(loc, MakeGenericBinding("N"));
+  auto* constant = arena.New<AssociatedConstant>(
+      int_type, arena.New<InterfaceType>(interface_decl), constant_decl,
+      MakeWitness());
+  auto* class_type = MakeClassType(int_type);
+  FakeEqualityContext equality_ctx({{constant, class_type}});
+
+  // The hashes differ, but the equality context makes the values equal, so
+  // they must not be rejected by hash.
+  EXPECT_NE(constant->structural_hash(), class_type->structural_hash());
+  EXPECT_TRUE(TypeEqual(constant, class_type, &equality_ctx));
+  EXPECT_TRUE(ValueEqual(class_type, constant, &equality_ctx));
+  EXPECT_FALSE(TypeEqual(constant, class_type, std::nullopt));
+
+  // The same holds for values containing them.
+  EXPECT_TRUE(TypeEqual(
+      arena.New<PointerType>(constant),
+      arena.New<PointerType>(MakeClassType(int_type)), &equality_ctx));
+}
+
+TEST_F(ValueTest, VariableTypeWithEqualityContext) {
+  auto* variable_type = arena.New<VariableType>(t_binding);
+  FakeEqualityContext equality_ctx({{variable_type, int_type}});
+
+  EXPECT_NE(variable_type->structural_hash(), int_type->structural_hash());
+  EXPECT_TRUE(TypeEqual(variable_type, int_type, &equality_ctx));
+  EXPECT_FALSE(TypeEqual(variable_type, int_type, std::nullopt));
+
+  auto make_struct = [&](Nonnull<const Value*> field_type) {
+    return arena.New<StructType>(
+        std::vector<NamedValue>{{"x", field_type}});
+  };
+  EXPECT_TRUE(TypeEqual(make_struct(variable_type), make_struct(int_type),
+                        &equality_ctx));
+  EXPECT_TRUE(TypeEqual(MakeClassType(variable_type), MakeClassType(int_type),
+                        &equality_ctx));
+  EXPECT_FALSE(TypeEqual(MakeClassType(variable_type), MakeClassType(int_type),
+                         std::nullopt));
+}
+
+}  // namespace
+}  // namespace Carbon
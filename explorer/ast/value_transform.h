@@ -181,6 +181,14 @@ class TransformBase {
   }
   auto operator()(const std::string& str) -> const std::string& { return str; }
   auto operator()(llvm::StringRef str) -> llvm::StringRef { return str; }
+  auto operator()(std::string_view str) -> std::string_view { return str; }
+
+  // Characters in string storage never change once written, so the storage is
+  // shared by the transformed value.
+  auto operator()(const std::shared_ptr<StringBuffer>& str)
+      -> std::shared_ptr<StringBuffer> {
+    return str;
+  }
 
   // Transform `optional<T>` by transforming the `T` if it's present.
   template <typename T>
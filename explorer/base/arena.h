@@ -8,6 +8,7 @@
 #include <any>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -42,6 +43,11 @@ class Arena {
   template <typename T, typename = void>
   struct CanonicalizeAllocation;
 
+  // NumberAllocation<T>::value is true if numbering is enabled for T, and
+  // false otherwise.
+  template <typename T, typename = void>
+  struct NumberAllocation;
+
  public:
   // Values of this type can be passed as the first argument to New in order to
   // have the address of the created object written to the given pointer before
@@ -76,6 +82,12 @@ class Arena {
   // Canonicalization does not guarantee that equal objects will be identical,
   // but it can substantially reduce the incidence of equal-but-not-identical
   // objects, which can facilitate various optimizations.
+  //
+  // If T::EnableNumberedAllocation exists and names a type, each allocated
+  // object is numbered by calling its `set_arena_id` with the count of
+  // numbered objects allocated by this arena before it. The numbers are dense,
+  // so side tables for those objects can be vectors indexed by number. T must
+  // befriend Arena if `set_arena_id` is private.
   template <
       typename T, typename... Args,
       typename std::enable_if_t<std::is_constructible_v<T, Args...> &&
@@ -96,6 +108,19 @@ class Arena {
 
   auto allocated() -> int64_t { return allocated_; }
 
+  // Returns the number of numbered objects allocated so far, which is one more
+  // than the largest number given out.
+  auto num_numbered() const -> int { return num_numbered_; }
+
+  // Sets whether objects may be allocated from several threads at once. This
+  // must only be changed while no other thread is using the arena.
+  //
+  // Objects are constructed without holding a lock, so that threads only
+  // contend on bookkeeping. When two threads canonically allocate equal
+  // objects at once, both are constructed but only one is kept and returned to
+  // both threads.
+  auto set_thread_safe(bool thread_safe) -> void { thread_safe_ = thread_safe; }
+
  private:
   // Virtualizes arena entries so that a single vector can contain many types,
   // avoiding templated statics.
@@ -139,20 +164,39 @@ class Arena {
   template <typename T, typename... Args>
   auto UniqueNew(Args&&... args) -> Nonnull<T*>;
 
-  // Returns a pointer to the canonical instance of T constructed from
-  // `args...`, or null if there is no such instance yet. Returns a mutable
-  // reference so that a null entry can be updated.
-  template <typename T, typename... Args>
-  auto CanonicalInstance(const Args&... args) -> const T*&;
+  // Takes ownership of a newly constructed object, numbering it if numbering
+  // is enabled for T. `mutex_` must be held if the arena is thread-safe.
+  template <typename T>
+  auto AddEntry(std::unique_ptr<ArenaEntryTyped<T>> entry) -> Nonnull<T*>;
+
+  // Returns this arena's instance of the canonicalization table `MapType`,
+  // creating it if necessary. `mutex_` must be held if the arena is
+  // thread-safe.
+  template <typename MapType>
+  auto CanonicalTable() -> MapType&;
+
+  // Returns a lock on `mutex_` if the arena is thread-safe, and an empty lock
+  // otherwise.
+  auto LockIfThreadSafe() -> std::unique_lock<std::mutex> {
+    return thread_safe_ ? std::unique_lock(mutex_)
+                        : std::unique_lock<std::mutex>();
+  }
 
   // Manages allocations in an arena for destruction at shutdown.
   std::vector<std::unique_ptr<ArenaEntry>> arena_;
   int64_t allocated_ = 0;
+  int num_numbered_ = 0;
 
   // Maps a CanonicalizationTable type to a unique instance of that type for
   // this arena. For a key equal to &TypeId<T>::id for some T, the corresponding
   // value contains a T*.
   std::map<char*, std::any> canonical_tables_;
+
+  // Guards `arena_`, the counters and the canonicalization tables while the
+  // arena is thread-safe. It's never held while an object is constructed or
+  // destroyed.
+  bool thread_safe_ = false;
+  std::mutex mutex_;
 };
 
 // ---------------------------------------
@@ -200,11 +244,28 @@ template <typename T, typename... Args,
           typename std::enable_if_t<std::is_constructible_v<T, Args...> &&
                                     Arena::CanonicalizeAllocation<T>::value>*>
 auto Arena::New(Args&&... args) -> Nonnull<const T*> {
-  const T*& canonical_instance = CanonicalInstance<T>(args...);
-  if (canonical_instance == nullptr) {
-    canonical_instance = UniqueNew<T>(std::forward<Args>(args)...);
+  using MapType = CanonicalizationTable<T, std::remove_cvref_t<Args>...>;
+  typename MapType::key_type key(args...);
+  {
+    auto lock = LockIfThreadSafe();
+    MapType& table = CanonicalTable<MapType>();
+    if (auto it = table.find(key); it != table.end()) {
+      return it->second;
+    }
   }
-  return canonical_instance;
+
+  // Another thread may add an equal instance while this one is constructed,
+  // in which case that instance is returned and this one is destroyed after
+  // the lock is released.
+  auto smart_ptr =
+      std::make_unique<ArenaEntryTyped<T>>(std::forward<Args>(args)...);
+  auto lock = LockIfThreadSafe();
+  auto [it, inserted] = CanonicalTable<MapType>().try_emplace(
+      std::move(key), smart_ptr->Instance());
+  if (inserted) {
+    AddEntry(std::move(smart_ptr));
+  }
+  return it->second;
 }
 
 template <typename T, typename U, typename... Args,
@@ -212,19 +273,30 @@ template <typename T, typename U, typename... Args,
 void Arena::New(WriteAddressTo<U> addr, Args&&... args) {
   static_assert(!CanonicalizeAllocation<T>::value,
                 "This form of New does not support canonicalization yet");
-  arena_.push_back(
-      std::make_unique<ArenaEntryTyped<T>>(addr, std::forward<Args>(args)...));
-  allocated_ += sizeof(T);
+  auto smart_ptr =
+      std::make_unique<ArenaEntryTyped<T>>(addr, std::forward<Args>(args)...);
+  auto lock = LockIfThreadSafe();
+  AddEntry(std::move(smart_ptr));
 }
 
 template <typename T, typename... Args>
 auto Arena::UniqueNew(Args&&... args) -> Nonnull<T*> {
   auto smart_ptr =
       std::make_unique<ArenaEntryTyped<T>>(std::forward<Args>(args)...);
-  Nonnull<T*> ptr = smart_ptr->Instance();
-  arena_.push_back(std::move(smart_ptr));
+  auto lock = LockIfThreadSafe();
+  return AddEntry(std::move(smart_ptr));
+}
+
+template <typename T>
+auto Arena::AddEntry(std::unique_ptr<ArenaEntryTyped<T>> entry)
+    -> Nonnull<T*> {
+  Nonnull<T*> instance = entry->Instance();
+  if constexpr (NumberAllocation<T>::value) {
+    instance->set_arena_id(num_numbered_++);
+  }
+  arena_.push_back(std::move(entry));
   allocated_ += sizeof(T);
-  return ptr;
+  return instance;
 }
 
 template <typename T, typename>
@@ -235,15 +307,21 @@ struct Arena::CanonicalizeAllocation<
     T, std::void_t<typename T::EnableCanonicalizedAllocation>>
     : public std::true_type {};
 
-template <typename T, typename... Args>
-auto Arena::CanonicalInstance(const Args&... args) -> const T*& {
-  using MapType = CanonicalizationTable<T, Args...>;
+template <typename T, typename>
+struct Arena::NumberAllocation : public std::false_type {};
+
+template <typename T>
+struct Arena::NumberAllocation<
+    T, std::void_t<typename T::EnableNumberedAllocation>>
+    : public std::true_type {};
+
+template <typename MapType>
+auto Arena::CanonicalTable() -> MapType& {
   std::any& wrapped_table = canonical_tables_[&TypeId<MapType>::id];
   if (!wrapped_table.has_value()) {
     wrapped_table.emplace<MapType>();
   }
-  MapType& table = std::any_cast<MapType&>(wrapped_table);
-  return table[typename MapType::key_type(args...)];
+  return std::any_cast<MapType&>(wrapped_table);
 }
 
 // Templated destruction of a pointer.
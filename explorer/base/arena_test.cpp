@@ -93,4 +93,49 @@ TEST(ArenaTest, CanonicalizeStdTypes) {
   EXPECT_TRUE(dummy1 != dummy3);
 }
 
+class NumberedDummy {
+ public:
+  explicit NumberedDummy(Arena* arena, int num_children) {
+    for (int i = 0; i < num_children; ++i) {
+      children.push_back(arena->New<NumberedDummy>(arena, 0));
+    }
+  }
+
+  using EnableNumberedAllocation = void;
+
+  auto id() const -> int { return id_; }
+
+  std::vector<NumberedDummy*> children;
+
+ private:
+  friend class Arena;
+
+  void set_arena_id(int id) { id_ = id; }
+
+  int id_ = -1;
+};
+
+TEST(ArenaTest, Number) {
+  bool destroyed = false;
+  Arena arena;
+  auto* dummy1 = arena.New<NumberedDummy>(&arena, 0);
+  // Objects of other types aren't numbered.
+  (void)arena.New<ReportDestruction>(&destroyed);
+  auto* dummy2 = arena.New<NumberedDummy>(&arena, 2);
+  EXPECT_EQ(dummy1->id(), 0);
+  // Objects are numbered once constructed, so after the objects their
+  // constructors allocate.
+  EXPECT_EQ(dummy2->children[0]->id(), 1);
+  EXPECT_EQ(dummy2->children[1]->id(), 2);
+  EXPECT_EQ(dummy2->id(), 3);
+  EXPECT_EQ(arena.num_numbered(), 4);
+}
+
+TEST(ArenaTest, NumberDifferentArenas) {
+  Arena arena1;
+  Arena arena2;
+  (void)arena1.New<NumberedDummy>(&arena1, 0);
+  EXPECT_EQ(arena2.New<NumberedDummy>(&arena2, 0)->id(), 0);
+}
+
 }  // namespace Carbon
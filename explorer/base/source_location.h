@@ -45,6 +45,8 @@ class SourceLocation : public Printable<SourceLocation> {
 
   auto filename() const -> std::string_view { return filename_; }
 
+  auto line_num() const -> int { return line_num_; }
+
   auto file_kind() const -> FileKind { return file_kind_; }
 
   void Print(llvm::raw_ostream& out) const {
@@ -0,0 +1,82 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_EXPLORER_BASE_STRING_BUFFER_H_
+#define CARBON_EXPLORER_BASE_STRING_BUFFER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "common/check.h"
+
+namespace Carbon {
+
+// Reference-counted, append-only storage for the characters of strings.
+//
+// Characters are never changed or moved once they're written, so views into a
+// buffer stay valid while more characters are appended to it. A string that's
+// built by repeatedly appending to the previous result can then share one
+// buffer, instead of being copied by each append.
+class StringBuffer {
+ public:
+  // Makes a buffer that initially contains `str`, with room for at least
+  // `capacity` characters in total.
+  static auto Make(std::string_view str, size_t capacity = 0)
+      -> std::shared_ptr<StringBuffer> {
+    return std::make_shared<StringBuffer>(str, std::max(capacity, str.size()));
+  }
+
+  // Use `Make` instead.
+  explicit StringBuffer(std::string_view str, size_t capacity)
+      : data_(new char[capacity]), capacity_(capacity), size_(str.size()) {
+    CARBON_CHECK(str.size() <= capacity);
+    std::memcpy(data_.get(), str.data(), str.size());
+  }
+
+  StringBuffer(const StringBuffer&) = delete;
+  auto operator=(const StringBuffer&) -> StringBuffer& = delete;
+
+  // Returns a view of the first `size` characters of the buffer, which must
+  // have been written.
+  auto prefix(size_t size) const -> std::string_view {
+    return std::string_view(data_.get(), size);
+  }
+
+  // `str` must be a view into this buffer. If `str` ends where the buffer's
+  // contents end, and there's room for `suffix`, appends `suffix` and returns a
+  // view of `str` followed by `suffix`. Otherwise returns nullopt, and the
+  // caller should copy `str` and `suffix` into a new buffer.
+  //
+  // This is safe to call on several threads at once; only one of several
+  // appends to the same end will succeed.
+  auto TryAppend(std::string_view str, std::string_view suffix)
+      -> std::optional<std::string_view> {
+    size_t end = str.data() + str.size() - data_.get();
+    CARBON_CHECK(end <= capacity_) << "String isn't in this buffer";
+    if (suffix.size() > capacity_ - end) {
+      return std::nullopt;
+    }
+    size_t expected = end;
+    if (!size_.compare_exchange_strong(expected, end + suffix.size())) {
+      return std::nullopt;
+    }
+    std::memcpy(data_.get() + end, suffix.data(), suffix.size());
+    return std::string_view(str.data(), str.size() + suffix.size());
+  }
+
+ private:
+  std::unique_ptr<char[]> data_;
+  size_t capacity_;
+  // The number of characters that have been written, or claimed by an append
+  // that's writing them.
+  std::atomic<size_t> size_;
+};
+
+}  // namespace Carbon
+
+#endif  // CARBON_EXPLORER_BASE_STRING_BUFFER_H_
@@ -0,0 +1,65 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "explorer/base/string_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace Carbon {
+namespace {
+
+TEST(StringBufferTest, Prefix) {
+  auto buffer = StringBuffer::Make("hello");
+  EXPECT_EQ(buffer->prefix(5), "hello");
+  EXPECT_EQ(buffer->prefix(2), "he");
+}
+
+TEST(StringBufferTest, AppendAtEnd) {
+  auto buffer = StringBuffer::Make("ab", 8);
+  std::string_view ab = buffer->prefix(2);
+  std::optional<std::string_view> abc = buffer->TryAppend(ab, "c");
+  ASSERT_TRUE(abc.has_value());
+  EXPECT_EQ(*abc, "abc");
+  std::optional<std::string_view> abcde = buffer->TryAppend(*abc, "de");
+  ASSERT_TRUE(abcde.has_value());
+  EXPECT_EQ(*abcde, "abcde");
+  // The characters are shared.
+  EXPECT_EQ(abcde->data(), ab.data());
+  // Earlier views are unchanged.
+  EXPECT_EQ(ab, "ab");
+  EXPECT_EQ(*abc, "abc");
+}
+
+TEST(StringBufferTest, AppendNotAtEnd) {
+  auto buffer = StringBuffer::Make("ab", 8);
+  std::string_view ab = buffer->prefix(2);
+  ASSERT_TRUE(buffer->TryAppend(ab, "c").has_value());
+  // `ab` is no longer the end of the buffer, so appending to it again would
+  // overwrite the `c`.
+  EXPECT_FALSE(buffer->TryAppend(ab, "x").has_value());
+  EXPECT_FALSE(buffer->TryAppend(ab.substr(0, 1), "x").has_value());
+}
+
+TEST(StringBufferTest, AppendFull) {
+  auto buffer = StringBuffer::Make("ab", 3);
+  std::string_view ab = buffer->prefix(2);
+  EXPECT_FALSE(buffer->TryAppend(ab, "cd").has_value());
+  std::optional<std::string_view> abc = buffer->TryAppend(ab, "c");
+  ASSERT_TRUE(abc.has_value());
+  EXPECT_EQ(*abc, "abc");
+  EXPECT_FALSE(buffer->TryAppend(*abc, "d").has_value());
+}
+
+TEST(StringBufferTest, AppendToSubstring) {
+  auto buffer = StringBuffer::Make("abc", 8);
+  std::string_view bc = buffer->prefix(3).substr(1);
+  std::optional<std::string_view> bcd = buffer->TryAppend(bc, "d");
+  ASSERT_TRUE(bcd.has_value());
+  EXPECT_EQ(*bcd, "bcd");
+}
+
+}  // namespace
+}  // namespace Carbon
@@ -0,0 +1,286 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "explorer/base/trace_log.h"
+
+#include <vector>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/LEB128.h"
+
+namespace Carbon {
+
+TraceLogWriter::TraceLogWriter(Nonnull<llvm::raw_ostream*> out) : out_(out) {
+  buffer_.reserve(BufferSize);
+  buffer_.append(TraceLogMagic.begin(), TraceLogMagic.end());
+}
+
+auto TraceLogWriter::BeginEvent(TraceLogEvent event, ProgramPhase phase,
+                                FileKind file_kind) -> void {
+  if (buffer_.size() >= BufferSize) {
+    Flush();
+  }
+  buffer_.push_back(static_cast<char>(event));
+  buffer_.push_back(static_cast<char>(phase));
+  buffer_.push_back(static_cast<char>(file_kind));
+}
+
+auto TraceLogWriter::WriteInt(uint64_t value) -> void {
+  uint8_t bytes[16];
+  unsigned size = llvm::encodeULEB128(value, bytes);
+  buffer_.append(reinterpret_cast<const char*>(bytes), size);
+}
+
+auto TraceLogWriter::WriteString(llvm::StringRef value) -> void {
+  WriteInt(value.size());
+  buffer_.append(value.begin(), value.end());
+}
+
+auto TraceLogWriter::WriteObjectRef(
+    ObjectKey key, llvm::function_ref<void(llvm::raw_ostream&)> print)
+    -> void {
+  auto [it, inserted] = object_ids_.insert({key, next_id_});
+  if (!inserted) {
+    WriteInt(it->second * 2);
+    return;
+  }
+  ++next_id_;
+  WriteInt(it->second * 2 + 1);
+  object_text_.clear();
+  llvm::raw_string_ostream text(object_text_);
+  print(text);
+  WriteString(object_text_);
+}
+
+auto TraceLogWriter::WriteSourceLocation(
+    std::optional<SourceLocation> source_loc) -> void {
+  std::pair<const char*, int> key = {nullptr, 0};
+  if (source_loc) {
+    key = {source_loc->filename().data(), source_loc->line_num()};
+  }
+  auto [it, inserted] = source_loc_ids_.insert({key, next_id_});
+  if (!inserted) {
+    WriteInt(it->second * 2);
+    return;
+  }
+  ++next_id_;
+  WriteInt(it->second * 2 + 1);
+  object_text_.clear();
+  llvm::raw_string_ostream text(object_text_);
+  text << source_loc;
+  WriteString(object_text_);
+}
+
+auto TraceLogWriter::Flush() -> void {
+  *out_ << buffer_;
+  buffer_.clear();
+}
+
+namespace {
+
+// Reads the records of a trace log.
+class TraceLogReader {
+ public:
+  explicit TraceLogReader(llvm::StringRef log) : log_(log) {}
+
+  auto at_end() const -> bool { return log_.empty(); }
+
+  // Consumes `TraceLogMagic` if it's next, resetting object ids.
+  auto ConsumeMagic() -> bool {
+    if (!log_.consume_front(TraceLogMagic)) {
+      return false;
+    }
+    objects_.clear();
+    return true;
+  }
+
+  auto ReadByte() -> ErrorOr<uint8_t> {
+    if (log_.empty()) {
+      return Error("unexpected end of trace log");
+    }
+    uint8_t byte = log_.front();
+    log_ = log_.drop_front();
+    return byte;
+  }
+
+  auto ReadInt() -> ErrorOr<uint64_t> {
+    unsigned size = 0;
+    const char* error = nullptr;
+    uint64_t value = llvm::decodeULEB128(log_.bytes_begin(), &size,
+                                         log_.bytes_end(), &error);
+    if (error) {
+      return Error(llvm::formatv("malformed trace log: {0}", error).str());
+    }
+    log_ = log_.drop_front(size);
+    return value;
+  }
+
+  auto ReadString() -> ErrorOr<llvm::StringRef> {
+    CARBON_ASSIGN_OR_RETURN(uint64_t size, ReadInt());
+    if (size > log_.size()) {
+      return Error("unexpected end of trace log");
+    }
+    llvm::StringRef value = log_.take_front(size);
+    log_ = log_.drop_front(size);
+    return value;
+  }
+
+  // Reads an object reference, returning its text, or nothing for 0.
+  auto ReadObject() -> ErrorOr<std::optional<llvm::StringRef>> {
+    CARBON_ASSIGN_OR_RETURN(uint64_t ref, ReadInt());
+    if (ref == 0) {
+      return std::optional<llvm::StringRef>();
+    }
+    uint64_t id = ref / 2;
+    if (ref % 2 == 1) {
+      if (id != objects_.size() + 1) {
+        return Error("malformed trace log: unexpected object id");
+      }
+      CARBON_ASSIGN_OR_RETURN(llvm::StringRef text, ReadString());
+      objects_.push_back(text);
+      return std::optional(text);
+    }
+    if (id == 0 || id > objects_.size()) {
+      return Error("malformed trace log: unknown object id");
+    }
+    return std::optional(objects_[id - 1]);
+  }
+
+  // Reads an object reference which must be present.
+  auto ReadRequiredObject() -> ErrorOr<llvm::StringRef> {
+    CARBON_ASSIGN_OR_RETURN(std::optional<llvm::StringRef> text, ReadObject());
+    if (!text) {
+      return Error("malformed trace log: missing object");
+    }
+    return *text;
+  }
+
+ private:
+  llvm::StringRef log_;
+  std::vector<llvm::StringRef> objects_;
+};
+
+}  // namespace
+
+// Prints the payload of a `TraceLogEvent::Step` record, matching
+// `Interpreter::Step` and `Action::Print`.
+static auto DecodeStep(TraceLogReader& reader, llvm::raw_ostream& out)
+    -> ErrorOr<Success> {
+  CARBON_ASSIGN_OR_RETURN(llvm::StringRef kind, reader.ReadString());
+  CARBON_ASSIGN_OR_RETURN(uint64_t pos, reader.ReadInt());
+  out << "->> step " << kind << " pos: " << pos << " ";
+  CARBON_ASSIGN_OR_RETURN(std::optional<llvm::StringRef> subject,
+                          reader.ReadObject());
+  if (subject) {
+    out << "`" << *subject << "`";
+  }
+  CARBON_ASSIGN_OR_RETURN(uint64_t num_results, reader.ReadInt());
+  if (num_results > 0) {
+    out << " results: [";
+    llvm::ListSeparator sep;
+    for (uint64_t i = 0; i < num_results; ++i) {
+      CARBON_ASSIGN_OR_RETURN(llvm::StringRef result,
+                              reader.ReadRequiredObject());
+      out << sep << "`" << result << "`";
+    }
+    out << "] ";
+  }
+  CARBON_ASSIGN_OR_RETURN(uint64_t has_scope, reader.ReadInt());
+  if (has_scope) {
+    CARBON_ASSIGN_OR_RETURN(uint64_t num_locals, reader.ReadInt());
+    out << " scope: [";
+    llvm::ListSeparator sep;
+    for (uint64_t i = 0; i < num_locals; ++i) {
+      CARBON_ASSIGN_OR_RETURN(llvm::StringRef name,
+                              reader.ReadRequiredObject());
+      CARBON_ASSIGN_OR_RETURN(llvm::StringRef value,
+                              reader.ReadRequiredObject());
+      out << sep << "`" << name << "`: `" << value << "`";
+    }
+    out << "]";
+  }
+  CARBON_ASSIGN_OR_RETURN(llvm::StringRef source_loc,
+                          reader.ReadRequiredObject());
+  out << " (" << source_loc << ") --->\n";
+  return Success();
+}
+
+// Prints the payload of a `TraceLogEvent::Memory*` record, matching `Heap`.
+static auto DecodeMemoryEvent(TraceLogReader& reader, TraceLogEvent event,
+                              llvm::raw_ostream& out) -> ErrorOr<Success> {
+  CARBON_ASSIGN_OR_RETURN(uint64_t allocation, reader.ReadInt());
+  CARBON_ASSIGN_OR_RETURN(llvm::StringRef value, reader.ReadRequiredObject());
+  switch (event) {
+    case TraceLogEvent::MemoryAlloc:
+    case TraceLogEvent::MemoryAllocUninitialized:
+      out << "++# memory-alloc: ";
+      break;
+    case TraceLogEvent::MemoryRead:
+      out << "<-- memory-read: ";
+      break;
+    case TraceLogEvent::MemoryWrite:
+      out << "--> memory-write: ";
+      break;
+    case TraceLogEvent::MemoryDealloc:
+      out << "--# memory-dealloc: ";
+      break;
+    default:
+      CARBON_FATAL() << "not a memory event";
+  }
+  out << "#" << allocation << " `" << value << "`";
+  if (event == TraceLogEvent::MemoryAllocUninitialized) {
+    out << " uninitialized";
+  }
+  out << "\n";
+  return Success();
+}
+
+auto DecodeTraceLog(llvm::StringRef log,
+                    llvm::function_ref<bool(ProgramPhase, FileKind)> filter,
+                    llvm::raw_ostream& out) -> ErrorOr<Success> {
+  TraceLogReader reader(log);
+  if (!reader.ConsumeMagic()) {
+    return Error("not a trace log");
+  }
+  while (!reader.at_end()) {
+    if (reader.ConsumeMagic()) {
+      continue;
+    }
+    CARBON_ASSIGN_OR_RETURN(uint8_t event_byte, reader.ReadByte());
+    CARBON_ASSIGN_OR_RETURN(uint8_t phase, reader.ReadByte());
+    CARBON_ASSIGN_OR_RETURN(uint8_t file_kind, reader.ReadByte());
+    if (event_byte > static_cast<uint8_t>(TraceLogEvent::Last) ||
+        file_kind > static_cast<uint8_t>(FileKind::Last)) {
+      return Error("malformed trace log: unknown record");
+    }
+    auto event = static_cast<TraceLogEvent>(event_byte);
+    // Records which are filtered out are still decoded, because they may
+    // define objects used by later records.
+    llvm::raw_ostream& event_out = filter(static_cast<ProgramPhase>(phase),
+                                          static_cast<FileKind>(file_kind))
+                                       ? out
+                                       : llvm::nulls();
+    switch (event) {
+      case TraceLogEvent::Text: {
+        CARBON_ASSIGN_OR_RETURN(llvm::StringRef text, reader.ReadString());
+        event_out << text;
+        break;
+      }
+      case TraceLogEvent::Step:
+        CARBON_RETURN_IF_ERROR(DecodeStep(reader, event_out));
+        break;
+      case TraceLogEvent::MemoryAlloc:
+      case TraceLogEvent::MemoryAllocUninitialized:
+      case TraceLogEvent::MemoryRead:
+      case TraceLogEvent::MemoryWrite:
+      case TraceLogEvent::MemoryDealloc:
+        CARBON_RETURN_IF_ERROR(DecodeMemoryEvent(reader, event, event_out));
+        break;
+    }
+  }
+  return Success();
+}
+
+}  // namespace Carbon
@@ -0,0 +1,137 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_EXPLORER_BASE_TRACE_LOG_H_
+#define CARBON_EXPLORER_BASE_TRACE_LOG_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "common/error.h"
+#include "common/ostream.h"
+#include "explorer/base/print_as_id.h"
+#include "explorer/base/source_location.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace Carbon {
+
+enum class ProgramPhase;
+
+// The kinds of record in a binary trace log.
+//
+// A trace log starts with `TraceLogMagic`, followed by a sequence of records.
+// Each record is a `TraceLogEvent` byte, a `ProgramPhase` byte and a `FileKind`
+// byte, followed by a payload that depends on the event:
+//
+// - `Text`: a string holding text trace output.
+// - `Step`: the action kind name, position and subject object (0 if none), the
+//   result values, whether there's a scope followed by its locals as
+//   (name, value) pairs, and the source location.
+// - `Memory*`: an allocation index and a value.
+//
+// Integers are unsigned LEB128, and strings are a length followed by bytes.
+// Objects, such as values, AST nodes and source locations, are interned: the
+// first reference to an object holds its printed text, and later references
+// only hold its id. See `TraceLogWriter::WriteObjectRef` for the encoding.
+//
+// Several logs can be concatenated, such as the logs of each program in batch
+// mode; ids are reset at each `TraceLogMagic`.
+enum class TraceLogEvent : uint8_t {
+  Text,
+  Step,
+  MemoryAlloc,
+  MemoryAllocUninitialized,
+  MemoryRead,
+  MemoryWrite,
+  MemoryDealloc,
+  Last = MemoryDealloc,
+};
+
+inline constexpr llvm::StringLiteral TraceLogMagic = "CARBTRC1";
+
+// Writes a binary trace log to a stream, buffering output.
+//
+// Values and AST nodes are immutable while they're being traced and outlive
+// the trace, so they're interned by address and printed once. This avoids
+// most of the cost of printing the same values at every step.
+class TraceLogWriter {
+ public:
+  explicit TraceLogWriter(Nonnull<llvm::raw_ostream*> out);
+  ~TraceLogWriter() { Flush(); }
+
+  TraceLogWriter(const TraceLogWriter&) = delete;
+  auto operator=(const TraceLogWriter&) -> TraceLogWriter& = delete;
+
+  // Starts a new record. The payload is written by the other `Write*`
+  // methods.
+  auto BeginEvent(TraceLogEvent event, ProgramPhase phase, FileKind file_kind)
+      -> void;
+
+  auto WriteInt(uint64_t value) -> void;
+  auto WriteString(llvm::StringRef value) -> void;
+
+  // Writes a reference to `object`, printing it with `operator<<` the first
+  // time it's written.
+  template <typename T>
+  auto WriteObject(const T& object) -> void {
+    WriteObjectRef({&object, &ObjectTag<T>},
+                   [&](llvm::raw_ostream& out) { out << object; });
+  }
+
+  // Writes a reference to `object`, printing it with `PrintAsID` the first
+  // time it's written.
+  template <typename T>
+  auto WriteObjectAsID(const T& object) -> void {
+    WriteObjectRef({&object, &ObjectIDTag<T>},
+                   [&](llvm::raw_ostream& out) { out << PrintAsID(object); });
+  }
+
+  // Writes a reference to an optional source location, printing it the first
+  // time it's written.
+  auto WriteSourceLocation(std::optional<SourceLocation> source_loc) -> void;
+
+  // Writes buffered output to the stream.
+  auto Flush() -> void;
+
+ private:
+  // Distinguishes the objects of different types, or printed in different
+  // ways, which have the same address.
+  template <typename T>
+  static constexpr char ObjectTag = 0;
+  template <typename T>
+  static constexpr char ObjectIDTag = 0;
+
+  using ObjectKey = std::pair<const void*, const void*>;
+
+  // Writes `2 * id` for an object which has already been written. Otherwise,
+  // assigns it the next id and writes `2 * id + 1` followed by its text.
+  auto WriteObjectRef(ObjectKey key,
+                      llvm::function_ref<void(llvm::raw_ostream&)> print)
+      -> void;
+
+  static constexpr size_t BufferSize = 64 * 1024;
+
+  Nonnull<llvm::raw_ostream*> out_;
+  std::string buffer_;
+  llvm::DenseMap<ObjectKey, uint64_t> object_ids_;
+  // Source locations are keyed by filename and line, and share ids with
+  // objects.
+  llvm::DenseMap<std::pair<const char*, int>, uint64_t> source_loc_ids_;
+  uint64_t next_id_ = 1;
+  std::string object_text_;
+};
+
+// Decodes the trace logs in `log`, printing the records accepted by `filter`
+// to `out` in the same format as text trace output.
+auto DecodeTraceLog(llvm::StringRef log,
+                    llvm::function_ref<bool(ProgramPhase, FileKind)> filter,
+                    llvm::raw_ostream& out) -> ErrorOr<Success>;
+
+}  // namespace Carbon
+
+#endif  // CARBON_EXPLORER_BASE_TRACE_LOG_H_
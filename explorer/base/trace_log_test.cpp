@@ -0,0 +1,127 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "explorer/base/trace_log.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+#include "explorer/base/trace_stream.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Carbon {
+namespace {
+
+using ::testing::Eq;
+using ::testing::HasSubstr;
+
+// A printable object, standing in for a value.
+struct Object : public Printable<Object> {
+  explicit Object(std::string text) : text(std::move(text)) {}
+
+  void Print(llvm::raw_ostream& out) const {
+    ++print_count;
+    out << text;
+  }
+
+  std::string text;
+  mutable int print_count = 0;
+};
+
+// Writes a trace with both text and structured records.
+auto WriteTrace(TraceStream& trace_stream, const Object& a, const Object& b)
+    -> void {
+  SetProgramPhase set_phase(trace_stream, ProgramPhase::Execution);
+  trace_stream.Heading("starting execution");
+  SetFileContext set_file(trace_stream,
+                          SourceLocation("main.carbon", 3, FileKind::Main));
+  for (const Object* object : {&a, &b, &a}) {
+    TraceLogWriter& log =
+        trace_stream.BeginLogEvent(TraceLogEvent::MemoryRead);
+    log.WriteInt(7);
+    log.WriteObject(*object);
+  }
+  set_phase.update_phase(ProgramPhase::Timing);
+  trace_stream << "Time elapsed in ExecProgram: 0ms\n";
+}
+
+TEST(TraceLogTest, RoundTrip) {
+  Object a("1");
+  Object b("(2, 3)");
+  std::string log_data;
+  {
+    llvm::raw_string_ostream log_out(log_data);
+    TraceLogWriter log(&log_out);
+    TraceStream trace_stream;
+    trace_stream.set_log(&log);
+    trace_stream.set_allowed_phases({ProgramPhase::All});
+    trace_stream.set_allowed_file_kinds({FileKind::Main, FileKind::Unknown});
+    WriteTrace(trace_stream, a, b);
+  }
+  // Each object is printed once.
+  EXPECT_THAT(a.print_count, Eq(1));
+  EXPECT_THAT(b.print_count, Eq(1));
+
+  std::string decoded;
+  llvm::raw_string_ostream decoded_out(decoded);
+  ASSERT_TRUE(
+      DecodeTraceLog(
+          log_data, [](ProgramPhase, FileKind) { return true; }, decoded_out)
+          .ok());
+  EXPECT_THAT(decoded, HasSubstr("starting execution"));
+  EXPECT_THAT(decoded, HasSubstr("<-- memory-read: #7 `1`\n"
+                                 "<-- memory-read: #7 `(2, 3)`\n"
+                                 "<-- memory-read: #7 `1`\n"
+                                 "Time elapsed in ExecProgram: 0ms\n"));
+
+  // Filtered records still define objects for later records.
+  std::string filtered;
+  llvm::raw_string_ostream filtered_out(filtered);
+  int num_reads = 0;
+  ASSERT_TRUE(DecodeTraceLog(
+                  log_data,
+                  [&](ProgramPhase phase, FileKind) {
+                    return phase == ProgramPhase::Execution && ++num_reads > 3;
+                  },
+                  filtered_out)
+                  .ok());
+  EXPECT_THAT(filtered, Eq("<-- memory-read: #7 `1`\n"));
+}
+
+TEST(TraceLogTest, Concatenated) {
+  Object a("a");
+  std::string log_data;
+  llvm::raw_string_ostream log_out(log_data);
+  for (int i = 0; i < 2; ++i) {
+    TraceLogWriter log(&log_out);
+    log.BeginEvent(TraceLogEvent::MemoryDealloc, ProgramPhase::Execution,
+                   FileKind::Main);
+    log.WriteInt(i);
+    log.WriteObject(a);
+  }
+  std::string decoded;
+  llvm::raw_string_ostream decoded_out(decoded);
+  ASSERT_TRUE(
+      DecodeTraceLog(
+          log_data, [](ProgramPhase, FileKind) { return true; }, decoded_out)
+          .ok());
+  EXPECT_THAT(decoded, Eq("--# memory-dealloc: #0 `a`\n"
+                          "--# memory-dealloc: #1 `a`\n"));
+}
+
+TEST(TraceLogTest, Malformed) {
+  std::string decoded;
+  llvm::raw_string_ostream decoded_out(decoded);
+  auto filter = [](ProgramPhase, FileKind) { return true; };
+  EXPECT_FALSE(DecodeTraceLog("not a log", filter, decoded_out).ok());
+  std::string truncated = TraceLogMagic.str();
+  truncated += static_cast<char>(TraceLogEvent::Text);
+  EXPECT_FALSE(DecodeTraceLog(truncated, filter, decoded_out).ok());
+}
+
+}  // namespace
+}  // namespace Carbon
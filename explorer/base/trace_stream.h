@@ -15,6 +15,7 @@
 #include "common/ostream.h"
 #include "explorer/base/nonnull.h"
 #include "explorer/base/source_location.h"
+#include "explorer/base/trace_log.h"
 #include "llvm/ADT/ArrayRef.h"
 
 namespace Carbon {
@@ -44,6 +45,10 @@ class TraceStream {
  public:
   explicit TraceStream() = default;
 
+  // Writes any collected text to the log, which must outlive the trace
+  // stream.
+  ~TraceStream() { FlushLogText(); }
+
   // Returns true if tracing is currently enabled.
   auto is_enabled() const -> bool {
     return stream_.has_value() && !in_prelude_ &&
@@ -60,6 +65,38 @@ class TraceStream {
     stream_ = stream;
   }
 
+  // Writes the trace as a binary log instead of text. Text trace output is
+  // collected and written to `log` as `Text` records, while frequent events
+  // are written as structured records by calling `BeginLogEvent`. This should
+  // only be called from the main.
+  auto set_log(Nonnull<TraceLogWriter*> log) -> void {
+    log_ = log;
+    stream_ = &log_text_stream_;
+  }
+
+  // Returns whether the trace is being written as a binary log.
+  auto is_logging() const -> bool { return log_.has_value(); }
+
+  // Starts a structured log record for `event`, and returns the log for its
+  // payload to be written. Requires is_enabled and is_logging.
+  auto BeginLogEvent(TraceLogEvent event) const -> TraceLogWriter& {
+    CARBON_CHECK(is_enabled() && log_);
+    FlushLogText();
+    is_trace_empty_ = false;
+    (*log_)->BeginEvent(event, current_phase_, current_file_kind());
+    return **log_;
+  }
+
+  // Writes any text trace output collected since the last record to the log.
+  auto FlushLogText() const -> void {
+    if (log_ && !log_text_.empty()) {
+      (*log_)->BeginEvent(TraceLogEvent::Text, log_text_phase_,
+                          log_text_file_kind_);
+      (*log_)->WriteString(log_text_);
+      log_text_.clear();
+    }
+  }
+
   auto set_current_phase(ProgramPhase current_phase) -> void {
     current_phase_ = current_phase;
   }
@@ -96,6 +133,7 @@ class TraceStream {
   // Returns the internal stream. Requires is_enabled.
   auto stream() const -> llvm::raw_ostream& {
     CARBON_CHECK(is_enabled() && stream_.has_value());
+    PrepareLogText();
     return **stream_;
   }
 
@@ -104,6 +142,7 @@ class TraceStream {
   auto add_blank_lines(int num_blank_lines) const -> void {
     CARBON_CHECK(is_enabled() && stream_);
     if (!is_trace_empty_) {
+      PrepareLogText();
       for (int i = 0; i < num_blank_lines; ++i) {
         **stream_ << "\n";
       }
@@ -117,6 +156,7 @@ class TraceStream {
     if (is_trace_empty_) {
       is_trace_empty_ = false;
     }
+    PrepareLogText();
     **stream_ << message;
     return **stream_;
   }
@@ -164,11 +204,36 @@ class TraceStream {
   }
 
  private:
+  auto current_file_kind() const -> FileKind {
+    return source_loc_ ? source_loc_->file_kind() : FileKind::Unknown;
+  }
+
+  // When logging, starts a new `Text` record if the text about to be written
+  // has a different phase or file kind than the collected text.
+  auto PrepareLogText() const -> void {
+    if (!log_) {
+      return;
+    }
+    FileKind file_kind = current_file_kind();
+    if (current_phase_ != log_text_phase_ || file_kind != log_text_file_kind_) {
+      FlushLogText();
+      log_text_phase_ = current_phase_;
+      log_text_file_kind_ = file_kind;
+    }
+  }
+
   bool in_prelude_ = false;
   mutable bool is_trace_empty_ = true;
   ProgramPhase current_phase_ = ProgramPhase::Unknown;
   std::optional<SourceLocation> source_loc_ = std::nullopt;
   std::optional<Nonnull<llvm::raw_ostream*>> stream_;
+  // When logging, text trace output is collected in `log_text_` until the next
+  // record.
+  std::optional<Nonnull<TraceLogWriter*>> log_;
+  mutable std::string log_text_;
+  mutable llvm::raw_string_ostream log_text_stream_{log_text_};
+  mutable ProgramPhase log_text_phase_ = ProgramPhase::Unknown;
+  mutable FileKind log_text_file_kind_ = FileKind::Unknown;
   std::bitset<static_cast<int>(ProgramPhase::Last) + 1> allowed_phases_;
   std::bitset<static_cast<int>(FileKind::Last) + 1> allowed_file_kinds_;
 };
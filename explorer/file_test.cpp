@@ -4,6 +4,7 @@
 
 #include "absl/flags/flag.h"
 #include "explorer/main.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "re2/re2.h"
 #include "testing/base/test_raw_ostream.h"
 #include "testing/file_test/file_test_base.h"
@@ -12,6 +13,10 @@ ABSL_FLAG(bool, trace, false,
           "Set to true to run tests with tracing enabled, even if they don't "
           "otherwise specify it. This does not result in checking trace output "
           "contents; it essentially only verifies there's not a crash bug.");
+ABSL_FLAG(int, type_check_threads, 1,
+          "The number of threads to type-check function bodies on, for tests "
+          "that don't specify their own arguments. Output is expected to be "
+          "the same as when checking on a single thread.");
 
 namespace Carbon::Testing {
 namespace {
@@ -21,9 +26,11 @@ class ExplorerFileTest : public FileTestBase {
   explicit ExplorerFileTest(llvm::StringRef test_name)
       : FileTestBase(test_name),
         prelude_line_re_(R"(prelude.carbon:(\d+))"),
-        timing_re_(R"((Time elapsed in \w+: )\d+(ms))") {
+        timing_re_(R"((Time elapsed in \w+: )\d+(ms))"),
+        batch_timing_re_(R"((^// CHECK:STDOUT: === .* in )\d+(ms)$)") {
     CARBON_CHECK(prelude_line_re_.ok()) << prelude_line_re_.error();
     CARBON_CHECK(timing_re_.ok()) << timing_re_.error();
+    CARBON_CHECK(batch_timing_re_.ok()) << batch_timing_re_.error();
   }
 
   auto Run(const llvm::SmallVector<llvm::StringRef>& test_args,
@@ -71,6 +78,9 @@ class ExplorerFileTest : public FileTestBase {
       args.push_back("--trace_file=-");
       args.push_back("--trace_phase=all");
     }
+    if (int threads = absl::GetFlag(FLAGS_type_check_threads); threads != 1) {
+      args.push_back(llvm::formatv("--type_check_threads={0}", threads).str());
+    }
     args.push_back("%s");
     return args;
   }
@@ -88,6 +98,8 @@ class ExplorerFileTest : public FileTestBase {
     // the CHECK comment.
     RE2::GlobalReplace(&check_line, prelude_line_re_,
                        R"(prelude.carbon:{{\\d+}})");
+    // Replace timings in batch mode results.
+    RE2::Replace(&check_line, batch_timing_re_, R"(\1{{\\d+}}\2)");
     if (check_trace_output()) {
       // Replace timings in trace output.
       RE2::GlobalReplace(&check_line, timing_re_, R"(\1{{\\d+}}\2)");
@@ -103,6 +115,7 @@ class ExplorerFileTest : public FileTestBase {
   TestRawOstream trace_stream_;
   RE2 prelude_line_re_;
   RE2 timing_re_;
+  RE2 batch_timing_re_;
 };
 
 }  // namespace
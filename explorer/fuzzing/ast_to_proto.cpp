@@ -333,7 +333,7 @@ static auto ExpressionToProto(const Expression& expression)
 
     case ExpressionKind::StringLiteral:
       expression_proto.mutable_string_literal()->set_value(
-          cast<StringLiteral>(expression).value());
+          std::string(cast<StringLiteral>(expression).value()));
       break;
 
     case ExpressionKind::StringTypeLiteral:
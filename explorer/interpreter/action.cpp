@@ -5,7 +5,6 @@
 #include "explorer/interpreter/action.h"
 
 #include <iterator>
-#include <map>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -28,14 +27,16 @@ using llvm::cast;
 
 RuntimeScope::RuntimeScope(RuntimeScope&& other) noexcept
     : locals_(std::move(other.locals_)),
-      bound_values_(std::move(other.bound_values_)),
+      local_ids_(std::move(other.local_ids_)),
+      local_index_(std::move(other.local_index_)),
       // To transfer ownership of other.allocations_, we have to empty it out.
       allocations_(std::exchange(other.allocations_, {})),
       heap_(other.heap_) {}
 
 auto RuntimeScope::operator=(RuntimeScope&& rhs) noexcept -> RuntimeScope& {
   locals_ = std::move(rhs.locals_);
-  bound_values_ = std::move(rhs.bound_values_);
+  local_ids_ = std::move(rhs.local_ids_);
+  local_index_ = std::move(rhs.local_index_);
   // To transfer ownership of rhs.allocations_, we have to empty it out.
   allocations_ = std::exchange(rhs.allocations_, {});
   heap_ = rhs.heap_;
@@ -45,24 +46,71 @@ auto RuntimeScope::operator=(RuntimeScope&& rhs) noexcept -> RuntimeScope& {
 void RuntimeScope::Print(llvm::raw_ostream& out) const {
   out << "scope: [";
   llvm::ListSeparator sep;
-  for (const auto& [value_node, value] : locals_) {
-    out << sep << "`" << value_node.base() << "`: `" << *value << "`";
+  for (const Local& local : locals_) {
+    out << sep << "`" << *local.node << "`: `" << *local.value << "`";
   }
   out << "]";
 }
 
+auto RuntimeScope::WriteTraceLog(TraceLogWriter& log) const -> void {
+  log.WriteInt(locals_.size());
+  for (const Local& local : locals_) {
+    log.WriteObject(*local.node);
+    log.WriteObject(*local.value);
+  }
+}
+
+auto RuntimeScope::FindLocal(const AstNode& node) const -> const Local* {
+  if (locals_.size() <= MaxLinearSearchSize) {
+    auto it = llvm::find(local_ids_, node.id());
+    return it == local_ids_.end() ? nullptr
+                                  : &locals_[it - local_ids_.begin()];
+  }
+  int id = node.id();
+  if (id >= static_cast<int>(local_index_.size()) || local_index_[id] < 0) {
+    return nullptr;
+  }
+  return &locals_[local_index_[id]];
+}
+
+auto RuntimeScope::AddLocal(Local local) -> bool {
+  if (FindLocal(*local.node)) {
+    return false;
+  }
+  auto add_to_index = [&](int id, int index) {
+    if (id >= static_cast<int>(local_index_.size())) {
+      local_index_.resize(id + 1, -1);
+    }
+    local_index_[id] = index;
+  };
+  if (locals_.size() == MaxLinearSearchSize) {
+    for (auto [index, id] : llvm::enumerate(local_ids_)) {
+      add_to_index(id, index);
+    }
+  }
+  if (locals_.size() >= MaxLinearSearchSize) {
+    add_to_index(local.node->id(), locals_.size());
+  }
+  local_ids_.push_back(local.node->id());
+  locals_.push_back(local);
+  return true;
+}
+
 void RuntimeScope::Bind(ValueNodeView value_node, Address address) {
   CARBON_CHECK(!value_node.constant_value().has_value());
   bool success =
-      locals_.insert({value_node, heap_->arena().New<LocationValue>(address)})
-          .second;
+      AddLocal({.node = &value_node.base(),
+                .value = heap_->arena().New<LocationValue>(address)});
   CARBON_CHECK(success) << "Duplicate definition of " << value_node.base();
 }
 
 void RuntimeScope::BindAndPin(ValueNodeView value_node, Address address) {
-  Bind(value_node, address);
-  bool success = bound_values_.insert(&value_node.base()).second;
-  CARBON_CHECK(success) << "Duplicate pinned node for " << value_node.base();
+  CARBON_CHECK(!value_node.constant_value().has_value());
+  bool success =
+      AddLocal({.node = &value_node.base(),
+                .value = heap_->arena().New<LocationValue>(address),
+                .pinned = true});
+  CARBON_CHECK(success) << "Duplicate definition of " << value_node.base();
   heap_->BindValueToReference(value_node, address);
 }
 
@@ -76,7 +124,7 @@ void RuntimeScope::BindValue(ValueNodeView value_node,
                              Nonnull<const Value*> value) {
   CARBON_CHECK(!value_node.constant_value().has_value());
   CARBON_CHECK(value->kind() != Value::Kind::LocationValue);
-  bool success = locals_.insert({value_node, value}).second;
+  bool success = AddLocal({.node = &value_node.base(), .value = value});
   CARBON_CHECK(success) << "Duplicate definition of " << value_node.base();
 }
 
@@ -88,20 +136,16 @@ auto RuntimeScope::Initialize(ValueNodeView value_node,
   allocations_.push_back(heap_->AllocateValue(value));
   const auto* location =
       heap_->arena().New<LocationValue>(Address(allocations_.back()));
-  bool success = locals_.insert({value_node, location}).second;
+  bool success = AddLocal({.node = &value_node.base(), .value = location});
   CARBON_CHECK(success) << "Duplicate definition of " << value_node.base();
   return location;
 }
 
 void RuntimeScope::Merge(RuntimeScope other) {
   CARBON_CHECK(heap_ == other.heap_);
-  for (auto& element : other.locals_) {
-    bool success = locals_.insert(element).second;
-    CARBON_CHECK(success) << "Duplicate definition of " << element.first;
-  }
-  for (const auto* element : other.bound_values_) {
-    bool success = bound_values_.insert(element).second;
-    CARBON_CHECK(success) << "Duplicate bound value.";
+  for (const Local& local : other.locals_) {
+    bool success = AddLocal(local);
+    CARBON_CHECK(success) << "Duplicate definition of " << *local.node;
   }
   allocations_.insert(allocations_.end(), other.allocations_.begin(),
                       other.allocations_.end());
@@ -111,20 +155,20 @@ void RuntimeScope::Merge(RuntimeScope other) {
 auto RuntimeScope::Get(ValueNodeView value_node,
                        SourceLocation source_loc) const
     -> ErrorOr<std::optional<Nonnull<const Value*>>> {
-  auto it = locals_.find(value_node);
-  if (it == locals_.end()) {
+  const Local* local = FindLocal(value_node.base());
+  if (!local) {
     return {std::nullopt};
   }
-  if (bound_values_.contains(&value_node.base())) {
+  if (local->pinned) {
     // Check if the bound value is still alive.
-    CARBON_CHECK(it->second->kind() == Value::Kind::LocationValue);
+    CARBON_CHECK(local->value->kind() == Value::Kind::LocationValue);
     if (!heap_->is_bound_value_alive(
-            value_node, cast<LocationValue>(it->second)->address())) {
+            value_node, cast<LocationValue>(local->value)->address())) {
       return ProgramError(source_loc)
              << "Reference has changed since this value was bound.";
     }
   }
-  return {it->second};
+  return {local->value};
 }
 
 auto RuntimeScope::Capture(
@@ -133,9 +177,9 @@ auto RuntimeScope::Capture(
   RuntimeScope result(scopes.front()->heap_);
   for (Nonnull<const RuntimeScope*> scope : scopes) {
     CARBON_CHECK(scope->heap_ == result.heap_);
-    for (const auto& entry : scope->locals_) {
+    for (const Local& local : scope->locals_) {
       // Intentionally disregards duplicates later in the vector.
-      result.locals_.insert(entry);
+      result.AddLocal({.node = local.node, .value = local.value});
     }
   }
   return result;
@@ -182,8 +226,51 @@ void Action::Print(llvm::raw_ostream& out) const {
   }
 }
 
-auto Action::kind_string() const -> std::string_view {
+auto Action::WriteTraceLog(TraceLogWriter& log) const -> void {
+  log.WriteString(kind_string());
+  log.WriteInt(pos_);
   switch (kind()) {
+    case Action::Kind::LocationAction:
+      log.WriteObject(cast<LocationAction>(*this).expression());
+      break;
+    case Action::Kind::ValueExpressionAction:
+      log.WriteObject(cast<ValueExpressionAction>(*this).expression());
+      break;
+    case Action::Kind::ExpressionAction:
+      log.WriteObject(cast<ExpressionAction>(*this).expression());
+      break;
+    case Action::Kind::WitnessAction:
+      log.WriteObject(*cast<WitnessAction>(*this).witness());
+      break;
+    case Action::Kind::StatementAction:
+      log.WriteObjectAsID(cast<StatementAction>(*this).statement());
+      break;
+    case Action::Kind::DeclarationAction:
+      log.WriteObjectAsID(cast<DeclarationAction>(*this).declaration());
+      break;
+    case Action::Kind::TypeInstantiationAction:
+      log.WriteObject(*cast<TypeInstantiationAction>(*this).type());
+      break;
+    default:
+      // No subject.
+      log.WriteInt(0);
+      break;
+  }
+  log.WriteInt(results_.size());
+  for (const auto& result : results_) {
+    log.WriteObject(*result);
+  }
+  if (scope_.has_value()) {
+    log.WriteInt(1);
+    scope_->WriteTraceLog(log);
+  } else {
+    log.WriteInt(0);
+  }
+  log.WriteSourceLocation(source_loc());
+}
+
+auto Action::kind_string(Kind kind) -> std::string_view {
+  switch (kind) {
     case Action::Kind::LocationAction:
       return "LocationAction";
     case Action::Kind::ValueExpressionAction:
@@ -6,7 +6,6 @@
 #define CARBON_EXPLORER_INTERPRETER_ACTION_H_
 
 #include <list>
-#include <map>
 #include <optional>
 #include <tuple>
 #include <vector>
@@ -19,11 +18,10 @@
 #include "explorer/ast/statement.h"
 #include "explorer/ast/value.h"
 #include "explorer/base/source_location.h"
+#include "explorer/base/trace_log.h"
 #include "explorer/interpreter/dictionary.h"
 #include "explorer/interpreter/heap_allocation_interface.h"
 #include "explorer/interpreter/stack.h"
-#include "llvm/ADT/DenseSet.h"
-#include "llvm/ADT/MapVector.h"
 #include "llvm/Support/Compiler.h"
 
 namespace Carbon {
@@ -49,6 +47,9 @@ class RuntimeScope : public Printable<RuntimeScope> {
 
   void Print(llvm::raw_ostream& out) const;
 
+  // Writes the locals to a trace log, as printed by `Print`.
+  auto WriteTraceLog(TraceLogWriter& log) const -> void;
+
   // Allocates storage for `value_node` in `heap`, and initializes it with
   // `value`.
   auto Initialize(ValueNodeView value_node, Nonnull<const Value*> value)
@@ -88,10 +89,31 @@ class RuntimeScope : public Printable<RuntimeScope> {
   }
 
  private:
-  llvm::MapVector<ValueNodeView, Nonnull<const Value*>,
-                  std::map<ValueNodeView, unsigned>>
-      locals_;
-  llvm::DenseSet<const AstNode*> bound_values_;
+  // A name bound in this scope.
+  struct Local {
+    Nonnull<const AstNode*> node;
+    Nonnull<const Value*> value;
+    // Whether the value was pinned by `BindAndPin`.
+    bool pinned = false;
+  };
+
+  // Scopes with at most this many locals are searched linearly.
+  static constexpr size_t MaxLinearSearchSize = 16;
+
+  // Returns the local bound to `node`, or null if there is none.
+  auto FindLocal(const AstNode& node) const -> const Local*;
+
+  // Adds `local`, returning false if its node is already bound.
+  auto AddLocal(Local local) -> bool;
+
+  // The locals in the order they were bound, and their node ids. Most scopes
+  // only bind a few names, so they're found by a linear search of the ids.
+  // Larger scopes, such as the globals, also have `local_index_`, which maps
+  // each node id to the index of its local in `locals_`, or -1 if the node
+  // isn't bound. Node ids are dense within a program, so this is a vector.
+  std::vector<Local> locals_;
+  std::vector<int> local_ids_;
+  std::vector<int> local_index_;
   std::vector<AllocationId> allocations_;
   Nonnull<HeapAllocationInterface*> heap_;
 };
@@ -131,6 +153,11 @@ class Action : public Printable<Action> {
 
   void Print(llvm::raw_ostream& out) const;
 
+  // Writes the payload of a `TraceLogEvent::Step` record for this action to a
+  // trace log. The trace decoder prints it in the same way as a step is traced
+  // as text.
+  auto WriteTraceLog(TraceLogWriter& log) const -> void;
+
   // Resets this Action to its initial state.
   void Clear() {
     CARBON_CHECK(!scope_.has_value());
@@ -142,7 +169,10 @@ class Action : public Printable<Action> {
   // object.
   auto kind() const -> Kind { return kind_; }
 
-  auto kind_string() const -> std::string_view;
+  auto kind_string() const -> std::string_view { return kind_string(kind()); }
+
+  // Returns the name of an action kind, such as `"StatementAction"`.
+  static auto kind_string(Kind kind) -> std::string_view;
 
   // The position or state of the action. Starts at 0 and is typically
   // incremented after each step.
@@ -22,7 +22,8 @@ namespace Carbon {
 
 auto AnalyzeProgram(Nonnull<Arena*> arena, AST ast,
                     Nonnull<TraceStream*> trace_stream,
-                    Nonnull<llvm::raw_ostream*> print_stream) -> ErrorOr<AST> {
+                    Nonnull<llvm::raw_ostream*> print_stream,
+                    int type_check_threads) -> ErrorOr<AST> {
   SetProgramPhase set_prog_phase(*trace_stream, ProgramPhase::SourceProgram);
   SetFileContext set_file_ctx(*trace_stream, std::nullopt);
 
@@ -63,8 +64,16 @@ auto AnalyzeProgram(Nonnull<Arena*> arena, AST ast,
   if (trace_stream->is_enabled()) {
     trace_stream->Heading("type checking");
   }
-  CARBON_RETURN_IF_ERROR(
-      TypeChecker(arena, trace_stream, print_stream).TypeCheck(ast));
+  TypeChecker type_checker(arena, trace_stream, print_stream,
+                           type_check_threads);
+  CARBON_RETURN_IF_ERROR(type_checker.TypeCheck(ast));
+  {
+    SetProgramPhase set_timing_phase(*trace_stream, ProgramPhase::Timing);
+    if (trace_stream->is_enabled()) {
+      *trace_stream << "Type checker caches: " << type_checker.cache_stats()
+                    << "\n";
+    }
+  }
 
   set_prog_phase.update_phase(ProgramPhase::UnformedVariableResolution);
   if (trace_stream->is_enabled()) {
@@ -91,14 +100,15 @@ auto AnalyzeProgram(Nonnull<Arena*> arena, AST ast,
 
 auto ExecProgram(Nonnull<Arena*> arena, AST ast,
                  Nonnull<TraceStream*> trace_stream,
-                 Nonnull<llvm::raw_ostream*> print_stream) -> ErrorOr<int> {
+                 Nonnull<llvm::raw_ostream*> print_stream,
+                 std::optional<Nonnull<Profiler*>> profiler) -> ErrorOr<int> {
   SetProgramPhase set_program_phase(*trace_stream, ProgramPhase::Execution);
   if (trace_stream->is_enabled()) {
     trace_stream->Heading("starting execution");
   }
   CARBON_ASSIGN_OR_RETURN(
       auto interpreter_result,
-      InterpProgram(ast, arena, trace_stream, print_stream));
+      InterpProgram(ast, arena, trace_stream, print_stream, profiler));
   if (trace_stream->is_enabled()) {
     trace_stream->Result() << "interpreter result: " << interpreter_result
                            << "\n";
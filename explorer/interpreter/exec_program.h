@@ -11,19 +11,25 @@
 
 #include "explorer/ast/ast.h"
 #include "explorer/base/trace_stream.h"
+#include "explorer/interpreter/profiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace Carbon {
 
-// Perform semantic analysis on the AST.
+// Perform semantic analysis on the AST, type-checking function bodies on
+// `type_check_threads` threads.
 auto AnalyzeProgram(Nonnull<Arena*> arena, AST ast,
                     Nonnull<TraceStream*> trace_stream,
-                    Nonnull<llvm::raw_ostream*> print_stream) -> ErrorOr<AST>;
+                    Nonnull<llvm::raw_ostream*> print_stream,
+                    int type_check_threads = 1) -> ErrorOr<AST>;
 
-// Run the program's `Main` function.
+// Run the program's `Main` function, recording a profile in `profiler` if
+// provided.
 auto ExecProgram(Nonnull<Arena*> arena, AST ast,
                  Nonnull<TraceStream*> trace_stream,
-                 Nonnull<llvm::raw_ostream*> print_stream) -> ErrorOr<int>;
+                 Nonnull<llvm::raw_ostream*> print_stream,
+                 std::optional<Nonnull<Profiler*>> profiler = std::nullopt)
+    -> ErrorOr<int>;
 
 }  // namespace Carbon
 
@@ -9,6 +9,7 @@
 #include "explorer/ast/value.h"
 #include "explorer/base/error_builders.h"
 #include "explorer/base/source_location.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Error.h"
 
@@ -29,12 +30,23 @@ auto Heap::AllocateValue(Nonnull<const Value*> v) -> AllocationId {
   } else {
     states_.push_back(ValueState::Alive);
   }
-  bound_values_.push_back(llvm::DenseMap<const AstNode*, Address>{});
+  bound_nodes_.emplace_back();
+  if (profiler_) {
+    (*profiler_)->RecordAllocation();
+  }
 
   if (trace_stream_->is_enabled()) {
-    trace_stream_->Allocate()
-        << "memory-alloc: #" << a.index_ << " `" << *v << "`"
-        << (is_uninitialized ? " uninitialized" : "") << "\n";
+    if (trace_stream_->is_logging()) {
+      TraceLogWriter& log = trace_stream_->BeginLogEvent(
+          is_uninitialized ? TraceLogEvent::MemoryAllocUninitialized
+                           : TraceLogEvent::MemoryAlloc);
+      log.WriteInt(a.index_);
+      log.WriteObject(*v);
+    } else {
+      trace_stream_->Allocate()
+          << "memory-alloc: #" << a.index_ << " `" << *v << "`"
+          << (is_uninitialized ? " uninitialized" : "") << "\n";
+    }
   }
 
   return a;
@@ -47,10 +59,20 @@ auto Heap::Read(const Address& a, SourceLocation source_loc) const
   Nonnull<const Value*> value = values_[a.allocation_.index_];
   ErrorOr<Nonnull<const Value*>> read_value =
       value->GetElement(arena_, a.element_path_, source_loc, value);
+  if (profiler_) {
+    (*profiler_)->RecordRead();
+  }
 
   if (trace_stream_->is_enabled()) {
-    trace_stream_->Read() << "memory-read: #" << a.allocation_.index_ << " `"
-                          << **read_value << "`\n";
+    if (trace_stream_->is_logging()) {
+      TraceLogWriter& log =
+          trace_stream_->BeginLogEvent(TraceLogEvent::MemoryRead);
+      log.WriteInt(a.allocation_.index_);
+      log.WriteObject(**read_value);
+    } else {
+      trace_stream_->Read() << "memory-read: #" << a.allocation_.index_ << " `"
+                            << **read_value << "`\n";
+    }
   }
 
   return read_value;
@@ -70,22 +92,23 @@ auto Heap::Write(const Address& a, Nonnull<const Value*> v,
   CARBON_ASSIGN_OR_RETURN(values_[a.allocation_.index_],
                           values_[a.allocation_.index_]->SetField(
                               arena_, a.element_path_, v, source_loc));
-  auto& bound_values_map = bound_values_[a.allocation_.index_];
-  // End lifetime of all values bound to this address and its subobjects.
-  if (a.element_path_.IsEmpty()) {
-    bound_values_map.clear();
-  } else {
-    for (auto value_it = bound_values_map.begin();
-         value_it != bound_values_map.end(); ++value_it) {
-      if (AddressesAreStrictlyNested(a, value_it->second)) {
-        bound_values_map.erase(value_it);
-      }
-    }
+  if (profiler_) {
+    (*profiler_)->RecordWrite();
   }
+  // End lifetime of all values bound to this address and its subobjects.
+  UnbindValues(a);
 
   if (trace_stream_->is_enabled()) {
-    trace_stream_->Write() << "memory-write: #" << a.allocation_.index_ << " `"
-                           << *values_[a.allocation_.index_] << "`\n";
+    if (trace_stream_->is_logging()) {
+      TraceLogWriter& log =
+          trace_stream_->BeginLogEvent(TraceLogEvent::MemoryWrite);
+      log.WriteInt(a.allocation_.index_);
+      log.WriteObject(*values_[a.allocation_.index_]);
+    } else {
+      trace_stream_->Write() << "memory-write: #" << a.allocation_.index_
+                             << " `" << *values_[a.allocation_.index_]
+                             << "`\n";
+    }
   }
 
   return Success();
@@ -119,10 +142,19 @@ auto Heap::Deallocate(AllocationId allocation) -> ErrorOr<Success> {
     CARBON_FATAL() << "deallocating an already dead value: "
                    << *values_[allocation.index_];
   }
+  UnbindValues(Address(allocation));
 
   if (trace_stream_->is_enabled()) {
-    trace_stream_->Deallocate() << "memory-dealloc: #" << allocation.index_
-                                << " `" << *values_[allocation.index_] << "`\n";
+    if (trace_stream_->is_logging()) {
+      TraceLogWriter& log =
+          trace_stream_->BeginLogEvent(TraceLogEvent::MemoryDealloc);
+      log.WriteInt(allocation.index_);
+      log.WriteObject(*values_[allocation.index_]);
+    } else {
+      trace_stream_->Deallocate()
+          << "memory-dealloc: #" << allocation.index_ << " `"
+          << *values_[allocation.index_] << "`\n";
+    }
   }
 
   return Success();
@@ -146,13 +178,52 @@ void Heap::Discard(AllocationId allocation) {
 }
 
 void Heap::BindValueToReference(const ValueNodeView& node, const Address& a) {
-  // Update mapped node ignoring any previous mapping.
-  bound_values_[a.allocation_.index_].insert({&node.base(), a});
+  int id = node.base().id();
+  if (id >= static_cast<int>(bound_values_.size())) {
+    bound_values_.resize(id + 1);
+  }
+  // Keep any previous mapping of the node.
+  if (FindBoundValue(id, a.allocation_)) {
+    return;
+  }
+  bound_values_[id].push_back(a);
+  bound_nodes_[a.allocation_.index_].push_back(id);
 }
 
 auto Heap::is_bound_value_alive(const ValueNodeView& node,
                                 const Address& a) const -> bool {
-  return bound_values_[a.allocation_.index_].contains(&node.base());
+  // A dead allocation no longer tracks its bindings; reading it will report
+  // the access to a dead value instead.
+  return states_[a.allocation_.index_] == ValueState::Dead ||
+         FindBoundValue(node.base().id(), a.allocation_) != nullptr;
+}
+
+auto Heap::FindBoundValue(int id, AllocationId allocation) const
+    -> const Address* {
+  if (id >= static_cast<int>(bound_values_.size())) {
+    return nullptr;
+  }
+  const auto& addresses = bound_values_[id];
+  // The most recent binding is the most likely to be looked up.
+  auto it = llvm::find_if(llvm::reverse(addresses), [&](const Address& bound) {
+    return bound.allocation_ == allocation;
+  });
+  return it == addresses.rend() ? nullptr : &*it;
+}
+
+void Heap::UnbindValues(const Address& a) {
+  llvm::erase_if(bound_nodes_[a.allocation_.index_], [&](int id) {
+    auto& addresses = bound_values_[id];
+    auto it = llvm::find_if(addresses, [&](const Address& bound) {
+      return bound.allocation_ == a.allocation_;
+    });
+    CARBON_CHECK(it != addresses.end());
+    if (!a.element_path_.IsEmpty() && !AddressesAreStrictlyNested(a, *it)) {
+      return false;
+    }
+    addresses.erase(it);
+    return true;
+  });
 }
 
 void Heap::Print(llvm::raw_ostream& out) const {
@@ -5,6 +5,7 @@
 #ifndef CARBON_EXPLORER_INTERPRETER_HEAP_H_
 #define CARBON_EXPLORER_INTERPRETER_HEAP_H_
 
+#include <optional>
 #include <vector>
 
 #include "common/ostream.h"
@@ -15,6 +16,8 @@
 #include "explorer/base/source_location.h"
 #include "explorer/base/trace_stream.h"
 #include "explorer/interpreter/heap_allocation_interface.h"
+#include "explorer/interpreter/profiler.h"
+#include "llvm/ADT/SmallVector.h"
 
 namespace Carbon {
 
@@ -28,9 +31,11 @@ class Heap : public HeapAllocationInterface, public Printable<Heap> {
     Dead,
   };
 
-  // Constructs an empty Heap.
-  explicit Heap(Nonnull<TraceStream*> trace_stream, Nonnull<Arena*> arena)
-      : arena_(arena), trace_stream_(trace_stream){};
+  // Constructs an empty Heap. Heap operations are counted by `profiler`, if
+  // provided.
+  explicit Heap(Nonnull<TraceStream*> trace_stream, Nonnull<Arena*> arena,
+                std::optional<Nonnull<Profiler*>> profiler = std::nullopt)
+      : arena_(arena), trace_stream_(trace_stream), profiler_(profiler){};
 
   Heap(const Heap&) = delete;
   auto operator=(const Heap&) -> Heap& = delete;
@@ -73,6 +78,13 @@ class Heap : public HeapAllocationInterface, public Printable<Heap> {
   auto arena() const -> Arena& override { return *arena_; }
 
  private:
+  // Returns the address in `allocation` that the node with id `id` is bound
+  // to, or null if there is none.
+  auto FindBoundValue(int id, AllocationId allocation) const -> const Address*;
+
+  // Ends the lifetime of the values bound to `a` and its subobjects.
+  void UnbindValues(const Address& a);
+
   // Returns whether the address have the same AllocationdId and their path
   // are strictly nested.
   static auto AddressesAreStrictlyNested(const Address& first,
@@ -95,8 +107,15 @@ class Heap : public HeapAllocationInterface, public Printable<Heap> {
   Nonnull<Arena*> arena_;
   std::vector<Nonnull<const Value*>> values_;
   std::vector<ValueState> states_;
-  std::vector<llvm::DenseMap<const AstNode*, Address>> bound_values_;
+  // Indexed by node id, the addresses that each node is bound to by
+  // `BindValueToReference`. A node is bound at most once per allocation, and
+  // usually only in one allocation at a time.
+  std::vector<llvm::SmallVector<Address, 1>> bound_values_;
+  // Indexed by allocation, the ids of the nodes bound to it, so that their
+  // bindings can be ended when it's written or deallocated.
+  std::vector<llvm::SmallVector<int, 1>> bound_nodes_;
   Nonnull<TraceStream*> trace_stream_;
+  std::optional<Nonnull<Profiler*>> profiler_;
 };
 
 }  // namespace Carbon
@@ -25,11 +25,14 @@
 #include "explorer/base/error_builders.h"
 #include "explorer/base/print_as_id.h"
 #include "explorer/base/source_location.h"
+#include "explorer/base/string_buffer.h"
 #include "explorer/base/trace_stream.h"
 #include "explorer/interpreter/action.h"
 #include "explorer/interpreter/action_stack.h"
 #include "explorer/interpreter/heap.h"
+#include "explorer/interpreter/pattern_analysis.h"
 #include "explorer/interpreter/pattern_match.h"
+#include "explorer/interpreter/profiler.h"
 #include "explorer/interpreter/type_utils.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -68,17 +71,25 @@ class Interpreter {
  public:
   // Constructs an Interpreter which allocates values on `arena`, and prints
   // traces if `trace` is true. `phase` indicates whether it executes at
-  // compile time or run time.
+  // compile time or run time. Execution is recorded by `profiler`, if
+  // provided.
   Interpreter(Phase phase, Nonnull<Arena*> arena,
               Nonnull<TraceStream*> trace_stream,
-              Nonnull<llvm::raw_ostream*> print_stream)
+              Nonnull<llvm::raw_ostream*> print_stream,
+              std::optional<Nonnull<Profiler*>> profiler = std::nullopt)
       : arena_(arena),
-        heap_(trace_stream, arena),
+        heap_(trace_stream, arena, profiler),
         todo_(MakeTodo(phase, &heap_, trace_stream)),
         trace_stream_(trace_stream),
         print_stream_(print_stream),
+        profiler_(profiler),
         phase_(phase) {}
 
+  auto set_check_deferred_body(CheckDeferredBodyFn check_deferred_body)
+      -> void {
+    check_deferred_body_ = check_deferred_body;
+  }
+
   // Runs all the steps of `action`.
   // It's not safe to call `RunAllSteps()` or `result()` after an error.
   auto RunAllSteps(std::unique_ptr<Action> action) -> ErrorOr<Success>;
@@ -206,11 +217,22 @@ class Interpreter {
   // The stream for the Print intrinsic.
   Nonnull<llvm::raw_ostream*> print_stream_;
 
+  std::optional<Nonnull<Profiler*>> profiler_;
+
+  // Type-checks deferred function bodies before they're called at compile
+  // time.
+  std::optional<CheckDeferredBodyFn> check_deferred_body_;
+
   Phase phase_;
 
   // The number of steps taken by the interpreter. Used for infinite loop
   // detection.
   int64_t steps_taken_ = 0;
+
+  // The generator for the Rand intrinsic. This is per interpreter so that
+  // programs are reproducible when several run in one process, including on
+  // different threads.
+  std::mt19937_64 rand_generator_{12};
 };
 
 //
@@ -895,7 +917,14 @@ auto Interpreter::CallFunction(const CallExpression& call,
                << "attempt to call function `" << function.name()
                << "` that has not been defined";
       }
-      if (!function.is_type_checked()) {
+      bool is_type_checked;
+      if (check_deferred_body_) {
+        CARBON_ASSIGN_OR_RETURN(is_type_checked,
+                                (*check_deferred_body_)(function));
+      } else {
+        is_type_checked = function.is_type_checked();
+      }
+      if (!is_type_checked) {
         return ProgramError(call.source_loc())
                << "attempt to call function `" << function.name()
                << "` that has not been fully type-checked";
@@ -946,6 +975,9 @@ auto Interpreter::CallFunction(const CallExpression& call,
                                   call.source_loc(), &function_scope,
                                   generic_args, trace_stream_, this->arena_);
       CARBON_CHECK(success) << "Failed to bind arguments to parameters";
+      if (profiler_) {
+        (*profiler_)->EnterFunction(&function, todo_.size());
+      }
       return todo_.Spawn(std::make_unique<StatementAction>(*function.body(),
                                                            location_received),
                          std::move(function_scope));
@@ -1607,17 +1639,18 @@ auto Interpreter::StepExp() -> ErrorOr<Success> {
           CARBON_ASSIGN_OR_RETURN(
               Nonnull<const Value*> format_string_value,
               Convert(args[0], arena_->New<StringType>(), exp.source_loc()));
-          const char* format_string =
-              cast<StringValue>(*format_string_value).value().c_str();
+          // `formatv` needs a null-terminated string.
+          std::string format_string(
+              cast<StringValue>(*format_string_value).value());
           int num_format_args = args.size() - 1;
           CARBON_RETURN_IF_ERROR(ValidateFormatString(
-              intrinsic.source_loc(), format_string, num_format_args));
+              intrinsic.source_loc(), format_string.c_str(), num_format_args));
           switch (num_format_args) {
             case 0:
-              *print_stream_ << llvm::formatv(format_string);
+              *print_stream_ << llvm::formatv(format_string.c_str());
               break;
             case 1: {
-              *print_stream_ << llvm::formatv(format_string,
+              *print_stream_ << llvm::formatv(format_string.c_str(),
                                               cast<IntValue>(*args[1]).value());
               break;
             }
@@ -1706,11 +1739,10 @@ auto Interpreter::StepExp() -> ErrorOr<Success> {
           }
           // Use 64-bit to handle large ranges where `high - low` might exceed
           // int32_t maximums.
-          static std::mt19937_64 generator(12);
           const int64_t range = high - low;
           // We avoid using std::uniform_int_distribution because it's not
           // reproducible across builds/platforms.
-          int64_t r = (generator() % range) + low;
+          int64_t r = (rand_generator_() % range) + low;
           CARBON_CHECK(r >= std::numeric_limits<int32_t>::min() &&
                        r <= std::numeric_limits<int32_t>::max())
               << "Non-int32 result: " << r;
@@ -1794,6 +1826,58 @@ auto Interpreter::StepExp() -> ErrorOr<Success> {
           auto* result = arena_->New<IntValue>(1);
           return todo_.FinishAction(result);
         }
+        case IntrinsicExpression::Intrinsic::StrConcat: {
+          CARBON_CHECK(args.size() == 2);
+          const auto& lhs = cast<StringValue>(*args[0]);
+          const auto& rhs = cast<StringValue>(*args[1]);
+          // Appending an empty string doesn't need new storage.
+          if (rhs.value().empty()) {
+            return todo_.FinishAction(&lhs);
+          }
+          if (lhs.value().empty()) {
+            return todo_.FinishAction(&rhs);
+          }
+          // If `lhs` is the most recent string built in its storage, append to
+          // it in place, so that building a string by repeated concatenation
+          // doesn't copy it every time.
+          if (std::optional<std::string_view> result =
+                  lhs.storage()->TryAppend(lhs.value(), rhs.value())) {
+            return todo_.FinishAction(
+                arena_->New<StringValue>(lhs.storage(), *result));
+          }
+          // Otherwise, copy into new storage with room to grow, so that
+          // repeated appends take amortized linear time.
+          size_t size = lhs.value().size() + rhs.value().size();
+          auto storage = StringBuffer::Make(lhs.value(), 2 * size);
+          std::optional<std::string_view> result =
+              storage->TryAppend(storage->prefix(lhs.value().size()),
+                                 rhs.value());
+          CARBON_CHECK(result) << "New string storage is too small";
+          return todo_.FinishAction(
+              arena_->New<StringValue>(std::move(storage), *result));
+        }
+        case IntrinsicExpression::Intrinsic::StrLength: {
+          CARBON_CHECK(args.size() == 1);
+          auto str = cast<StringValue>(*args[0]).value();
+          return todo_.FinishAction(
+              arena_->New<IntValue>(static_cast<int>(str.size())));
+        }
+        case IntrinsicExpression::Intrinsic::StrSlice: {
+          CARBON_CHECK(args.size() == 3);
+          const auto& str = cast<StringValue>(*args[0]);
+          auto start = cast<IntValue>(*args[1]).value();
+          auto length = cast<IntValue>(*args[2]).value();
+          if (start < 0 || length < 0 ||
+              start + length > static_cast<int>(str.value().size())) {
+            return ProgramError(exp.source_loc())
+                   << "__intrinsic_str_slice range [" << start << ", "
+                   << start + length << ") is out of bounds for a string of "
+                   << "length " << str.value().size();
+          }
+          // The slice shares the storage of the original string.
+          return todo_.FinishAction(arena_->New<StringValue>(
+              str.storage(), str.value().substr(start, length)));
+        }
         case IntrinsicExpression::Intrinsic::IntBitComplement: {
           CARBON_CHECK(args.size() == 1);
           return todo_.FinishAction(
@@ -1854,7 +1938,8 @@ auto Interpreter::StepExp() -> ErrorOr<Success> {
       CARBON_CHECK(act.pos() == 0);
       // { {n :: C, E, F} :: S, H} -> { {n' :: C, E, F} :: S, H}
       return todo_.FinishAction(
-          arena_->New<StringValue>(cast<StringLiteral>(exp).value()));
+          arena_->New<StringValue>(cast<StringLiteral>(exp).storage(),
+                                   cast<StringLiteral>(exp).value()));
     case ExpressionKind::StringTypeLiteral: {
       CARBON_CHECK(act.pos() == 0);
       return todo_.FinishAction(arena_->New<StringType>());
@@ -2005,22 +2090,43 @@ auto Interpreter::StepStmt() -> ErrorOr<Success> {
         return todo_.Spawn(
             std::make_unique<ValueExpressionAction>(&match_stmt.expression()));
       } else {
-        int clause_num = act.pos() - 1;
-        if (clause_num >= static_cast<int>(match_stmt.clauses().size())) {
+        if (act.pos() == 1) {
+          // All clause patterns have the same type, so the value only needs
+          // to be converted once.
+          if (match_stmt.clauses().empty()) {
+            return todo_.FinishAction();
+          }
+          CARBON_ASSIGN_OR_RETURN(
+              Nonnull<const Value*> converted,
+              Convert(act.results()[0],
+                      &match_stmt.clauses()[0].pattern().static_type(),
+                      stmt.source_loc()));
+          act.ReplaceResult(0, converted);
+        }
+        Nonnull<const Value*> val = act.results()[0];
+        // Only try the clauses the decision tree says might match, if there
+        // is one. This is recomputed on each step rather than stored, but is
+        // cheap compared to matching a clause.
+        std::optional<llvm::ArrayRef<int>> candidates;
+        if (match_stmt.decision_tree()) {
+          candidates = (*match_stmt.decision_tree())->Candidates(val);
+        }
+        int num_candidates =
+            candidates ? candidates->size() : match_stmt.clauses().size();
+        int candidate_num = act.pos() - 1;
+        if (candidate_num >= num_candidates) {
           return todo_.FinishAction();
         }
+        int clause_num =
+            candidates ? (*candidates)[candidate_num] : candidate_num;
         auto c = match_stmt.clauses()[clause_num];
         RuntimeScope matches(&heap_);
         BindingMap generic_args;
-        CARBON_ASSIGN_OR_RETURN(
-            Nonnull<const Value*> val,
-            Convert(act.results()[0], &c.pattern().static_type(),
-                    stmt.source_loc()));
         if (PatternMatch(&c.pattern().value(), ExpressionResult::Value(val),
                          stmt.source_loc(), &matches, generic_args,
                          trace_stream_, this->arena_)) {
           // Ensure we don't process any more clauses.
-          act.set_pos(match_stmt.clauses().size() + 1);
+          act.set_pos(num_candidates + 1);
           todo_.MergeScope(std::move(matches));
           return todo_.Spawn(
               std::make_unique<StatementAction>(&c.statement(), std::nullopt));
@@ -2524,8 +2630,12 @@ auto Interpreter::Step() -> ErrorOr<Success> {
   Action& act = todo_.CurrentAction();
 
   if (trace_stream_->is_enabled()) {
-    trace_stream_->Start() << "step " << act << " (" << act.source_loc()
-                           << ") --->\n";
+    if (trace_stream_->is_logging()) {
+      act.WriteTraceLog(trace_stream_->BeginLogEvent(TraceLogEvent::Step));
+    } else {
+      trace_stream_->Start() << "step " << act << " (" << act.source_loc()
+                             << ") --->\n";
+    }
   }
 
   auto error_builder = [&] {
@@ -2548,7 +2658,13 @@ auto Interpreter::Step() -> ErrorOr<Success> {
     return error_builder() << "out of memory: exceeded arena allocation limit";
   }
 
-  switch (act.kind()) {
+  // The action may be destroyed by the step, so save its kind for profiling.
+  Action::Kind kind = act.kind();
+  if (profiler_) {
+    (*profiler_)->StartStep(todo_.size());
+  }
+
+  switch (kind) {
     case Action::Kind::LocationAction:
       CARBON_RETURN_IF_ERROR(StepLocation());
       break;
@@ -2581,6 +2697,9 @@ auto Interpreter::Step() -> ErrorOr<Success> {
     case Action::Kind::RecursiveAction:
       CARBON_FATAL() << "Tried to step a RecursiveAction";
   }  // switch
+  if (profiler_) {
+    (*profiler_)->FinishStep(kind);
+  }
   return Success();
 }
 
@@ -2595,8 +2714,10 @@ auto Interpreter::RunAllSteps(std::unique_ptr<Action> action)
 
 auto InterpProgram(const AST& ast, Nonnull<Arena*> arena,
                    Nonnull<TraceStream*> trace_stream,
-                   Nonnull<llvm::raw_ostream*> print_stream) -> ErrorOr<int> {
-  Interpreter interpreter(Phase::RunTime, arena, trace_stream, print_stream);
+                   Nonnull<llvm::raw_ostream*> print_stream,
+                   std::optional<Nonnull<Profiler*>> profiler) -> ErrorOr<int> {
+  Interpreter interpreter(Phase::RunTime, arena, trace_stream, print_stream,
+                          profiler);
   if (trace_stream->is_enabled()) {
     trace_stream->SubHeading("initializing globals");
   }
@@ -2623,10 +2744,14 @@ auto InterpProgram(const AST& ast, Nonnull<Arena*> arena,
 
 auto InterpExp(Nonnull<const Expression*> e, Nonnull<Arena*> arena,
                Nonnull<TraceStream*> trace_stream,
-               Nonnull<llvm::raw_ostream*> print_stream)
+               Nonnull<llvm::raw_ostream*> print_stream,
+               std::optional<CheckDeferredBodyFn> check_deferred_body)
     -> ErrorOr<Nonnull<const Value*>> {
   Interpreter interpreter(Phase::CompileTime, arena, trace_stream,
                           print_stream);
+  if (check_deferred_body) {
+    interpreter.set_check_deferred_body(*check_deferred_body);
+  }
   CARBON_RETURN_IF_ERROR(
       interpreter.RunAllSteps(std::make_unique<ValueExpressionAction>(e)));
   return interpreter.result();
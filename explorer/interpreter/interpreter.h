@@ -10,21 +10,35 @@
 #include "explorer/ast/expression.h"
 #include "explorer/ast/value.h"
 #include "explorer/base/trace_stream.h"
+#include "explorer/interpreter/profiler.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 
 namespace Carbon {
 
 // Interprets the program defined by `ast`, allocating values on `arena` and
-// printing traces if `trace` is true.
+// printing traces if `trace` is true. If `profiler` is provided, it records a
+// profile of the execution.
 auto InterpProgram(const AST& ast, Nonnull<Arena*> arena,
                    Nonnull<TraceStream*> trace_stream,
-                   Nonnull<llvm::raw_ostream*> print_stream) -> ErrorOr<int>;
+                   Nonnull<llvm::raw_ostream*> print_stream,
+                   std::optional<Nonnull<Profiler*>> profiler = std::nullopt)
+    -> ErrorOr<int>;
+
+// Called before a function is called at compile time, to type-check its body
+// if that was deferred. Returns whether the body has been type-checked, which
+// is used instead of `FunctionDeclaration::is_type_checked`.
+using CheckDeferredBodyFn =
+    llvm::function_ref<ErrorOr<bool>(const FunctionDeclaration&)>;
 
 // Interprets `e` at compile-time, allocating values on `arena` and
 // printing traces if `trace` is true. The caller must ensure that all the
-// code this evaluates has been typechecked.
-auto InterpExp(Nonnull<const Expression*> e, Nonnull<Arena*> arena,
-               Nonnull<TraceStream*> trace_stream,
-               Nonnull<llvm::raw_ostream*> print_stream)
+// code this evaluates has been typechecked, or will be by
+// `check_deferred_body`.
+auto InterpExp(
+    Nonnull<const Expression*> e, Nonnull<Arena*> arena,
+    Nonnull<TraceStream*> trace_stream,
+    Nonnull<llvm::raw_ostream*> print_stream,
+    std::optional<CheckDeferredBodyFn> check_deferred_body = std::nullopt)
     -> ErrorOr<Nonnull<const Value*>>;
 
 }  // namespace Carbon
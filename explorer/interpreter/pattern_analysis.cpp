@@ -6,6 +6,8 @@
 
 #include <set>
 
+#include "llvm/ADT/STLExtras.h"
+
 using llvm::cast;
 using llvm::dyn_cast;
 using llvm::isa;
@@ -310,4 +312,242 @@ auto PatternMatrix::Default() const -> PatternMatrix {
   return default_matrix;
 }
 
+auto MatchDecisionTree::Build(llvm::ArrayRef<Nonnull<const Pattern*>> patterns)
+    -> std::optional<MatchDecisionTree> {
+  std::vector<Row> rows;
+  rows.reserve(patterns.size());
+  for (int clause = 0; clause != static_cast<int>(patterns.size()); ++clause) {
+    rows.push_back({.clause = clause, .columns = {patterns[clause]}});
+  }
+  MatchDecisionTree tree;
+  if (!tree.AddNode(std::move(rows), {Path()})) {
+    return std::nullopt;
+  }
+  return tree;
+}
+
+auto MatchDecisionTree::SpecializeRows(llvm::ArrayRef<Row> rows, int column,
+                                       std::string_view discriminator,
+                                       int size)
+    -> std::optional<std::vector<Row>> {
+  std::vector<Row> specialized;
+  for (const auto& row : rows) {
+    const AbstractPattern& pattern = row.columns[column];
+    Row new_row = {.clause = row.clause, .columns = {}};
+    new_row.columns.reserve(row.columns.size() + size - 1);
+    new_row.columns.insert(new_row.columns.end(), row.columns.begin(),
+                           row.columns.begin() + column);
+    switch (pattern.kind()) {
+      case AbstractPattern::Wildcard:
+        new_row.columns.insert(new_row.columns.end(), size,
+                               AbstractPattern::MakeWildcard());
+        break;
+      case AbstractPattern::Compound:
+        if (pattern.discriminator() != discriminator) {
+          continue;
+        }
+        pattern.AppendElementsTo(new_row.columns);
+        break;
+      case AbstractPattern::Primitive:
+        // A value we can't take apart, such as a symbolic value.
+        return std::nullopt;
+    }
+    new_row.columns.insert(new_row.columns.end(),
+                           row.columns.begin() + column + 1, row.columns.end());
+    specialized.push_back(std::move(new_row));
+  }
+  return specialized;
+}
+
+auto MatchDecisionTree::SelectRows(llvm::ArrayRef<Row> rows, int column,
+                                   std::optional<Nonnull<const Value*>> value)
+    -> std::optional<std::vector<Row>> {
+  std::vector<Row> selected;
+  for (const auto& row : rows) {
+    const AbstractPattern& pattern = row.columns[column];
+    switch (pattern.kind()) {
+      case AbstractPattern::Wildcard:
+        break;
+      case AbstractPattern::Compound:
+        if (value) {
+          return std::nullopt;
+        }
+        continue;
+      case AbstractPattern::Primitive:
+        if (!value || !ValueEqual(&pattern.value(), *value, std::nullopt)) {
+          continue;
+        }
+        break;
+    }
+    Row new_row = {.clause = row.clause, .columns = row.columns};
+    new_row.columns.erase(new_row.columns.begin() + column);
+    selected.push_back(std::move(new_row));
+  }
+  return selected;
+}
+
+auto MatchDecisionTree::ExpandPaths(llvm::ArrayRef<Path> paths, int column,
+                                    int size) -> std::vector<Path> {
+  std::vector<Path> expanded(paths.begin(), paths.begin() + column);
+  for (int i = 0; i != size; ++i) {
+    Path element_path = paths[column];
+    element_path.push_back(i);
+    expanded.push_back(std::move(element_path));
+  }
+  expanded.insert(expanded.end(), paths.begin() + column + 1, paths.end());
+  return expanded;
+}
+
+auto MatchDecisionTree::AddNode(std::vector<Row> rows, std::vector<Path> paths)
+    -> std::optional<int> {
+  // Test the first column in which the first row has a non-wildcard pattern.
+  // If there's none, the first row matches everything that reaches this node.
+  auto find_column = [&]() -> std::optional<int> {
+    if (rows.empty()) {
+      return std::nullopt;
+    }
+    for (int column = 0; column != static_cast<int>(rows[0].columns.size());
+         ++column) {
+      if (rows[0].columns[column].kind() != AbstractPattern::Wildcard) {
+        return column;
+      }
+    }
+    return std::nullopt;
+  };
+  std::optional<int> column = find_column();
+
+  // A tuple has only one constructor, so its elements can be matched without
+  // testing anything.
+  while (column &&
+         rows[0].columns[*column].kind() == AbstractPattern::Compound &&
+         isa<TupleType>(rows[0].columns[*column].type())) {
+    int size = rows[0].columns[*column].elements_size();
+    auto expanded = SpecializeRows(rows, *column, {}, size);
+    if (!expanded) {
+      return std::nullopt;
+    }
+    rows = std::move(*expanded);
+    paths = ExpandPaths(paths, *column, size);
+    column = find_column();
+  }
+
+  int index = nodes_.size();
+  nodes_.push_back({.kind = Node::Leaf});
+  if (!column || index >= MaxNodes) {
+    for (const auto& row : rows) {
+      nodes_[index].candidates.push_back(row.clause);
+    }
+    return index;
+  }
+
+  Node node = {.kind = Node::Discriminator, .path = paths[*column]};
+  if (rows[0].columns[*column].kind() == AbstractPattern::Compound) {
+    int size = rows[0].columns[*column].elements_size();
+    std::vector<Path> element_paths = ExpandPaths(paths, *column, size);
+    for (const auto& row : rows) {
+      const AbstractPattern& pattern = row.columns[*column];
+      if (pattern.kind() != AbstractPattern::Compound ||
+          node.discriminator_children.count(pattern.discriminator())) {
+        continue;
+      }
+      auto child_rows =
+          SpecializeRows(rows, *column, pattern.discriminator(), size);
+      if (!child_rows) {
+        return std::nullopt;
+      }
+      auto child = AddNode(std::move(*child_rows), element_paths);
+      if (!child) {
+        return std::nullopt;
+      }
+      node.discriminator_children[pattern.discriminator()] = *child;
+    }
+  } else {
+    node.kind = Node::Primitive;
+    for (const auto& row : rows) {
+      const AbstractPattern& pattern = row.columns[*column];
+      if (pattern.kind() != AbstractPattern::Primitive) {
+        continue;
+      }
+      // Only values that compare equal exactly when `ValueEqual` says so at
+      // runtime can be used as keys.
+      if (!isa<IntValue, StringValue>(pattern.value())) {
+        return std::nullopt;
+      }
+      if (llvm::any_of(node.value_children, [&](const auto& child) {
+            return ValueEqual(child.first, &pattern.value(), std::nullopt);
+          })) {
+        continue;
+      }
+      auto child_rows = SelectRows(rows, *column, &pattern.value());
+      if (!child_rows) {
+        return std::nullopt;
+      }
+      std::vector<Path> child_paths = paths;
+      child_paths.erase(child_paths.begin() + *column);
+      auto child = AddNode(std::move(*child_rows), std::move(child_paths));
+      if (!child) {
+        return std::nullopt;
+      }
+      node.value_children.push_back({&pattern.value(), *child});
+    }
+  }
+
+  auto default_rows = SelectRows(rows, *column, std::nullopt);
+  if (!default_rows) {
+    return std::nullopt;
+  }
+  paths.erase(paths.begin() + *column);
+  auto default_child = AddNode(std::move(*default_rows), std::move(paths));
+  if (!default_child) {
+    return std::nullopt;
+  }
+  node.default_child = *default_child;
+  nodes_[index] = std::move(node);
+  return index;
+}
+
+auto MatchDecisionTree::Candidates(Nonnull<const Value*> value) const
+    -> std::optional<llvm::ArrayRef<int>> {
+  const Node* node = &nodes_.front();
+  while (node->kind != Node::Leaf) {
+    Nonnull<const Value*> tested = value;
+    for (int element : node->path) {
+      if (const auto* tuple = dyn_cast<TupleValue>(tested);
+          tuple && element < static_cast<int>(tuple->elements().size())) {
+        tested = tuple->elements()[element];
+      } else if (const auto* alt = dyn_cast<AlternativeValue>(tested);
+                 alt && alt->argument()) {
+        tested = *alt->argument();
+      } else {
+        return std::nullopt;
+      }
+    }
+
+    int child = node->default_child;
+    if (node->kind == Node::Discriminator) {
+      std::string_view discriminator;
+      if (const auto* alt = dyn_cast<AlternativeValue>(tested)) {
+        discriminator = alt->alternative().name();
+      } else if (const auto* bool_val = dyn_cast<BoolValue>(tested)) {
+        discriminator = bool_val->value() ? "true" : "false";
+      } else {
+        return std::nullopt;
+      }
+      auto it = node->discriminator_children.find(discriminator);
+      if (it != node->discriminator_children.end()) {
+        child = it->second;
+      }
+    } else {
+      for (const auto& [key, key_child] : node->value_children) {
+        if (ValueEqual(key, tested, std::nullopt)) {
+          child = key_child;
+          break;
+        }
+      }
+    }
+    node = &nodes_[child];
+  }
+  return llvm::ArrayRef<int>(node->candidates);
+}
+
 }  // namespace Carbon
@@ -5,12 +5,17 @@
 #ifndef CARBON_EXPLORER_INTERPRETER_PATTERN_ANALYSIS_H_
 #define CARBON_EXPLORER_INTERPRETER_PATTERN_ANALYSIS_H_
 
+#include <optional>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "explorer/ast/pattern.h"
 #include "explorer/ast/value.h"
 #include "explorer/base/nonnull.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/PointerUnion.h"
+#include "llvm/ADT/StringMap.h"
 
 namespace Carbon {
 
@@ -157,6 +162,98 @@ class PatternMatrix {
   std::vector<std::vector<AbstractPattern>> matrix_;
 };
 
+// A decision tree for a match statement, used to find the clauses that might
+// match a value without trying each clause in turn.
+//
+// Each interior node tests the discriminator or primitive value at some
+// position within the matched value, and each leaf lists the clauses that are
+// consistent with the tests leading to it, in order. A clause is only left out
+// of a leaf if it can't match, so the first clause in the leaf that matches is
+// the first clause in the match statement that matches. The tree is built using
+// the same specialization as `PatternMatrix`, but keeps track of which clause
+// each row came from.
+class MatchDecisionTree {
+ public:
+  // Builds a decision tree for the patterns of a match statement's clauses,
+  // which must all have the same type. Returns `std::nullopt` if the patterns
+  // can't be compared against values ahead of time, for example because they
+  // involve symbolic values.
+  static auto Build(llvm::ArrayRef<Nonnull<const Pattern*>> patterns)
+      -> std::optional<MatchDecisionTree>;
+
+  // Returns the indexes of the clauses that might match `value`, in order.
+  // Returns `std::nullopt` if `value` doesn't have the shape the patterns
+  // expect, in which case all clauses should be tried.
+  auto Candidates(Nonnull<const Value*> value) const
+      -> std::optional<llvm::ArrayRef<int>>;
+
+ private:
+  // The maximum number of nodes in a tree. Each test can duplicate the clauses
+  // with wildcards in the tested position, so the tree can grow exponentially
+  // with the number of nested patterns. Beyond this limit, the remaining
+  // clauses are all listed in a leaf and tried in turn.
+  static constexpr int MaxNodes = 1024;
+
+  // A row of the pattern matrix, and the clause it came from.
+  struct Row {
+    int clause;
+    std::vector<AbstractPattern> columns;
+  };
+
+  // The position of a value within the matched value, as a sequence of
+  // element indexes. The argument of an alternative is its element 0.
+  using Path = std::vector<int>;
+
+  struct Node {
+    enum Kind {
+      // Lists the clauses that might match.
+      Leaf,
+      // Tests the discriminator of an alternative or `bool` value.
+      Discriminator,
+      // Tests a primitive value.
+      Primitive,
+    };
+
+    Kind kind;
+    // For a test, the position of the tested value.
+    Path path;
+    // For a `Discriminator` test, the child for each discriminator.
+    llvm::StringMap<int> discriminator_children;
+    // For a `Primitive` test, the child for each value.
+    std::vector<std::pair<Nonnull<const Value*>, int>> value_children;
+    // For a test, the child used when no other child applies.
+    int default_child = -1;
+    // For a leaf, the indexes of the clauses that might match, in order.
+    std::vector<int> candidates;
+  };
+
+  // Specializes `rows` for the case where the value in `column` uses
+  // `discriminator`, replacing that column with `size` columns for its
+  // elements. A tuple has an empty discriminator.
+  static auto SpecializeRows(llvm::ArrayRef<Row> rows, int column,
+                             std::string_view discriminator, int size)
+      -> std::optional<std::vector<Row>>;
+
+  // Removes `column` from `rows`, keeping the rows that match when the value
+  // in that column is `value`. If `value` is `std::nullopt`, keeps the rows
+  // that match when the value is none of those the rows test for.
+  static auto SelectRows(llvm::ArrayRef<Row> rows, int column,
+                         std::optional<Nonnull<const Value*>> value)
+      -> std::optional<std::vector<Row>>;
+
+  // Replaces the path for `column` with the paths of its `size` elements.
+  static auto ExpandPaths(llvm::ArrayRef<Path> paths, int column, int size)
+      -> std::vector<Path>;
+
+  // Adds a node matching `rows` against the values at `paths`, along with its
+  // descendants, and returns its index.
+  auto AddNode(std::vector<Row> rows, std::vector<Path> paths)
+      -> std::optional<int>;
+
+  // The nodes of the tree. The root is the first node.
+  std::vector<Node> nodes_;
+};
+
 }  // namespace Carbon
 
 #endif  // CARBON_EXPLORER_INTERPRETER_PATTERN_ANALYSIS_H_
@@ -0,0 +1,179 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "explorer/interpreter/profiler.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/FormatVariadic.h"
+
+namespace Carbon {
+
+auto Profiler::Counters::operator+=(const Counters& other) -> Counters& {
+  steps += other.steps;
+  allocations += other.allocations;
+  reads += other.reads;
+  writes += other.writes;
+  time += other.time;
+  return *this;
+}
+
+// Returns the name used for a function in profiles, which includes its
+// location to distinguish functions with the same name, such as the `Op`
+// functions of operator interface implementations.
+static auto FunctionLabel(const FunctionDeclaration& function) -> std::string {
+  std::string label;
+  llvm::raw_string_ostream out(label);
+  out << function.name() << " (" << function.source_loc() << ")";
+  return label;
+}
+
+auto Profiler::EnterFunction(Nonnull<const FunctionDeclaration*> function,
+                             int stack_depth) -> void {
+  auto& child = current_->children[function];
+  if (!child) {
+    child = std::make_unique<CallNode>();
+    child->function = function;
+    child->label = FunctionLabel(*function);
+  }
+  ++child->calls;
+  frames_.push_back({.node = child.get(), .stack_depth = stack_depth});
+  current_ = child.get();
+}
+
+auto Profiler::StartStep(int stack_depth) -> void {
+  // Exit any functions whose body has been popped from the action stack.
+  while (!frames_.empty() && stack_depth <= frames_.back().stack_depth) {
+    frames_.pop_back();
+    current_ = frames_.empty() ? &root_ : frames_.back().node;
+  }
+  // A step that calls a function is attributed to the caller.
+  step_node_ = current_;
+  step_start_ = Clock::now();
+}
+
+auto Profiler::FinishStep(Action::Kind kind) -> void {
+  Clock::duration duration = Clock::now() - step_start_;
+  ++step_node_->self.steps;
+  step_node_->self.time += duration;
+  Counters& kind_counters = action_kinds_[static_cast<int>(kind)];
+  ++kind_counters.steps;
+  kind_counters.time += duration;
+}
+
+static auto ToMicroseconds(Profiler::Clock::duration duration) -> int64_t {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+
+auto Profiler::PrintReport(llvm::raw_ostream& out) const -> void {
+  struct FunctionTotals {
+    llvm::StringRef label;
+    int64_t calls = 0;
+    Counters self;
+    // Counters including callees. Recursive calls are only counted once.
+    Counters total;
+  };
+  llvm::MapVector<const FunctionDeclaration*, FunctionTotals> functions;
+  llvm::DenseMap<const FunctionDeclaration*, int> active_calls;
+
+  // Returns the counters for `node` including its callees.
+  auto accumulate = [&](const CallNode& node, auto& accumulate) -> Counters {
+    Counters total = node.self;
+    if (node.function) {
+      ++active_calls[*node.function];
+    }
+    for (const auto& [function, child] : node.children) {
+      total += accumulate(*child, accumulate);
+    }
+    if (node.function) {
+      FunctionTotals& totals = functions[*node.function];
+      totals.label = node.label;
+      totals.calls += node.calls;
+      totals.self += node.self;
+      if (--active_calls[*node.function] == 0) {
+        totals.total += total;
+      }
+    }
+    return total;
+  };
+  Counters program_total = accumulate(root_, accumulate);
+
+  std::vector<std::pair<std::string, const FunctionTotals*>> sorted;
+  sorted.reserve(functions.size());
+  for (const auto& [function, totals] : functions) {
+    sorted.push_back({totals.label.str(), &totals});
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return std::make_pair(-a.second->self.steps, a.first) <
+           std::make_pair(-b.second->self.steps, b.first);
+  });
+
+  out << "=== profile: " << program_total.steps << " steps, "
+      << program_total.allocations << " allocations, " << program_total.reads
+      << " reads, " << program_total.writes << " writes in "
+      << ToMicroseconds(program_total.time) << "us\n";
+  out << llvm::formatv("{0,10} {1,10} {2,10} {3,10} {4,8} {5,8} {6,8} {7,8}  "
+                       "{8}\n",
+                       "steps", "total", "us", "total us", "calls", "allocs",
+                       "reads", "writes", "function");
+  auto print_row = [&](const Counters& self, const Counters& total,
+                       int64_t calls, llvm::StringRef label) {
+    out << llvm::formatv(
+        "{0,10} {1,10} {2,10} {3,10} {4,8} {5,8} {6,8} {7,8}  {8}\n",
+        self.steps, total.steps, ToMicroseconds(self.time),
+        ToMicroseconds(total.time), calls, self.allocations, self.reads,
+        self.writes, label);
+  };
+  print_row(root_.self, program_total, 0, "[top level]");
+  for (const auto& [label, totals] : sorted) {
+    print_row(totals->self, totals->total, totals->calls, label);
+  }
+
+  std::vector<Action::Kind> kinds;
+  for (int i = 0; i < NumActionKinds; ++i) {
+    if (action_kinds_[i].steps > 0) {
+      kinds.push_back(static_cast<Action::Kind>(i));
+    }
+  }
+  std::stable_sort(kinds.begin(), kinds.end(), [&](auto a, auto b) {
+    return action_kinds_[static_cast<int>(a)].steps >
+           action_kinds_[static_cast<int>(b)].steps;
+  });
+  out << "=== profile: action kinds\n";
+  out << llvm::formatv("{0,10} {1,10}  {2}\n", "steps", "us", "action");
+  for (Action::Kind kind : kinds) {
+    const Counters& counters = action_kinds_[static_cast<int>(kind)];
+    out << llvm::formatv("{0,10} {1,10}  {2}\n", counters.steps,
+                         ToMicroseconds(counters.time),
+                         Action::kind_string(kind));
+  }
+}
+
+auto Profiler::PrintFoldedStacks(llvm::raw_ostream& out) const -> void {
+  std::vector<std::pair<std::string, int64_t>> stacks;
+  auto collect = [&](const CallNode& node, const std::string& stack,
+                     auto& collect) -> void {
+    if (node.self.steps > 0) {
+      stacks.push_back({stack, node.self.steps});
+    }
+    for (const auto& [function, child] : node.children) {
+      std::string child_stack = child->label;
+      if (node.function) {
+        child_stack = stack + ";" + child_stack;
+      }
+      collect(*child, child_stack, collect);
+    }
+  };
+  collect(root_, "[top level]", collect);
+  std::sort(stacks.begin(), stacks.end());
+  for (const auto& [stack, steps] : stacks) {
+    out << stack << " " << steps << "\n";
+  }
+}
+
+}  // namespace Carbon
@@ -0,0 +1,116 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_EXPLORER_INTERPRETER_PROFILER_H_
+#define CARBON_EXPLORER_INTERPRETER_PROFILER_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/ostream.h"
+#include "explorer/ast/declaration.h"
+#include "explorer/base/nonnull.h"
+#include "explorer/interpreter/action.h"
+#include "llvm/ADT/MapVector.h"
+
+namespace Carbon {
+
+// Collects a profile of a program's execution: the number of interpreter
+// steps, heap operations and time spent in each Carbon function, and for each
+// kind of action.
+//
+// The interpreter reports each step and each function call. A function is
+// exited once its body is no longer on the action stack, which also covers
+// returns that unwind several actions at once.
+class Profiler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  Profiler() = default;
+
+  Profiler(const Profiler&) = delete;
+  auto operator=(const Profiler&) -> Profiler& = delete;
+
+  // Records a call to `function`, whose body is about to be pushed onto an
+  // action stack holding `stack_depth` actions.
+  auto EnterFunction(Nonnull<const FunctionDeclaration*> function,
+                     int stack_depth) -> void;
+
+  // Records the start of a step, when the action stack holds `stack_depth`
+  // actions.
+  auto StartStep(int stack_depth) -> void;
+
+  // Records the end of the step started by `StartStep`, for an action of kind
+  // `kind`.
+  auto FinishStep(Action::Kind kind) -> void;
+
+  // Record heap operations, which are attributed to the current function.
+  auto RecordAllocation() -> void { ++current_->self.allocations; }
+  auto RecordRead() -> void { ++current_->self.reads; }
+  auto RecordWrite() -> void { ++current_->self.writes; }
+
+  // Prints the counters for each function and each action kind, in
+  // decreasing order of steps.
+  auto PrintReport(llvm::raw_ostream& out) const -> void;
+
+  // Prints the call stacks in the folded format read by flame graph tools:
+  // one line per stack, with frames separated by `;`, followed by the number
+  // of steps taken in that stack.
+  auto PrintFoldedStacks(llvm::raw_ostream& out) const -> void;
+
+ private:
+  struct Counters {
+    auto operator+=(const Counters& other) -> Counters&;
+
+    int64_t steps = 0;
+    int64_t allocations = 0;
+    int64_t reads = 0;
+    int64_t writes = 0;
+    Clock::duration time = Clock::duration::zero();
+  };
+
+  // A node in the call tree, for calls to a function from a particular stack.
+  // The root represents code outside any function, such as the
+  // initialization of globals.
+  //
+  // The profile is printed after the program's AST has been destroyed, so
+  // `function` only identifies the function and is never dereferenced; its
+  // name is captured in `label` when the node is created.
+  struct CallNode {
+    std::optional<Nonnull<const FunctionDeclaration*>> function;
+    std::string label;
+    int64_t calls = 0;
+    Counters self;
+    llvm::MapVector<const FunctionDeclaration*, std::unique_ptr<CallNode>>
+        children;
+  };
+
+  // A function call whose body is on the action stack.
+  struct Frame {
+    Nonnull<CallNode*> node;
+    int stack_depth;
+  };
+
+  CallNode root_;
+  std::vector<Frame> frames_;
+  Nonnull<CallNode*> current_ = &root_;
+
+  // The state of the current step.
+  Nonnull<CallNode*> step_node_ = &root_;
+  Clock::time_point step_start_;
+
+  // Counters for each action kind, indexed by `Action::Kind`.
+  static constexpr int NumActionKinds =
+      static_cast<int>(Action::Kind::TypeInstantiationAction) + 1;
+  std::array<Counters, NumActionKinds> action_kinds_;
+};
+
+}  // namespace Carbon
+
+#endif  // CARBON_EXPLORER_INTERPRETER_PROFILER_H_
@@ -4,8 +4,12 @@
 
 #include "explorer/interpreter/type_checker.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
@@ -30,14 +34,17 @@
 #include "explorer/interpreter/interpreter.h"
 #include "explorer/interpreter/pattern_analysis.h"
 #include "explorer/interpreter/pattern_match.h"
+#include "explorer/interpreter/stack_space.h"
 #include "explorer/interpreter/type_structure.h"
 #include "explorer/interpreter/type_utils.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/ThreadPool.h"
 
 using llvm::cast;
 using llvm::dyn_cast;
@@ -1016,10 +1023,12 @@ auto TypeChecker::ExpectNonPlaceholderType(SourceLocation source_loc,
 class TypeChecker::ArgumentDeduction {
  public:
   ArgumentDeduction(
-      SourceLocation source_loc, std::string_view context,
+      Nonnull<const TypeChecker*> type_checker, SourceLocation source_loc,
+      std::string_view context,
       llvm::ArrayRef<Nonnull<const GenericBinding*>> bindings_to_deduce,
       Nonnull<TraceStream*> trace_stream)
-      : source_loc_(source_loc),
+      : type_checker_(type_checker),
+        source_loc_(source_loc),
         context_(context),
         deduced_bindings_in_order_(bindings_to_deduce),
         trace_stream_(trace_stream) {
@@ -1039,6 +1048,9 @@ class TypeChecker::ArgumentDeduction {
   // Deduces the values of deduced bindings in `param` from the corresponding
   // values in `arg`. `allow_implicit_conversion` specifies whether implicit
   // conversions are permitted from the argument to the parameter type.
+  //
+  // The outcome of a top-level call is cached in the type checker and replayed
+  // by later deductions of the same bindings from the same values.
   auto Deduce(Nonnull<const Value*> param, Nonnull<const Value*> arg,
               bool allow_implicit_conversion) -> ErrorOr<Success>;
 
@@ -1069,10 +1081,25 @@ class TypeChecker::ArgumentDeduction {
       -> ErrorOr<std::optional<Bindings>>;
 
  private:
+  // Implementation of `Deduce`, without caching.
+  auto DeduceImpl(Nonnull<const Value*> param, Nonnull<const Value*> arg,
+                  bool allow_implicit_conversion) -> ErrorOr<Success>;
+
+  // Performs a top-level deduction, recording its outcome in `entry`.
+  auto DeduceAndRecord(Nonnull<const Value*> param, Nonnull<const Value*> arg,
+                       bool allow_implicit_conversion,
+                       DeductionCacheEntry& entry) -> ErrorOr<Success>;
+
+  // Applies the outcome of a previous deduction.
+  auto Replay(const DeductionCacheEntry& entry) -> ErrorOr<Success>;
+
+  Nonnull<const TypeChecker*> type_checker_;
   SourceLocation source_loc_;
   std::string_view context_;
   llvm::ArrayRef<Nonnull<const GenericBinding*>> deduced_bindings_in_order_;
   Nonnull<TraceStream*> trace_stream_;
+  // The depth of recursive calls to `Deduce`.
+  int depth_ = 0;
 
   // Values for deduced bindings.
   std::map<Nonnull<const GenericBinding*>,
@@ -1097,6 +1124,79 @@ auto TypeChecker::ArgumentDeduction::Deduce(Nonnull<const Value*> param,
                                             Nonnull<const Value*> arg,
                                             bool allow_implicit_conversion)
     -> ErrorOr<Success> {
+  // Only top-level deductions are cached. The cache isn't used while tracing,
+  // so that the trace shows each step.
+  if (depth_ > 0 || trace_stream_->is_enabled()) {
+    ++depth_;
+    auto decrement_depth = llvm::make_scope_exit([&] { --depth_; });
+    return DeduceImpl(param, arg, allow_implicit_conversion);
+  }
+
+  auto [it, inserted] = type_checker_->deduction_cache_.insert(
+      {{param, arg, allow_implicit_conversion,
+        std::vector<Nonnull<const GenericBinding*>>(
+            deduced_bindings_in_order_.begin(),
+            deduced_bindings_in_order_.end())},
+       {}});
+  if (!inserted) {
+    ++type_checker_->cache_stats_.deduction_hits;
+    return Replay(it->second);
+  }
+  ++type_checker_->cache_stats_.deduction_misses;
+  return DeduceAndRecord(param, arg, allow_implicit_conversion, it->second);
+}
+
+auto TypeChecker::ArgumentDeduction::DeduceAndRecord(
+    Nonnull<const Value*> param, Nonnull<const Value*> arg,
+    bool allow_implicit_conversion, DeductionCacheEntry& entry)
+    -> ErrorOr<Success> {
+  std::map<Nonnull<const GenericBinding*>, size_t> old_sizes;
+  for (const auto& [binding, values] : deduced_values_) {
+    old_sizes[binding] = values.size();
+  }
+  size_t old_mismatches = non_deduced_mismatches_.size();
+
+  ++depth_;
+  ErrorOr<Success> result = DeduceImpl(param, arg, allow_implicit_conversion);
+  --depth_;
+
+  for (const auto& [binding, values] : deduced_values_) {
+    for (size_t i = old_sizes[binding]; i < values.size(); ++i) {
+      entry.deduced_values.push_back({binding, values[i]});
+    }
+  }
+  for (size_t i = old_mismatches; i < non_deduced_mismatches_.size(); ++i) {
+    const NonDeducedMismatch& mismatch = non_deduced_mismatches_[i];
+    entry.non_deduced_mismatches.push_back(
+        {mismatch.param, mismatch.arg, mismatch.allow_implicit_conversion});
+  }
+  if (!result.ok()) {
+    entry.error = result.error().message();
+  }
+  return result;
+}
+
+auto TypeChecker::ArgumentDeduction::Replay(const DeductionCacheEntry& entry)
+    -> ErrorOr<Success> {
+  for (const auto& [binding, value] : entry.deduced_values) {
+    deduced_values_[binding].push_back(value);
+  }
+  for (const auto& [param, arg, allow_implicit_conversion] :
+       entry.non_deduced_mismatches) {
+    non_deduced_mismatches_.push_back(
+        {.param = param,
+         .arg = arg,
+         .allow_implicit_conversion = allow_implicit_conversion});
+  }
+  if (entry.error) {
+    return ProgramError(source_loc_) << *entry.error;
+  }
+  return Success();
+}
+
+auto TypeChecker::ArgumentDeduction::DeduceImpl(
+    Nonnull<const Value*> param, Nonnull<const Value*> arg,
+    bool allow_implicit_conversion) -> ErrorOr<Success> {
   if (trace_stream_->is_enabled()) {
     trace_stream_->Start() << "deducing `" << *param << "` from `" << *arg
                            << "`\n";
@@ -2102,6 +2202,41 @@ auto TypeChecker::Substitute(const Bindings& bindings,
     return type;
   }
 
+  // The cache isn't used while tracing, so that the trace shows each
+  // substitution.
+  if (trace_stream_->is_enabled()) {
+    return SubstituteAndTrace(bindings, type);
+  }
+
+  std::pair<const Value*, size_t> key(
+      type, llvm::hash_combine(llvm::hash_combine_range(bindings.args().begin(),
+                                                        bindings.args().end()),
+                               llvm::hash_combine_range(
+                                   bindings.witnesses().begin(),
+                                   bindings.witnesses().end())));
+  if (auto it = substitution_cache_.find(key);
+      it != substitution_cache_.end() && it->second.args == bindings.args() &&
+      it->second.witnesses == bindings.witnesses()) {
+    ++cache_stats_.substitution_hits;
+    return it->second.result;
+  }
+  int64_t old_context_uses = substitution_context_uses_;
+  CARBON_ASSIGN_OR_RETURN(const auto* result, SubstituteImpl(bindings, type));
+  if (substitution_context_uses_ == old_context_uses) {
+    ++cache_stats_.substitution_misses;
+    // After a hash collision, only the latest substitution is kept.
+    substitution_cache_[key] = {.args = bindings.args(),
+                                .witnesses = bindings.witnesses(),
+                                .result = result};
+  } else {
+    ++cache_stats_.substitution_uncacheable;
+  }
+  return result;
+}
+
+auto TypeChecker::SubstituteAndTrace(const Bindings& bindings,
+                                     Nonnull<const Value*> type) const
+    -> ErrorOr<Nonnull<const Value*>> {
   CARBON_ASSIGN_OR_RETURN(const auto* result, SubstituteImpl(bindings, type));
 
   if (trace_stream_->is_enabled()) {
@@ -2119,6 +2254,23 @@ auto TypeChecker::Substitute(const Bindings& bindings,
   return result;
 }
 
+auto TypeChecker::CacheStats::operator+=(const CacheStats& other)
+    -> CacheStats& {
+  substitution_hits += other.substitution_hits;
+  substitution_misses += other.substitution_misses;
+  substitution_uncacheable += other.substitution_uncacheable;
+  deduction_hits += other.deduction_hits;
+  deduction_misses += other.deduction_misses;
+  return *this;
+}
+
+void TypeChecker::CacheStats::Print(llvm::raw_ostream& out) const {
+  out << "substitution: " << substitution_hits << " hits, "
+      << substitution_misses << " misses, " << substitution_uncacheable
+      << " uncacheable; deduction: " << deduction_hits << " hits, "
+      << deduction_misses << " misses";
+}
+
 auto TypeChecker::RebuildValue(Nonnull<const Value*> value) const
     -> ErrorOr<Nonnull<const Value*>> {
   return SubstituteImpl(Bindings(), value);
@@ -2338,6 +2490,7 @@ auto TypeChecker::RefineWitness(Nonnull<const Witness*> witness,
 
   // Attempt to look for an impl witness in the top-level impl scope.
   // TODO: Provide a location.
+  ++substitution_context_uses_;
   CARBON_ASSIGN_OR_RETURN(
       std::optional<Nonnull<const Witness*>> refined_witness,
       (*top_level_impl_scope_)
@@ -2379,7 +2532,8 @@ auto TypeChecker::MatchImpl(const InterfaceType& iface,
                            << *impl.interface << "` (" << source_loc << ")\n";
   }
 
-  ArgumentDeduction deduction(source_loc, "match", impl.deduced, trace_stream_);
+  ArgumentDeduction deduction(this, source_loc, "match", impl.deduced,
+                              trace_stream_);
   if (ErrorOr<Success> e =
           deduction.Deduce(impl.type, impl_type,
                            /*allow_implicit_conversion=*/false);
@@ -2497,8 +2651,8 @@ auto TypeChecker::DeduceCallBindings(
   }
 
   // Deductions performed for deduced parameters and generic parameters.
-  ArgumentDeduction deduction(call.source_loc(), "call", deduced_bindings,
-                              trace_stream_);
+  ArgumentDeduction deduction(this, call.source_loc(), "call",
+                              deduced_bindings, trace_stream_);
 
   // Deduce and/or convert each argument to the corresponding
   // parameter.
@@ -2603,6 +2757,9 @@ auto TypeChecker::LookupRewriteInTypeOf(
   // rewrites. These rewrites may not be complete -- earlier rewrites will have
   // been applied to later ones, but not vice versa -- but those are the
   // intended semantics in this case.
+  if (!partial_constraint_types_.empty()) {
+    ++substitution_context_uses_;
+  }
   for (auto* builder : partial_constraint_types_) {
     if (ValueEqual(type, builder->GetSelfType(), std::nullopt)) {
       if (auto result = LookupRewrite(builder->rewrite_constraints(), interface,
@@ -2628,6 +2785,7 @@ auto TypeChecker::LookupRewriteInTypeOf(
       // binding. This happens when forming the type of a generic binding. Just
       // say there are no rewrites yet; any rewrites will be applied when the
       // constraint on the binding's type is resolved.
+      ++substitution_context_uses_;
       return {std::nullopt};
     }
     return LookupRewrite(&var_type->binding().static_type(), interface, member);
@@ -2642,6 +2800,7 @@ auto TypeChecker::LookupRewriteInTypeOf(
       // associated constant, if `.Self` is used to access an associated
       // constant. Just say that there are not rewrites yet; any rewrites will
       // be applied when the constraint on the binding's type is resolved.
+      ++substitution_context_uses_;
       return {std::nullopt};
     }
     // The following is an expanded version of
@@ -3884,6 +4043,51 @@ auto TypeChecker::TypeCheckExpImpl(Nonnull<Expression*> e,
           e->set_expression_category(ExpressionCategory::Value);
           return Success();
         }
+        case IntrinsicExpression::Intrinsic::StrConcat: {
+          if (args.size() != 2) {
+            return ProgramError(e->source_loc())
+                   << "__intrinsic_str_concat takes 2 arguments";
+          }
+          CARBON_RETURN_IF_ERROR(ExpectExactType(
+              e->source_loc(), "__intrinsic_str_concat argument 1",
+              arena_->New<StringType>(), &args[0]->static_type(), impl_scope));
+          CARBON_RETURN_IF_ERROR(ExpectExactType(
+              e->source_loc(), "__intrinsic_str_concat argument 2",
+              arena_->New<StringType>(), &args[1]->static_type(), impl_scope));
+          e->set_static_type(arena_->New<StringType>());
+          e->set_expression_category(ExpressionCategory::Value);
+          return Success();
+        }
+        case IntrinsicExpression::Intrinsic::StrLength: {
+          if (args.size() != 1) {
+            return ProgramError(e->source_loc())
+                   << "__intrinsic_str_length takes 1 argument";
+          }
+          CARBON_RETURN_IF_ERROR(ExpectExactType(
+              e->source_loc(), "__intrinsic_str_length argument",
+              arena_->New<StringType>(), &args[0]->static_type(), impl_scope));
+          e->set_static_type(arena_->New<IntType>());
+          e->set_expression_category(ExpressionCategory::Value);
+          return Success();
+        }
+        case IntrinsicExpression::Intrinsic::StrSlice: {
+          if (args.size() != 3) {
+            return ProgramError(e->source_loc())
+                   << "__intrinsic_str_slice takes 3 arguments";
+          }
+          CARBON_RETURN_IF_ERROR(ExpectExactType(
+              e->source_loc(), "__intrinsic_str_slice argument 1",
+              arena_->New<StringType>(), &args[0]->static_type(), impl_scope));
+          CARBON_RETURN_IF_ERROR(ExpectExactType(
+              e->source_loc(), "__intrinsic_str_slice argument 2",
+              arena_->New<IntType>(), &args[1]->static_type(), impl_scope));
+          CARBON_RETURN_IF_ERROR(ExpectExactType(
+              e->source_loc(), "__intrinsic_str_slice argument 3",
+              arena_->New<IntType>(), &args[2]->static_type(), impl_scope));
+          e->set_static_type(arena_->New<StringType>());
+          e->set_expression_category(ExpressionCategory::Value);
+          return Success();
+        }
         case IntrinsicExpression::Intrinsic::IntBitComplement:
           if (args.size() != 1) {
             return ProgramError(e->source_loc())
@@ -4626,6 +4830,14 @@ auto TypeChecker::TypeCheckStmt(Nonnull<Statement*> s,
                               &match.expression(), expected_type.value()));
         match.set_expression(converted_expression);
       }
+      std::vector<Nonnull<const Pattern*>> clause_patterns;
+      for (const auto& clause : match.clauses()) {
+        clause_patterns.push_back(&clause.pattern());
+      }
+      if (auto decision_tree = MatchDecisionTree::Build(clause_patterns)) {
+        match.set_decision_tree(
+            arena_->New<MatchDecisionTree>(std::move(*decision_tree)));
+      }
       return Success();
     }
     case StatementKind::While: {
@@ -5658,7 +5870,7 @@ auto TypeChecker::CheckImplIsDeducible(
     Nonnull<const InterfaceType*> impl_iface,
     llvm::ArrayRef<Nonnull<const GenericBinding*>> deduced_bindings,
     const ImplScope& /*impl_scope*/) -> ErrorOr<Success> {
-  ArgumentDeduction deduction(source_loc, "impl", deduced_bindings,
+  ArgumentDeduction deduction(this, source_loc, "impl", deduced_bindings,
                               trace_stream_);
   CARBON_RETURN_IF_ERROR(deduction.Deduce(impl_type, impl_type,
                                           /*allow_implicit_conversion=*/false));
@@ -5814,7 +6026,8 @@ auto TypeChecker::DeclareImplDeclaration(Nonnull<ImplDeclaration*> impl_decl,
       template_info.param_map.insert(
           {deduced, context.GetExistingClone(deduced)});
     }
-    templates_.insert({impl_decl, std::move(template_info)});
+    std::lock_guard lock(templates_->mutex);
+    templates_->infos.insert({impl_decl, std::move(template_info)});
   }
 
   ImplScope impl_scope(scope_info.innermost_scope);
@@ -6150,6 +6363,56 @@ auto TypeChecker::DeclareAliasDeclaration(Nonnull<AliasDeclaration*> alias,
   return Success();
 }
 
+class TypeChecker::DeferredBodies {
+ public:
+  // A deferred function body.
+  struct Body {
+    enum class State { Pending, Checking, Done };
+
+    Nonnull<FunctionDeclaration*> function;
+    // The top-level impls and builtins declared before the body. These are
+    // all that checking the body sequentially would see.
+    ImplScope impl_scope;
+    Builtins builtins;
+    // The index of the function in the program's top-level declarations.
+    size_t declaration_index;
+    State state = State::Pending;
+    // The error from checking the body, if any.
+    std::optional<Error> error;
+  };
+
+  // Guards the state of the bodies, and is notified when one is done.
+  std::mutex mutex;
+  std::condition_variable done;
+
+  // The bodies in program order, and their indexes. A deque is used so that
+  // the impl scopes don't move while bodies are being checked.
+  std::deque<Body> bodies;
+  llvm::DenseMap<const FunctionDeclaration*, size_t> indexes;
+
+  // The output printed while checking each top-level declaration, including
+  // its deferred body, in program order.
+  std::deque<std::string> outputs;
+
+  // The next body for a worker to start on.
+  std::atomic<size_t> next_body = 0;
+};
+
+TypeChecker::TypeChecker(const TypeChecker& parent,
+                         Nonnull<DeferredBodies*> deferred_bodies)
+    : arena_(parent.arena_),
+      builtins_(parent.builtins_),
+      collected_members_(parent.collected_members_),
+      trace_stream_(parent.trace_stream_),
+      print_stream_(parent.print_stream_),
+      top_level_impl_scope_(parent.top_level_impl_scope_),
+      templates_(parent.templates_),
+      num_threads_(parent.num_threads_),
+      deferred_bodies_(deferred_bodies),
+      worker_trace_stream_(std::make_unique<TraceStream>()) {
+  trace_stream_ = worker_trace_stream_.get();
+}
+
 auto TypeChecker::TypeCheck(AST& ast) -> ErrorOr<Success> {
   ImplScope impl_scope;
   ScopeInfo top_level_scope_info = ScopeInfo::ForNonClassScope(&impl_scope);
@@ -6159,20 +6422,177 @@ auto TypeChecker::TypeCheck(AST& ast) -> ErrorOr<Success> {
   llvm::SaveAndRestore<decltype(top_level_impl_scope_)>
       set_top_level_impl_scope(top_level_impl_scope_, &impl_scope);
 
-  for (auto declaration : ast.declarations) {
-    set_file_ctx.update_source_loc(declaration->source_loc());
+  // Defer the bodies of top-level functions when checking in parallel. Traces
+  // are always produced sequentially. Functions with an `auto` return type
+  // are checked when they're declared.
+  std::optional<DeferredBodies> deferred;
+  if (num_threads_ > 1 && !trace_stream_->is_enabled()) {
+    deferred.emplace();
+  }
+  llvm::SaveAndRestore<decltype(deferred_bodies_)> set_deferred_bodies(
+      deferred_bodies_,
+      deferred ? std::optional(&*deferred) : std::nullopt);
+
+  auto check_declaration =
+      [&](Nonnull<Declaration*> declaration) -> ErrorOr<Success> {
     CARBON_RETURN_IF_ERROR(
         DeclareDeclaration(declaration, top_level_scope_info));
-    CARBON_RETURN_IF_ERROR(
-        TypeCheckDeclaration(declaration, impl_scope, std::nullopt));
+    auto* function = dyn_cast<FunctionDeclaration>(declaration);
+    if (deferred && function && function->body().has_value() &&
+        !function->return_term().is_auto()) {
+      deferred->indexes.insert({function, deferred->bodies.size()});
+      deferred->bodies.push_back(
+          {.function = function,
+           .impl_scope = impl_scope,
+           .builtins = builtins_,
+           .declaration_index = deferred->outputs.size() - 1});
+      return Success();
+    }
+    return TypeCheckDeclaration(declaration, impl_scope, std::nullopt);
+  };
+
+  for (auto declaration : ast.declarations) {
+    set_file_ctx.update_source_loc(declaration->source_loc());
+    ErrorOr<Success> result = [&] {
+      if (!deferred) {
+        return check_declaration(declaration);
+      }
+      // Output is buffered so that it's printed in program order.
+      llvm::raw_string_ostream output(deferred->outputs.emplace_back());
+      llvm::SaveAndRestore<decltype(print_stream_)> set_print_stream(
+          print_stream_, &output);
+      return check_declaration(declaration);
+    }();
+    if (!result.ok()) {
+      // Errors in earlier function bodies come first.
+      return CheckDeferredBodies(std::move(result));
+    }
     // Check to see if this declaration is a builtin.
     // TODO: Only do this when type-checking the prelude.
     builtins_.Register(declaration);
   }
+  CARBON_RETURN_IF_ERROR(CheckDeferredBodies(Success()));
   CARBON_RETURN_IF_ERROR(TypeCheckExp(*ast.main_call, impl_scope));
   return Success();
 }
 
+auto TypeChecker::CheckDeferredBodies(ErrorOr<Success> declarations_result)
+    -> ErrorOr<Success> {
+  if (!deferred_bodies_) {
+    return declarations_result;
+  }
+  DeferredBodies& deferred = **deferred_bodies_;
+  int num_workers =
+      std::min<int>(num_threads_, std::max<size_t>(deferred.bodies.size(), 1));
+  auto work = [&deferred](TypeChecker& worker) {
+    // Worker threads need a large stack, as the main thread does.
+    return RunWithExtraStack([&]() -> bool {
+      for (size_t index = deferred.next_body++; index < deferred.bodies.size();
+           index = deferred.next_body++) {
+        // Errors are recorded on the body.
+        auto result = worker.CheckDeferredBody(index);
+        static_cast<void>(result);
+      }
+      return true;
+    });
+  };
+
+  // The other workers start from the declarations checked so far, and keep
+  // their own caches, except for template instantiations. This thread is also
+  // a worker.
+  std::vector<std::unique_ptr<TypeChecker>> workers;
+  if (num_workers > 1) {
+    arena_->set_thread_safe(true);
+    llvm::ThreadPool pool(llvm::hardware_concurrency(num_workers - 1));
+    for (int i = 1; i < num_workers; ++i) {
+      workers.push_back(
+          std::unique_ptr<TypeChecker>(new TypeChecker(*this, &deferred)));
+      pool.async(work, std::ref(*workers.back()));
+    }
+    work(*this);
+    pool.wait();
+    arena_->set_thread_safe(false);
+  } else {
+    work(*this);
+  }
+  for (const auto& worker : workers) {
+    cache_stats_ += worker->cache_stats_;
+  }
+
+  // Print the output up to the first error in program order, and return that
+  // error, as checking sequentially would.
+  auto first_error = llvm::find_if(deferred.bodies,
+                                   [](const DeferredBodies::Body& body) {
+                                     return body.error.has_value();
+                                   });
+  size_t num_outputs = first_error == deferred.bodies.end()
+                           ? deferred.outputs.size()
+                           : first_error->declaration_index + 1;
+  for (size_t i = 0; i < num_outputs; ++i) {
+    *print_stream_ << deferred.outputs[i];
+  }
+  if (first_error != deferred.bodies.end()) {
+    return Error(first_error->error->location(),
+                 first_error->error->message());
+  }
+  return declarations_result;
+}
+
+auto TypeChecker::CheckDeferredBody(size_t index) -> ErrorOr<Success> {
+  using State = DeferredBodies::Body::State;
+  DeferredBodies& deferred = **deferred_bodies_;
+  DeferredBodies::Body& body = deferred.bodies[index];
+  std::unique_lock lock(deferred.mutex);
+  if (body.state == State::Pending) {
+    body.state = State::Checking;
+    lock.unlock();
+    ErrorOr<Success> result = [&] {
+      llvm::SaveAndRestore<std::optional<size_t>> set_current_body(
+          current_body_, index);
+      llvm::SaveAndRestore<decltype(top_level_impl_scope_)>
+          set_top_level_impl_scope(top_level_impl_scope_, &body.impl_scope);
+      llvm::SaveAndRestore<Builtins> set_builtins(builtins_, body.builtins);
+      llvm::raw_string_ostream output(
+          deferred.outputs[body.declaration_index]);
+      llvm::SaveAndRestore<decltype(print_stream_)> set_print_stream(
+          print_stream_, &output);
+      return TypeCheckDeclaration(body.function, body.impl_scope,
+                                  std::nullopt);
+    }();
+    lock.lock();
+    if (!result.ok()) {
+      body.error = std::move(result).error();
+    }
+    body.state = State::Done;
+    deferred.done.notify_all();
+  } else {
+    // Bodies only wait for earlier bodies, so this can't deadlock.
+    deferred.done.wait(lock, [&] { return body.state == State::Done; });
+  }
+  if (body.error) {
+    return Error(body.error->location(), body.error->message());
+  }
+  return Success();
+}
+
+auto TypeChecker::CheckBeforeCompileTimeCall(
+    const FunctionDeclaration& function) -> ErrorOr<bool> {
+  DeferredBodies& deferred = **deferred_bodies_;
+  auto it = deferred.indexes.find(&function);
+  if (it == deferred.indexes.end()) {
+    // The function was checked before any bodies were checked in parallel.
+    return function.is_type_checked();
+  }
+  // As when checking sequentially, a body can only call functions whose
+  // bodies come before it in the program. Whether a later body has been
+  // checked by another worker yet depends on timing, so isn't consulted.
+  if (current_body_ && it->second >= *current_body_) {
+    return false;
+  }
+  CARBON_RETURN_IF_ERROR(CheckDeferredBody(it->second));
+  return true;
+}
+
 auto TypeChecker::TypeCheckDeclaration(
     Nonnull<Declaration*> d, const ImplScope& impl_scope,
     std::optional<Nonnull<const Declaration*>> enclosing_decl)
@@ -6517,8 +6937,11 @@ auto TypeChecker::InstantiateImplDeclaration(
 
   SetFileContext set_file_context(*trace_stream_, pattern->source_loc());
 
-  auto it = templates_.find(pattern);
-  CARBON_CHECK(it != templates_.end());
+  // Entries in `templates_` aren't modified once added, except for their
+  // instantiations, so `info` can be read without holding the lock.
+  std::unique_lock lock(templates_->mutex);
+  auto it = templates_->infos.find(pattern);
+  CARBON_CHECK(it != templates_->infos.end());
   const TemplateInfo& info = it->second;
 
   if (auto instantiation = info.instantiations.find(bindings);
@@ -6528,6 +6951,9 @@ auto TypeChecker::InstantiateImplDeclaration(
     }
     return instantiation->second;
   }
+  // Instantiation can require other instantiations, and can wait for other
+  // workers, so the lock isn't held while it's performed.
+  lock.unlock();
 
   CloneContext context(arena_);
   Nonnull<ImplDeclaration*> impl =
@@ -6615,12 +7041,24 @@ auto TypeChecker::InstantiateImplDeclaration(
 
   auto* result = arena_->New<ImplWitness>(
       impl, arena_->New<Bindings>(std::move(new_bindings)));
-  CARBON_CHECK(info.instantiations.insert({bindings, result}).second);
-  return result;
+  // Another worker may have performed the same instantiation meanwhile. The
+  // first one cached is used by everyone.
+  lock.lock();
+  auto [instantiation, inserted] =
+      info.instantiations.insert({bindings, result});
+  CARBON_CHECK(inserted || deferred_bodies_)
+      << "template instantiated while instantiating itself";
+  return instantiation->second;
 }
 
 auto TypeChecker::InterpExp(Nonnull<const Expression*> e)
     -> ErrorOr<Nonnull<const Value*>> {
+  if (deferred_bodies_) {
+    return Carbon::InterpExp(e, arena_, trace_stream_, print_stream_,
+                             [&](const FunctionDeclaration& function) {
+                               return CheckBeforeCompileTimeCall(function);
+                             });
+  }
   return Carbon::InterpExp(e, arena_, trace_stream_, print_stream_);
 }
 
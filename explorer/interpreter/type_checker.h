@@ -5,6 +5,10 @@
 #ifndef CARBON_EXPLORER_INTERPRETER_TYPE_CHECKER_H_
 #define CARBON_EXPLORER_INTERPRETER_TYPE_CHECKER_H_
 
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string_view>
@@ -26,6 +30,7 @@
 #include "explorer/interpreter/interpreter.h"
 #include "explorer/interpreter/matching_impl_set.h"
 #include "explorer/interpreter/stack_space.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/identity.h"
 
 namespace Carbon {
@@ -53,17 +58,41 @@ class TypeChecker {
     BindingType,
   };
 
+  // Function bodies are type-checked on `num_threads` threads; see
+  // `TypeCheck`.
   explicit TypeChecker(Nonnull<Arena*> arena,
                        Nonnull<TraceStream*> trace_stream,
-                       Nonnull<llvm::raw_ostream*> print_stream)
+                       Nonnull<llvm::raw_ostream*> print_stream,
+                       int num_threads = 1)
       : arena_(arena),
         trace_stream_(trace_stream),
-        print_stream_(print_stream) {}
+        print_stream_(print_stream),
+        num_threads_(num_threads) {}
+
+  // Counters for the substitution and deduction caches.
+  struct CacheStats : public Printable<CacheStats> {
+    void Print(llvm::raw_ostream& out) const;
+    auto operator+=(const CacheStats& other) -> CacheStats&;
+
+    int64_t substitution_hits = 0;
+    int64_t substitution_misses = 0;
+    // Substitutions whose result depended on the type-checking context, such
+    // as the impls declared so far, and so weren't cached.
+    int64_t substitution_uncacheable = 0;
+    int64_t deduction_hits = 0;
+    int64_t deduction_misses = 0;
+  };
 
   // Type-checks `ast` and sets properties such as `static_type`, as documented
   // on the individual nodes.
   // On failure, `ast` is left in a partial state and should not be further
   // processed.
+  //
+  // With more than one thread, and while not tracing, the bodies of top-level
+  // functions are checked in parallel once all declarations have been
+  // checked. Each body only sees the declarations before it, and output and
+  // the first error are reported in program order, so the result is the same
+  // as when checking sequentially.
   auto TypeCheck(AST& ast) -> ErrorOr<Success>;
 
   // Construct a value that is the same as `value` except that occurrences
@@ -85,6 +114,8 @@ class TypeChecker {
     return llvm::cast<T>(subst_value);
   }
 
+  auto cache_stats() const -> const CacheStats& { return cache_stats_; }
+
   // Attempts to refine a witness that might be symbolic into an impl witness,
   // using `impl` declarations that have been declared and type-checked so far.
   // If a more precise witness cannot be found, returns `witness`.
@@ -474,6 +505,11 @@ class TypeChecker {
   auto RebuildValue(Nonnull<const Value*> value) const
       -> ErrorOr<Nonnull<const Value*>>;
 
+  // Substitutes without using the cache, and traces the substitution.
+  auto SubstituteAndTrace(const Bindings& bindings,
+                          Nonnull<const Value*> type) const
+      -> ErrorOr<Nonnull<const Value*>>;
+
   // Implementation of Substitute and RebuildValue. Does not check that
   // bindings are nonempty, nor does it trace its progress.
   auto SubstituteImpl(const Bindings& bindings,
@@ -565,6 +601,31 @@ class TypeChecker {
   auto InterpExp(Nonnull<const Expression*> e)
       -> ErrorOr<Nonnull<const Value*>>;
 
+  // Function bodies whose type-checking is deferred so that they can be
+  // checked in parallel.
+  class DeferredBodies;
+
+  // Constructs a type checker for a worker thread checking `deferred_bodies`,
+  // which shares the declarations checked by `parent`.
+  explicit TypeChecker(const TypeChecker& parent,
+                       Nonnull<DeferredBodies*> deferred_bodies);
+
+  // Type-checks the deferred bodies, then prints the buffered output of the
+  // top-level declarations. Returns the first error in program order, which is
+  // `declarations_result` if no deferred body has an error.
+  auto CheckDeferredBodies(ErrorOr<Success> declarations_result)
+      -> ErrorOr<Success>;
+
+  // Type-checks deferred body `index` if no worker has started on it yet, or
+  // waits for the worker checking it. Returns the result of checking it.
+  auto CheckDeferredBody(size_t index) -> ErrorOr<Success>;
+
+  // Before `function` is called at compile time, type-checks its body if that
+  // was deferred. Returns whether the body has been type-checked at this point
+  // in sequential checking.
+  auto CheckBeforeCompileTimeCall(const FunctionDeclaration& function)
+      -> ErrorOr<bool>;
+
   Nonnull<Arena*> arena_;
   Builtins builtins_;
 
@@ -615,8 +676,76 @@ class TypeChecker {
   };
 
   // Map from template declarations to extra information we use to type-check
-  // and instantiate the template.
-  std::map<const Declaration*, TemplateInfo> templates_;
+  // and instantiate the template. This is shared with the workers that check
+  // function bodies in parallel, so that each instantiation is cached once for
+  // all of them.
+  struct Templates {
+    // Guards `infos`, including their instantiations.
+    std::mutex mutex;
+    std::map<const Declaration*, TemplateInfo> infos;
+  };
+  std::shared_ptr<Templates> templates_ = std::make_shared<Templates>();
+
+  // A cached substitution result, with the bindings it was computed for.
+  struct SubstitutionCacheEntry {
+    BindingMap args;
+    ImplWitnessMap witnesses;
+    const Value* result;
+  };
+
+  // Cache of substitution results, keyed by the substituted value and a hash
+  // of the bindings' (binding, value) pointers. Values are canonicalized, so
+  // equal substitutions have the same key, and the entry's bindings are
+  // compared to rule out hash collisions. Substitutions which consult the
+  // type-checking context aren't cached; see `substitution_context_uses_`.
+  mutable llvm::DenseMap<std::pair<const Value*, size_t>,
+                         SubstitutionCacheEntry>
+      substitution_cache_;
+
+  // The number of times substitution has depended on the type-checking
+  // context, for example on the impls declared so far or on constraints that
+  // are still being built. Substitution results are only cached if this
+  // doesn't change while they're computed.
+  mutable int64_t substitution_context_uses_ = 0;
+
+  // The outcome of a top-level `ArgumentDeduction::Deduce` call. Deduction
+  // doesn't depend on the type-checking context, so this is replayed when the
+  // same deduction is performed again.
+  struct DeductionCacheEntry {
+    // The values deduced for each binding, in order.
+    std::vector<
+        std::pair<Nonnull<const GenericBinding*>, Nonnull<const Value*>>>
+        deduced_values;
+    // The (param, arg, allow_implicit_conversion) mismatches to check after
+    // substitution.
+    std::vector<std::tuple<Nonnull<const Value*>, Nonnull<const Value*>, bool>>
+        non_deduced_mismatches;
+    // The error message, without a location, if deduction failed.
+    std::optional<std::string> error;
+  };
+
+  // Cache of deduction results, keyed by the parameter, argument, whether
+  // implicit conversions are allowed, and the bindings to deduce.
+  mutable std::map<
+      std::tuple<Nonnull<const Value*>, Nonnull<const Value*>, bool,
+                 std::vector<Nonnull<const GenericBinding*>>>,
+      DeductionCacheEntry>
+      deduction_cache_;
+
+  mutable CacheStats cache_stats_;
+
+  // The number of threads for checking function bodies.
+  int num_threads_ = 1;
+
+  // The deferred function bodies, while checking a program in parallel.
+  std::optional<Nonnull<DeferredBodies*>> deferred_bodies_;
+
+  // The index of the deferred body being checked, if any.
+  std::optional<size_t> current_body_;
+
+  // Workers don't trace, and have their own trace stream so that they don't
+  // share its state.
+  std::unique_ptr<TraceStream> worker_trace_stream_;
 };
 
 }  // namespace Carbon
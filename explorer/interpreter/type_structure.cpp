@@ -5,6 +5,7 @@
 #include "explorer/interpreter/type_structure.h"
 
 #include <limits>
+#include <memory>
 
 #include "explorer/ast/declaration.h"
 #include "explorer/ast/expression_category.h"
@@ -77,6 +78,7 @@ struct TypeStructureBuilder {
   // Ignore values that can't contain holes.
   void Visit(int) {}
   void Visit(std::string_view) {}
+  void Visit(const std::shared_ptr<StringBuffer>&) {}
   void Visit(ExpressionCategory) {}
   void Visit(Nonnull<const AstNode*>) {}
   void Visit(const ValueNodeView&) {}
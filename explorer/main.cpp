@@ -6,6 +6,7 @@
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <cstring>
@@ -15,14 +16,21 @@
 #include <vector>
 
 #include "common/error.h"
+#include "explorer/base/trace_log.h"
 #include "explorer/base/trace_stream.h"
+#include "explorer/interpreter/profiler.h"
 #include "explorer/parse_and_execute/parse_and_execute.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace Carbon {
@@ -51,19 +59,191 @@ auto ExplorerMain(int argc, char** argv, void* static_for_main_addr,
                       llvm::outs(), *llvm::vfs::getRealFileSystem());
 }
 
+// The outcome of running one program in batch mode.
+struct BatchResult {
+  // Output from the Print intrinsic and tracing.
+  std::string output;
+  std::string trace;
+  // The printed profile, if profiling.
+  std::string profile;
+  // The program result, or the printed error on failure.
+  std::optional<int> result;
+  std::string error;
+  std::chrono::steady_clock::duration duration;
+};
+
+// Configures a program's trace stream to write to `stream`, using `log` for
+// binary trace output. `log` must outlive the trace stream.
+using ConfigureTraceFn = llvm::function_ref<void(
+    TraceStream&, Nonnull<llvm::raw_ostream*>, std::optional<TraceLogWriter>&)>;
+
+// The formats for `--profile_file` output.
+enum class ProfileFormat { Report, Folded };
+
+// Prints `profiler`'s profile to `out` in `format`.
+static auto PrintProfile(const Profiler& profiler, ProfileFormat format,
+                         llvm::raw_ostream& out) -> void {
+  switch (format) {
+    case ProfileFormat::Report:
+      profiler.PrintReport(out);
+      break;
+    case ProfileFormat::Folded:
+      profiler.PrintFoldedStacks(out);
+      break;
+  }
+}
+
+// Returns the number of milliseconds in `duration`, for printing.
+static auto ToMilliseconds(std::chrono::steady_clock::duration duration)
+    -> int64_t {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(duration)
+      .count();
+}
+
+// Runs each of `input_file_names` as a separate program on a pool of
+// `num_threads` threads, or all hardware threads if 0. Each program has its
+// own arena, heap and trace stream, and only the parsed prelude is shared.
+// Results are printed in input order once all programs finish, so output
+// doesn't depend on scheduling. If `profile_out_stream` is set, each program
+// is profiled separately. The `type_check_threads` threads for type-checking
+// function bodies are divided among the programs that run at once, so the
+// batch doesn't start a pool of that size for every program.
+static auto RunBatch(
+    llvm::vfs::FileSystem& fs, std::string_view prelude_file_name,
+    llvm::ArrayRef<std::string> input_file_names, bool parser_debug,
+    unsigned num_threads, int type_check_threads,
+    ConfigureTraceFn configure_trace, llvm::raw_ostream& out_stream,
+    llvm::raw_ostream& err_stream, llvm::raw_ostream* trace_out_stream,
+    llvm::raw_ostream* profile_out_stream, ProfileFormat profile_format)
+    -> int {
+  auto batch_start = std::chrono::steady_clock::now();
+  std::vector<BatchResult> results(input_file_names.size());
+  {
+    llvm::ThreadPoolStrategy strategy = llvm::hardware_concurrency(num_threads);
+    int num_concurrent_programs =
+        std::min<int>(strategy.compute_thread_count(), input_file_names.size());
+    int program_type_check_threads =
+        std::max(1, type_check_threads / std::max(1, num_concurrent_programs));
+    llvm::ThreadPool pool(strategy);
+    for (size_t i = 0; i < input_file_names.size(); ++i) {
+      pool.async([&, i] {
+        BatchResult& batch_result = results[i];
+        llvm::raw_string_ostream output(batch_result.output);
+        llvm::raw_string_ostream trace(batch_result.trace);
+        std::optional<TraceLogWriter> trace_log;
+        TraceStream trace_stream;
+        if (trace_out_stream) {
+          configure_trace(trace_stream, &trace, trace_log);
+        }
+        std::optional<Profiler> profiler;
+        if (profile_out_stream) {
+          profiler.emplace();
+        }
+        auto start = std::chrono::steady_clock::now();
+        ErrorOr<int> result = ParseAndExecute(
+            fs, prelude_file_name, input_file_names[i], parser_debug,
+            &trace_stream, &output,
+            profiler ? std::optional(&*profiler) : std::nullopt,
+            program_type_check_threads);
+        batch_result.duration = std::chrono::steady_clock::now() - start;
+        if (profiler) {
+          llvm::raw_string_ostream profile(batch_result.profile);
+          if (profile_format == ProfileFormat::Report) {
+            profile << "=== " << input_file_names[i] << "\n";
+          }
+          PrintProfile(*profiler, profile_format, profile);
+        }
+        if (result.ok()) {
+          batch_result.result = *result;
+        } else {
+          llvm::raw_string_ostream(batch_result.error) << result.error();
+        }
+      });
+    }
+    pool.wait();
+  }
+
+  int num_failed = 0;
+  for (size_t i = 0; i < input_file_names.size(); ++i) {
+    const BatchResult& batch_result = results[i];
+    const std::string& input_file_name = input_file_names[i];
+    out_stream << "=== " << input_file_name << "\n" << batch_result.output;
+    if (trace_out_stream) {
+      *trace_out_stream << batch_result.trace;
+    }
+    if (profile_out_stream) {
+      *profile_out_stream << batch_result.profile;
+    }
+    if (batch_result.result) {
+      out_stream << "result: " << *batch_result.result << "\n";
+    } else {
+      ++num_failed;
+      err_stream << batch_result.error << "\n";
+    }
+    out_stream << "=== " << input_file_name << ": "
+               << (batch_result.result ? "succeeded" : "failed") << " in "
+               << ToMilliseconds(batch_result.duration) << "ms\n";
+  }
+  out_stream << "=== " << input_file_names.size() - num_failed << " of "
+             << input_file_names.size() << " files succeeded in "
+             << ToMilliseconds(std::chrono::steady_clock::now() - batch_start)
+             << "ms\n";
+  return num_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 auto ExplorerMain(int argc, const char** argv, llvm::StringRef install_path,
                   llvm::StringRef relative_prelude_path,
                   llvm::raw_ostream& out_stream, llvm::raw_ostream& err_stream,
                   llvm::raw_ostream& out_stream_for_trace,
                   llvm::vfs::FileSystem& fs) -> int {
-  cl::opt<std::string> input_file_name(cl::Positional, cl::desc("<input file>"),
-                                       cl::Required);
+  cl::list<std::string> input_file_names(
+      cl::Positional, cl::desc("<input files>"), cl::ZeroOrMore);
+  cl::opt<std::string> batch_file_name(
+      "batch_file",
+      cl::desc("File listing input files to run in batch mode, one per line; "
+               "set to `-` to read stdin. Batch mode is also used when "
+               "multiple input files are given."));
+  cl::opt<unsigned> threads(
+      "threads",
+      cl::desc("Number of threads to run programs on in batch mode; 0 uses "
+               "all hardware threads."),
+      cl::init(0));
+  cl::opt<unsigned> type_check_threads(
+      "type_check_threads",
+      cl::desc("Number of threads to type-check function bodies on; 0 uses "
+               "all hardware threads. Bodies are checked sequentially while "
+               "tracing. In batch mode, the threads are divided among the "
+               "programs that run at once."),
+      cl::init(1));
   cl::opt<bool> parser_debug("parser_debug",
                              cl::desc("Enable debug output from the parser"));
   cl::opt<std::string> trace_file_name(
       "trace_file",
       cl::desc("Output file for tracing; set to `-` to output to stdout."));
 
+  cl::opt<std::string> profile_file_name(
+      "profile_file",
+      cl::desc("Output file for an execution profile; set to `-` to output to "
+               "stdout."));
+  cl::opt<ProfileFormat> profile_format(
+      "profile_format", cl::desc("The format of the execution profile."),
+      cl::values(
+          clEnumValN(ProfileFormat::Report, "report",
+                     "Counters for each function and action kind."),
+          clEnumValN(ProfileFormat::Folded, "folded",
+                     "Folded call stacks weighted by steps, for flame graph "
+                     "tools.")),
+      cl::init(ProfileFormat::Report));
+
+  enum class TraceFormat { Text, Binary };
+  cl::opt<TraceFormat> trace_format(
+      "trace_format", cl::desc("The format of the trace output."),
+      cl::values(clEnumValN(TraceFormat::Text, "text", "Text."),
+                 clEnumValN(TraceFormat::Binary, "binary",
+                            "A compact binary log, which is faster to write. "
+                            "Use `trace_decoder` to print it as text.")),
+      cl::init(TraceFormat::Text));
+
   cl::list<ProgramPhase> trace_phases(
       "trace_phase",
       cl::desc("Select the program phases to include in the output. By "
@@ -127,42 +307,52 @@ auto ExplorerMain(int argc, const char** argv, llvm::StringRef install_path,
   auto reset_parser =
       llvm::make_scope_exit([] { cl::ResetCommandLineParser(); });
 
-  // Set up a stream for trace output.
-  std::unique_ptr<llvm::raw_ostream> scoped_trace_stream;
-  TraceStream trace_stream;
-
-  if (!trace_file_name.empty()) {
-    // Adding allowed phases in the trace_stream.
-    trace_stream.set_allowed_phases(trace_phases);
+  int num_type_check_threads =
+      llvm::hardware_concurrency(type_check_threads).compute_thread_count();
 
-    // Translate --trace_file_context setting into a list of FileKinds.
-    llvm::SmallVector<FileKind> trace_file_kinds = {FileKind::Unknown};
-    if (!trace_file_contexts.getNumOccurrences()) {
-      trace_file_kinds.push_back(FileKind::Main);
-    } else {
-      for (auto context : trace_file_contexts) {
-        switch (context) {
-          case TraceFileContext::Main:
-            trace_file_kinds.push_back(FileKind::Main);
-            break;
-          case TraceFileContext::Prelude:
-            trace_file_kinds.push_back(FileKind::Prelude);
-            break;
-          case TraceFileContext::Import:
-            trace_file_kinds.push_back(FileKind::Import);
-            break;
-          case TraceFileContext::All:
-            trace_file_kinds.push_back(FileKind::Main);
-            trace_file_kinds.push_back(FileKind::Prelude);
-            trace_file_kinds.push_back(FileKind::Import);
-            break;
-        }
+  // Translate --trace_file_context setting into a list of FileKinds.
+  llvm::SmallVector<FileKind> trace_file_kinds = {FileKind::Unknown};
+  if (!trace_file_contexts.getNumOccurrences()) {
+    trace_file_kinds.push_back(FileKind::Main);
+  } else {
+    for (auto context : trace_file_contexts) {
+      switch (context) {
+        case TraceFileContext::Main:
+          trace_file_kinds.push_back(FileKind::Main);
+          break;
+        case TraceFileContext::Prelude:
+          trace_file_kinds.push_back(FileKind::Prelude);
+          break;
+        case TraceFileContext::Import:
+          trace_file_kinds.push_back(FileKind::Import);
+          break;
+        case TraceFileContext::All:
+          trace_file_kinds.push_back(FileKind::Main);
+          trace_file_kinds.push_back(FileKind::Prelude);
+          trace_file_kinds.push_back(FileKind::Import);
+          break;
       }
     }
+  }
+  auto configure_trace = [&](TraceStream& trace_stream,
+                             Nonnull<llvm::raw_ostream*> stream,
+                             std::optional<TraceLogWriter>& log) {
+    trace_stream.set_allowed_phases(trace_phases);
     trace_stream.set_allowed_file_kinds(trace_file_kinds);
+    if (trace_format == TraceFormat::Binary) {
+      log.emplace(stream);
+      trace_stream.set_log(&*log);
+    } else {
+      trace_stream.set_stream(stream);
+    }
+  };
 
+  // Set up a stream for trace output.
+  std::unique_ptr<llvm::raw_ostream> scoped_trace_stream;
+  llvm::raw_ostream* trace_out_stream = nullptr;
+  if (!trace_file_name.empty()) {
     if (trace_file_name == "-") {
-      trace_stream.set_stream(&out_stream_for_trace);
+      trace_out_stream = &out_stream_for_trace;
     } else {
       std::error_code err;
       scoped_trace_stream =
@@ -171,13 +361,79 @@ auto ExplorerMain(int argc, const char** argv, llvm::StringRef install_path,
         err_stream << err.message() << "\n";
         return EXIT_FAILURE;
       }
-      trace_stream.set_stream(scoped_trace_stream.get());
+      trace_out_stream = scoped_trace_stream.get();
+    }
+  }
+
+  // Set up a stream for profile output.
+  std::unique_ptr<llvm::raw_ostream> scoped_profile_stream;
+  llvm::raw_ostream* profile_out_stream = nullptr;
+  if (!profile_file_name.empty()) {
+    if (profile_file_name == "-") {
+      profile_out_stream = &out_stream;
+    } else {
+      std::error_code err;
+      scoped_profile_stream =
+          std::make_unique<llvm::raw_fd_ostream>(profile_file_name, err);
+      if (err) {
+        err_stream << err.message() << "\n";
+        return EXIT_FAILURE;
+      }
+      profile_out_stream = scoped_profile_stream.get();
     }
   }
 
-  ErrorOr<int> result =
-      ParseAndExecute(fs, prelude_file_name, input_file_name, parser_debug,
-                      &trace_stream, &out_stream);
+  if (input_file_names.size() > 1 || !batch_file_name.empty()) {
+    std::vector<std::string> batch_input_file_names(input_file_names.begin(),
+                                                    input_file_names.end());
+    if (!batch_file_name.empty()) {
+      auto batch_file = batch_file_name == "-"
+                            ? llvm::MemoryBuffer::getSTDIN()
+                            : fs.getBufferForFile(batch_file_name);
+      if (batch_file.getError()) {
+        err_stream << "Error reading " << batch_file_name << ": "
+                   << batch_file.getError().message() << "\n";
+        return EXIT_FAILURE;
+      }
+      llvm::SmallVector<llvm::StringRef> lines;
+      llvm::SplitString((*batch_file)->getBuffer(), lines, "\r\n");
+      for (llvm::StringRef line : lines) {
+        line = line.trim();
+        if (!line.empty()) {
+          batch_input_file_names.push_back(line.str());
+        }
+      }
+    }
+    return RunBatch(fs, prelude_file_name, batch_input_file_names,
+                    parser_debug, threads, num_type_check_threads,
+                    configure_trace, out_stream, err_stream, trace_out_stream,
+                    profile_out_stream, profile_format);
+  }
+
+  if (input_file_names.empty()) {
+    err_stream << "No input file; expected an input file or --batch_file.\n";
+    return EXIT_FAILURE;
+  }
+  const std::string& input_file_name = input_file_names.front();
+
+  std::optional<TraceLogWriter> trace_log;
+  TraceStream trace_stream;
+  if (trace_out_stream) {
+    configure_trace(trace_stream, trace_out_stream, trace_log);
+  }
+
+  std::optional<Profiler> profiler;
+  if (profile_out_stream) {
+    profiler.emplace();
+  }
+
+  ErrorOr<int> result = ParseAndExecute(
+      fs, prelude_file_name, input_file_name, parser_debug, &trace_stream,
+      &out_stream, profiler ? std::optional(&*profiler) : std::nullopt,
+      num_type_check_threads);
+  if (profiler) {
+    PrintProfile(*profiler, profile_format, *profile_out_stream);
+  }
   if (result.ok()) {
     // Print the return code to stdout.
     out_stream << "result: " << *result << "\n";
@@ -0,0 +1,98 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "common/check.h"
+#include "explorer/parse_and_execute/parse_and_execute.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+namespace Carbon {
+namespace {
+
+// The number of matches each program runs, split evenly across the
+// alternatives.
+constexpr int NumMatches = 512;
+
+// Returns a program which matches every alternative of a choice with
+// `num_alternatives` alternatives, `NumMatches` times in total. Matching
+// clause by clause, this takes time quadratic in `num_alternatives`.
+auto MakeProgram(int num_alternatives) -> std::string {
+  std::string source = "package Bench api;\nchoice Alt {\n";
+  for (int i = 0; i < num_alternatives; ++i) {
+    source += llvm::formatv("{0}  A{1}(i32)", i ? ",\n" : "", i);
+  }
+  source += R"(
+}
+
+fn Eval(alt: Alt) -> i32 {
+  var result: i32 = 0;
+  match (alt) {
+)";
+  for (int i = 0; i < num_alternatives; ++i) {
+    source +=
+        llvm::formatv("    case Alt.A{0}(x: i32) => {{ result = x; }\n", i);
+  }
+  source += "  }\n  return result;\n}\n\nfn Main() -> i32 {\n";
+  source += llvm::formatv("  var alts: [Alt; {0}] = (", num_alternatives);
+  for (int i = 0; i < num_alternatives; ++i) {
+    source += llvm::formatv("{0}Alt.A{1}({1})", i ? ", " : "", i);
+  }
+  source += llvm::formatv(R"();
+  var total: i32 = 0;
+  var rep: i32 = 0;
+  while (rep < {0}) {{
+    var i: i32 = 0;
+    while (i < {1}) {{
+      total = total + Eval(alts[i]);
+      i = i + 1;
+    }
+    rep = rep + 1;
+  }
+  return total;
+}
+)",
+                          NumMatches / num_alternatives, num_alternatives);
+  return source;
+}
+
+auto BM_Match(benchmark::State& state) -> void {
+  int num_alternatives = state.range(0);
+  llvm::vfs::InMemoryFileSystem fs;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> prelude =
+      llvm::MemoryBuffer::getFile("explorer/data/prelude.carbon");
+  CARBON_CHECK(prelude) << prelude.getError().message();
+  fs.addFile("prelude.carbon", /*ModificationTime=*/0, std::move(*prelude));
+  fs.addFile(
+      "bench.carbon", /*ModificationTime=*/0,
+      llvm::MemoryBuffer::getMemBufferCopy(MakeProgram(num_alternatives)));
+  // Each alternative holds its own index.
+  int expected = NumMatches / num_alternatives *
+                 (num_alternatives * (num_alternatives - 1) / 2);
+
+  for (auto _ : state) {
+    TraceStream trace_stream;
+    auto result =
+        ParseAndExecute(fs, "prelude.carbon", "bench.carbon",
+                        /*parser_debug=*/false, &trace_stream, &llvm::nulls());
+    CARBON_CHECK(result.ok()) << result.error();
+    CARBON_CHECK(*result == expected) << *result << " != " << expected;
+  }
+
+  state.counters["matches_per_second"] = benchmark::Counter(
+      NumMatches, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_Match)
+    ->Arg(8)
+    ->Arg(64)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace Carbon
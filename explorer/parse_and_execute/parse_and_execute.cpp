@@ -39,7 +39,9 @@ static auto PrintTimingOnExit(TraceStream* trace_stream, const char* label,
 auto ParseAndExecute(llvm::vfs::FileSystem& fs, std::string_view prelude_path,
                      std::string_view input_file_name, bool parser_debug,
                      Nonnull<TraceStream*> trace_stream,
-                     Nonnull<llvm::raw_ostream*> print_stream) -> ErrorOr<int> {
+                     Nonnull<llvm::raw_ostream*> print_stream,
+                     std::optional<Nonnull<Profiler*>> profiler,
+                     int type_check_threads) -> ErrorOr<int> {
   return RunWithExtraStack([&]() -> ErrorOr<int> {
     Arena arena;
     auto cursor = std::chrono::steady_clock::now();
@@ -58,7 +60,8 @@ auto ParseAndExecute(llvm::vfs::FileSystem& fs, std::string_view prelude_path,
 
     // Semantically analyze the parsed program.
     ErrorOr<AST> analyze_result =
-        AnalyzeProgram(&arena, *parse_result, trace_stream, print_stream);
+        AnalyzeProgram(&arena, *parse_result, trace_stream, print_stream,
+                       type_check_threads);
     auto print_analyze_time =
         PrintTimingOnExit(trace_stream, "AnalyzeProgram", &cursor);
     if (!analyze_result.ok()) {
@@ -66,8 +69,8 @@ auto ParseAndExecute(llvm::vfs::FileSystem& fs, std::string_view prelude_path,
     }
 
     // Run the program.
-    ErrorOr<int> exec_result =
-        ExecProgram(&arena, *analyze_result, trace_stream, print_stream);
+    ErrorOr<int> exec_result = ExecProgram(&arena, *analyze_result,
+                                           trace_stream, print_stream, profiler);
     auto print_exec_time =
         PrintTimingOnExit(trace_stream, "ExecProgram", &cursor);
 
@@ -7,15 +7,20 @@
 
 #include "common/error.h"
 #include "explorer/base/trace_stream.h"
+#include "explorer/interpreter/profiler.h"
 #include "llvm/Support/VirtualFileSystem.h"
 
 namespace Carbon {
 
 // Parses and executes the input file, returning the program result on success.
+// If `profiler` is provided, it records a profile of the execution. Function
+// bodies are type-checked on `type_check_threads` threads.
 auto ParseAndExecute(llvm::vfs::FileSystem& fs, std::string_view prelude_path,
                      std::string_view input_file_name, bool parser_debug,
                      Nonnull<TraceStream*> trace_stream,
-                     Nonnull<llvm::raw_ostream*> print_stream) -> ErrorOr<int>;
+                     Nonnull<llvm::raw_ostream*> print_stream,
+                     std::optional<Nonnull<Profiler*>> profiler = std::nullopt,
+                     int type_check_threads = 1) -> ErrorOr<int>;
 
 }  // namespace Carbon
 
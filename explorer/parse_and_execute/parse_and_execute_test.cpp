@@ -7,6 +7,11 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <ctime>
+#include <string>
+
+#include "common/check.h"
+
 namespace Carbon {
 namespace {
 
@@ -52,5 +57,71 @@ TEST(ParseAndExecuteTest, Recursion) {
                            "interpreter actions on stack"));
 }
 
+TEST(ParseAndExecuteTest, ReusesPrelude) {
+  llvm::vfs::InMemoryFileSystem fs;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> prelude =
+      llvm::MemoryBuffer::getFile("explorer/data/prelude.carbon");
+  ASSERT_FALSE(prelude.getError()) << prelude.getError().message();
+  ASSERT_TRUE(fs.addFile("prelude.carbon", /*ModificationTime=*/0,
+                         std::move(*prelude)));
+  ASSERT_TRUE(fs.addFile("test.carbon", /*ModificationTime=*/0,
+                         llvm::MemoryBuffer::getMemBuffer(R"(
+    package Test api;
+    fn Main() -> i32 {
+      var a: i32 = 1;
+      return a + 2;
+    }
+  )")));
+
+  // Each run analyzes its own copy of the prelude, so the second run must not
+  // see the first run's analysis.
+  for (int i = 0; i < 2; ++i) {
+    TraceStream trace_stream;
+    auto result =
+        ParseAndExecute(fs, "prelude.carbon", "test.carbon",
+                        /*parser_debug=*/false, &trace_stream, &llvm::nulls());
+    ASSERT_TRUE(result.ok()) << result.error();
+    EXPECT_EQ(*result, 3);
+  }
+}
+
+TEST(ParseAndExecuteTest, ReparsesChangedPrelude) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> prelude =
+      llvm::MemoryBuffer::getFile("explorer/data/prelude.carbon");
+  ASSERT_FALSE(prelude.getError()) << prelude.getError().message();
+  std::string contents = (*prelude)->getBuffer().str();
+
+  // Runs `main` against a prelude with the given contents and modification
+  // time.
+  auto run = [&](std::string prelude_contents, time_t modification_time,
+                 llvm::StringRef main) -> ErrorOr<int> {
+    llvm::vfs::InMemoryFileSystem fs;
+    CARBON_CHECK(fs.addFile(
+        "changed_prelude.carbon", modification_time,
+        llvm::MemoryBuffer::getMemBufferCopy(prelude_contents)));
+    CARBON_CHECK(fs.addFile("test.carbon", /*ModificationTime=*/0,
+                            llvm::MemoryBuffer::getMemBuffer(main)));
+    TraceStream trace_stream;
+    return ParseAndExecute(fs, "changed_prelude.carbon", "test.carbon",
+                           /*parser_debug=*/false, &trace_stream,
+                           &llvm::nulls());
+  };
+
+  auto result = run(contents, 0, R"(
+    package Test api;
+    fn Main() -> i32 { return 1; }
+  )");
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ(*result, 1);
+
+  // A prelude with a new size and modification time is parsed again.
+  result = run(contents + "fn AddedToPrelude() -> i32 { return 2; }\n", 1, R"(
+    package Test api;
+    fn Main() -> i32 { return AddedToPrelude(); }
+  )");
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ(*result, 2);
+}
+
 }  // namespace
 }  // namespace Carbon
@@ -4,28 +4,85 @@
 
 #include "explorer/syntax/prelude.h"
 
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "common/check.h"
+#include "explorer/ast/clone_context.h"
 #include "explorer/syntax/parse.h"
+#include "llvm/Support/Chrono.h"
 
 namespace Carbon {
 
-// Adds the Carbon prelude to `declarations`.
-void AddPrelude(llvm::vfs::FileSystem& fs, std::string_view prelude_file_name,
-                Nonnull<Arena*> arena,
-                std::vector<Nonnull<Declaration*>>* declarations,
-                int* num_prelude_declarations) {
-  ErrorOr<AST> parse_result =
-      Parse(fs, arena, prelude_file_name, FileKind::Prelude, false);
+auto PreludeSnapshot::Get(llvm::vfs::FileSystem& fs,
+                          std::string_view prelude_file_name)
+    -> Nonnull<const PreludeSnapshot*> {
+  // Only the file's status is needed to find a cached snapshot.
+  llvm::ErrorOr<llvm::vfs::Status> status = fs.status(prelude_file_name);
+  CARBON_CHECK(!status.getError())
+      << "Failed to read prelude " << prelude_file_name << ": "
+      << status.getError().message();
+
+  // Snapshots are never freed, so that their source locations stay valid in
+  // the programs they're added to. That includes snapshots of earlier versions
+  // of the file.
+  static std::mutex mutex;
+  static std::map<std::tuple<std::string, uint64_t, llvm::sys::TimePoint<>>,
+                  std::unique_ptr<PreludeSnapshot>>
+      snapshots;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& snapshot =
+      snapshots[{std::string(prelude_file_name), status->getSize(),
+                 status->getLastModificationTime()}];
+  if (!snapshot) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+        fs.getBufferForFile(prelude_file_name, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
+    CARBON_CHECK(!buffer.getError())
+        << "Failed to read prelude " << prelude_file_name << ": "
+        << buffer.getError().message();
+    snapshot.reset(
+        new PreludeSnapshot(prelude_file_name, (*buffer)->getBuffer()));
+  }
+  return snapshot.get();
+}
+
+PreludeSnapshot::PreludeSnapshot(std::string_view prelude_file_name,
+                                 std::string_view contents) {
+  ErrorOr<AST> parse_result = ParseFromString(
+      &arena_, prelude_file_name, FileKind::Prelude, contents, false);
   if (!parse_result.ok()) {
     // Try again with tracing, to help diagnose the problem.
-    ErrorOr<AST> trace_parse_result =
-        Parse(fs, arena, prelude_file_name, FileKind::Prelude, true);
+    ErrorOr<AST> trace_parse_result = ParseFromString(
+        &arena_, prelude_file_name, FileKind::Prelude, contents, true);
     CARBON_FATAL() << "Failed to parse prelude:\n"
                    << trace_parse_result.error();
   }
-  const auto& prelude = *parse_result;
-  declarations->insert(declarations->begin(), prelude.declarations.begin(),
-                       prelude.declarations.end());
-  *num_prelude_declarations = prelude.declarations.size();
+  declarations_ = std::move(parse_result->declarations);
+}
+
+void PreludeSnapshot::AddTo(Nonnull<Arena*> arena,
+                            std::vector<Nonnull<Declaration*>>* declarations,
+                            int* num_prelude_declarations) const {
+  // Cloning is much cheaper than lexing and parsing the prelude again.
+  CloneContext context(arena);
+  std::vector<Nonnull<Declaration*>> prelude = context.Clone(declarations_);
+  declarations->insert(declarations->begin(), prelude.begin(), prelude.end());
+  *num_prelude_declarations = prelude.size();
+}
+
+// Adds the Carbon prelude to `declarations`.
+void AddPrelude(llvm::vfs::FileSystem& fs, std::string_view prelude_file_name,
+                Nonnull<Arena*> arena,
+                std::vector<Nonnull<Declaration*>>* declarations,
+                int* num_prelude_declarations) {
+  PreludeSnapshot::Get(fs, prelude_file_name)
+      ->AddTo(arena, declarations, num_prelude_declarations);
 }
 
 }  // namespace Carbon
@@ -6,6 +6,7 @@
 #define CARBON_EXPLORER_SYNTAX_PRELUDE_H_
 
 #include <string_view>
+#include <vector>
 
 #include "explorer/ast/declaration.h"
 #include "explorer/base/arena.h"
@@ -14,6 +15,42 @@
 
 namespace Carbon {
 
+// The parsed Carbon prelude, which can be added to any number of programs
+// without parsing it again.
+//
+// Analysis modifies the AST, so each program gets its own copy of the
+// declarations rather than sharing them. A snapshot itself is never modified
+// once created, so it can be used from multiple threads.
+class PreludeSnapshot {
+ public:
+  // Returns the snapshot of the prelude in `prelude_file_name`. Snapshots are
+  // cached for the life of the process by file name, size and modification
+  // time, so the prelude is read and parsed once no matter how many programs
+  // use it. A change to the file which keeps both its size and modification
+  // time isn't noticed. This is thread-safe.
+  static auto Get(llvm::vfs::FileSystem& fs,
+                  std::string_view prelude_file_name)
+      -> Nonnull<const PreludeSnapshot*>;
+
+  PreludeSnapshot(const PreludeSnapshot&) = delete;
+  auto operator=(const PreludeSnapshot&) -> PreludeSnapshot& = delete;
+
+  // Adds a copy of the prelude, allocated in `arena`, to `declarations`.
+  void AddTo(Nonnull<Arena*> arena,
+             std::vector<Nonnull<Declaration*>>* declarations,
+             int* num_prelude_declarations) const;
+
+ private:
+  // Parses the prelude from `contents`.
+  PreludeSnapshot(std::string_view prelude_file_name,
+                  std::string_view contents);
+
+  // Owns the parsed declarations, including their source locations' file
+  // name.
+  Arena arena_;
+  std::vector<Nonnull<Declaration*>> declarations_;
+};
+
 // Adds the Carbon prelude to `declarations`.
 void AddPrelude(llvm::vfs::FileSystem& fs, std::string_view prelude_file_name,
                 Nonnull<Arena*> arena,
@@ -0,0 +1,113 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Prints a binary trace log written by `explorer --trace_format=binary` in the
+// text trace format:
+// `trace_decoder [--trace_phase=...] [--trace_file_context=...] <log file>`
+
+#include <bitset>
+#include <cstdlib>
+
+#include "common/bazel_working_dir.h"
+#include "common/error.h"
+#include "explorer/base/source_location.h"
+#include "explorer/base/trace_log.h"
+#include "explorer/base/trace_stream.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Carbon {
+
+namespace cl = llvm::cl;
+
+static auto Main(int argc, char** argv) -> ErrorOr<Success> {
+  SetWorkingDirForBazel();
+  llvm::InitLLVM init_llvm(argc, argv);
+
+  cl::opt<std::string> input_file_name(cl::Positional, cl::desc("<log file>"),
+                                       cl::Required);
+  cl::list<ProgramPhase> trace_phases(
+      "trace_phase",
+      cl::desc("Select the program phases to print. By default, all phases in "
+               "the log are printed."),
+      cl::values(
+          clEnumValN(ProgramPhase::SourceProgram, "source_program",
+                     "Source Program phase."),
+          clEnumValN(ProgramPhase::NameResolution, "name_resolution",
+                     "Name Resolution phase."),
+          clEnumValN(ProgramPhase::ControlFlowResolution,
+                     "control_flow_resolution",
+                     "Control Flow Resolution phase."),
+          clEnumValN(ProgramPhase::TypeChecking, "type_checking",
+                     "Type Checking phase."),
+          clEnumValN(ProgramPhase::UnformedVariableResolution,
+                     "unformed_variables_resolution",
+                     "Unformed Variables Resolution phase."),
+          clEnumValN(ProgramPhase::Declarations, "declarations",
+                     "Printing Declarations."),
+          clEnumValN(ProgramPhase::Execution, "execution",
+                     "Program Execution."),
+          clEnumValN(ProgramPhase::Timing, "timing", "Timing logs."),
+          clEnumValN(ProgramPhase::All, "all", "All phases.")),
+      cl::CommaSeparated);
+  cl::list<FileKind> trace_file_kinds(
+      "trace_file_context",
+      cl::desc("Select the file contexts to print. By default, all file "
+               "contexts in the log are printed."),
+      cl::values(clEnumValN(FileKind::Main, "main",
+                            "The file containing the main function."),
+                 clEnumValN(FileKind::Prelude, "prelude", "The prelude."),
+                 clEnumValN(FileKind::Import, "import", "Imports.")),
+      cl::CommaSeparated);
+  cl::ParseCommandLineOptions(argc, argv);
+
+  std::bitset<static_cast<int>(ProgramPhase::Last) + 1> allowed_phases;
+  if (trace_phases.empty()) {
+    allowed_phases.set();
+  }
+  for (ProgramPhase phase : trace_phases) {
+    if (phase == ProgramPhase::All) {
+      allowed_phases.set();
+    } else {
+      allowed_phases.set(static_cast<int>(phase));
+    }
+  }
+  // Output outside any particular file is always printed, as in the explorer.
+  std::bitset<static_cast<int>(FileKind::Last) + 1> allowed_file_kinds;
+  if (trace_file_kinds.empty()) {
+    allowed_file_kinds.set();
+  }
+  allowed_file_kinds.set(static_cast<int>(FileKind::Unknown));
+  for (FileKind kind : trace_file_kinds) {
+    allowed_file_kinds.set(static_cast<int>(kind));
+  }
+
+  auto log = llvm::MemoryBuffer::getFileOrSTDIN(input_file_name);
+  if (log.getError()) {
+    return ErrorBuilder() << "Error reading " << input_file_name << ": "
+                          << log.getError().message();
+  }
+  return DecodeTraceLog(
+      (*log)->getBuffer(),
+      [&](ProgramPhase phase, FileKind file_kind) {
+        auto phase_index = static_cast<size_t>(phase);
+        return phase_index < allowed_phases.size() &&
+               allowed_phases[phase_index] &&
+               allowed_file_kinds[static_cast<int>(file_kind)];
+      },
+      llvm::outs());
+}
+
+}  // namespace Carbon
+
+auto main(int argc, char** argv) -> int {
+  auto result = Carbon::Main(argc, argv);
+  if (!result.ok()) {
+    llvm::errs() << result.error() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
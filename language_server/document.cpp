@@ -0,0 +1,159 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "language_server/document.h"
+
+#include <algorithm>
+
+#include "common/check.h"
+#include "llvm/ADT/STLExtras.h"
+#include "toolchain/check/check.h"
+#include "toolchain/diagnostics/null_diagnostics.h"
+
+namespace Carbon::LS {
+
+namespace {
+// Records diagnostics for a document, converting locations to 0-based
+// positions. Notes are recorded as separate diagnostics following the one they
+// belong to.
+class DocumentDiagnosticConsumer : public DiagnosticConsumer {
+ public:
+  explicit DocumentDiagnosticConsumer(
+      std::vector<Document::Diagnostic>* diagnostics)
+      : diagnostics_(diagnostics) {}
+
+  auto HandleDiagnostic(Diagnostic diagnostic) -> void override {
+    Add(diagnostic.level, diagnostic.message);
+    for (const auto& note : diagnostic.notes) {
+      Add(DiagnosticLevel::Note, note);
+    }
+  }
+
+ private:
+  auto Add(DiagnosticLevel level, const DiagnosticMessage& message) -> void {
+    // Locations without a line, such as file-level errors, go at the start of
+    // the document.
+    diagnostics_->push_back(
+        {.level = level,
+         .line = std::max(message.location.line_number - 1, 0),
+         .column = std::max(message.location.column_number - 1, 0),
+         .message = message.format_fn(message)});
+  }
+
+  std::vector<Document::Diagnostic>* diagnostics_;
+};
+}  // namespace
+
+auto Document::SetText(std::string text) -> void {
+  text_ = std::move(text);
+  parse_node_sem_ir_nodes_.clear();
+  diagnostics_.clear();
+  sem_ir_.reset();
+  parse_tree_index_.reset();
+  parse_tree_.reset();
+  tokens_.reset();
+  source_.reset();
+}
+
+auto Document::tokens() -> const Lex::TokenizedBuffer& {
+  Build();
+  return *tokens_;
+}
+
+auto Document::parse_tree() -> const Parse::Tree& {
+  Build();
+  return *parse_tree_;
+}
+
+auto Document::parse_tree_index() -> const Parse::TreeIndex& {
+  if (!parse_tree_index_) {
+    parse_tree_index_.emplace(parse_tree());
+  }
+  return *parse_tree_index_;
+}
+
+auto Document::sem_ir() -> const SemIR::File& {
+  BuildSemIR();
+  return *sem_ir_;
+}
+
+auto Document::diagnostics() -> llvm::ArrayRef<Diagnostic> {
+  BuildSemIR();
+  return diagnostics_;
+}
+
+auto Document::GetParseNodeAt(int line, int column) -> Parse::Node {
+  const auto& index = parse_tree_index();
+  // Find the last token starting at or before the position. Tokens are in
+  // source order, so this can use a binary search.
+  auto before_position = [&](Lex::Token token) {
+    int token_line = tokens_->GetLineNumber(token) - 1;
+    return token_line < line ||
+           (token_line == line &&
+            tokens_->GetColumnNumber(token) - 1 <= column);
+  };
+  auto it = llvm::partition_point(tokens_->tokens(), before_position);
+  if (it == tokens_->tokens().begin()) {
+    return Parse::Node::Invalid;
+  }
+  Lex::Token token = *--it;
+  if (tokens_->GetLineNumber(token) - 1 != line ||
+      column >= tokens_->GetColumnNumber(token) - 1 +
+                    static_cast<int>(tokens_->GetTokenText(token).size())) {
+    return Parse::Node::Invalid;
+  }
+  return index.GetNodeForToken(token);
+}
+
+auto Document::GetSemIRNode(Parse::Node parse_node) -> SemIR::NodeId {
+  BuildSemIR();
+  if (!parse_node.is_valid()) {
+    return SemIR::NodeId::Invalid;
+  }
+  return parse_node_sem_ir_nodes_[parse_node.index];
+}
+
+auto Document::Build() -> void {
+  if (parse_tree_) {
+    return;
+  }
+
+  DocumentDiagnosticConsumer consumer(&diagnostics_);
+  source_ = SourceBuffer::CreateFromText(text_, filename_,
+                                         NullDiagnosticConsumer());
+  // This only fails for text over the 2GiB input limit.
+  CARBON_CHECK(source_) << "Unable to create source for " << filename_;
+  tokens_ = Lex::TokenizedBuffer::Lex(*source_, consumer);
+  parse_tree_ = Parse::Tree::Parse(*tokens_, consumer,
+                                   /*vlog_stream=*/nullptr);
+}
+
+auto Document::BuildSemIR() -> void {
+  if (sem_ir_) {
+    return;
+  }
+
+  Build();
+  DocumentDiagnosticConsumer consumer(&diagnostics_);
+  sem_ir_ = Check::CheckParseTree(*builtins_, *tokens_, *parse_tree_, consumer,
+                                  /*vlog_stream=*/nullptr);
+
+  // Several nodes can share a parse node, such as a name reference and the
+  // conversions applied to it. The first is the one the source refers to.
+  parse_node_sem_ir_nodes_.assign(parse_tree_->size(), SemIR::NodeId::Invalid);
+  for (int i = 0; i < sem_ir_->nodes_size(); ++i) {
+    SemIR::NodeId node_id(i);
+    auto node = sem_ir_->GetNode(node_id);
+    if (!node.parse_node().is_valid() ||
+        node.kind().value_kind() != SemIR::NodeValueKind::Typed) {
+      continue;
+    }
+    auto& entry = parse_node_sem_ir_nodes_[node.parse_node().index];
+    if (!entry.is_valid()) {
+      entry = node_id;
+    }
+  }
+}
+
+}  // namespace Carbon::LS
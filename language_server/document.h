@@ -0,0 +1,108 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_LANGUAGE_SERVER_DOCUMENT_H_
+#define CARBON_LANGUAGE_SERVER_DOCUMENT_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "toolchain/diagnostics/diagnostic_emitter.h"
+#include "toolchain/lex/tokenized_buffer.h"
+#include "toolchain/parse/tree.h"
+#include "toolchain/parse/tree_index.h"
+#include "toolchain/sem_ir/file.h"
+#include "toolchain/source/source_buffer.h"
+
+namespace Carbon::LS {
+
+// A document managed by the language client.
+//
+// Holds the current text of the document as edited in the client, along with
+// analysis of that text. Analysis is built lazily when first queried after
+// the text changes, so a burst of edits between queries is only analyzed once,
+// and repeated queries without edits reuse the same results.
+//
+// The analysis refers into this object, so it can't be copied or moved.
+class Document {
+ public:
+  // A diagnostic produced while analyzing the document. Positions are 0-based,
+  // as in the language server protocol.
+  struct Diagnostic {
+    DiagnosticLevel level;
+    int line;
+    int column;
+    std::string message;
+  };
+
+  // `builtins` is shared by all documents, and must outlive this one.
+  explicit Document(const SemIR::File& builtins, llvm::StringRef filename,
+                    std::string text)
+      : builtins_(&builtins),
+        filename_(filename.str()),
+        text_(std::move(text)) {}
+
+  Document(const Document&) = delete;
+  auto operator=(const Document&) -> Document& = delete;
+
+  // Replaces the text of the document, discarding any analysis.
+  auto SetText(std::string text) -> void;
+
+  // Returns the tokens for the current text, lexing it if needed.
+  auto tokens() -> const Lex::TokenizedBuffer&;
+
+  // Returns the parse tree for the current text, parsing it if needed.
+  auto parse_tree() -> const Parse::Tree&;
+
+  // Returns the index of the parse tree, building it if needed.
+  auto parse_tree_index() -> const Parse::TreeIndex&;
+
+  // Returns the checked SemIR for the current text, checking it if needed.
+  auto sem_ir() -> const SemIR::File&;
+
+  // Returns the diagnostics from lexing, parsing and checking the current text.
+  auto diagnostics() -> llvm::ArrayRef<Diagnostic>;
+
+  // Returns the parse node for the token at the given 0-based position, or
+  // `Parse::Node::Invalid` if there's no token there.
+  auto GetParseNodeAt(int line, int column) -> Parse::Node;
+
+  // Returns the first typed SemIR node created for the given parse node, or
+  // `SemIR::NodeId::Invalid` if there is none.
+  auto GetSemIRNode(Parse::Node parse_node) -> SemIR::NodeId;
+
+  auto filename() const -> llvm::StringRef { return filename_; }
+  auto text() const -> llvm::StringRef { return text_; }
+
+ private:
+  // Builds the source buffer, tokens and parse tree if they aren't built.
+  auto Build() -> void;
+
+  // Builds the SemIR and the position indices if they aren't built.
+  auto BuildSemIR() -> void;
+
+  const SemIR::File* builtins_;
+  std::string filename_;
+  std::string text_;
+
+  // Analysis of `text_`, set by `Build` and cleared by `SetText`. These are
+  // declared in dependency order so that they're destroyed in reverse.
+  std::optional<SourceBuffer> source_;
+  std::optional<Lex::TokenizedBuffer> tokens_;
+  std::optional<Parse::Tree> parse_tree_;
+  // Set by `parse_tree_index`, because only some queries need it.
+  std::optional<Parse::TreeIndex> parse_tree_index_;
+  std::optional<SemIR::File> sem_ir_;
+  std::vector<Diagnostic> diagnostics_;
+
+  // The first typed SemIR node for each parse node, set by `BuildSemIR`.
+  std::vector<SemIR::NodeId> parse_node_sem_ir_nodes_;
+};
+
+}  // namespace Carbon::LS
+
+#endif  // CARBON_LANGUAGE_SERVER_DOCUMENT_H_
@@ -4,18 +4,64 @@
 
 #include "language_server/language_server.h"
 
+#include <algorithm>
+
 #include "clang-tools-extra/clangd/Protocol.h"
-#include "toolchain/diagnostics/null_diagnostics.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "toolchain/lex/tokenized_buffer.h"
 #include "toolchain/parse/node_kind.h"
 #include "toolchain/parse/tree.h"
-#include "toolchain/source/source_buffer.h"
+#include "toolchain/sem_ir/node.h"
 
 namespace Carbon::LS {
 
+// The number of results for `workspace/symbol` when the client doesn't limit
+// them.
+static constexpr int DefaultSymbolLimit = 100;
+
+LanguageServer::LanguageServer(
+    std::unique_ptr<clang::clangd::Transport> transport,
+    std::chrono::milliseconds diagnostics_delay)
+    : transport_(std::move(transport)),
+      diagnostics_delay_(diagnostics_delay),
+      diagnostics_thread_([this] { RunDiagnostics(); }) {
+  clang::clangd::LSPBinder binder(handlers_, *this);
+  binder.notification("textDocument/didOpen", this,
+                      &LanguageServer::OnDidOpenTextDocument);
+  binder.notification("textDocument/didChange", this,
+                      &LanguageServer::OnDidChangeTextDocument);
+  binder.notification("textDocument/didSave", this,
+                      &LanguageServer::OnDidSaveTextDocument);
+  binder.notification("textDocument/didClose", this,
+                      &LanguageServer::OnDidCloseTextDocument);
+  binder.method("initialize", this, &LanguageServer::OnInitialize);
+  binder.method("textDocument/documentSymbol", this,
+                &LanguageServer::OnDocumentSymbol);
+  binder.method("workspace/symbol", this, &LanguageServer::OnWorkspaceSymbol);
+  binder.method("textDocument/hover", this, &LanguageServer::OnHover);
+  binder.method("textDocument/definition", this,
+                &LanguageServer::OnDefinition);
+}
+
+LanguageServer::~LanguageServer() {
+  {
+    std::lock_guard<std::mutex> lock(diagnostics_mutex_);
+    stopping_ = true;
+  }
+  diagnostics_changed_.notify_one();
+  diagnostics_thread_.join();
+}
+
 void LanguageServer::OnDidOpenTextDocument(
     clang::clangd::DidOpenTextDocumentParams const& params) {
-  files_.emplace(params.textDocument.uri.file(), params.textDocument.text);
+  std::string file = params.textDocument.uri.file().str();
+  auto [it, inserted] =
+      files_.try_emplace(file, builtins_, file, params.textDocument.text);
+  if (!inserted) {
+    it->second.SetText(params.textDocument.text);
+  }
+  ScheduleDiagnostics(params.textDocument.uri, params.textDocument.text);
+  unindexed_files_.insert(file);
 }
 
 void LanguageServer::OnDidChangeTextDocument(
@@ -23,14 +69,135 @@ void LanguageServer::OnDidChangeTextDocument(
   // full text is sent if full sync is specified in capabilities.
   assert(params.contentChanges.size() == 1);
   std::string file = params.textDocument.uri.file().str();
-  files_[file] = params.contentChanges[0].text;
+  // Only this document is reanalyzed; others keep their cached SemIR. Its
+  // analysis is rebuilt when it's next queried.
+  auto& document = files_.at(file);
+  document.SetText(params.contentChanges[0].text);
+  ScheduleDiagnostics(params.textDocument.uri, params.contentChanges[0].text);
+  unindexed_files_.insert(file);
+}
+
+void LanguageServer::OnDidSaveTextDocument(
+    clang::clangd::DidSaveTextDocumentParams const& params) {
+  std::string file = params.textDocument.uri.file().str();
+  if (unindexed_files_.erase(file)) {
+    IndexDocument(file, files_.at(file));
+  }
+}
+
+void LanguageServer::OnDidCloseTextDocument(
+    clang::clangd::DidCloseTextDocumentParams const& params) {
+  std::string file = params.textDocument.uri.file().str();
+  files_.erase(file);
+  unindexed_files_.erase(file);
+  // The client may have discarded unsaved edits, so go back to the disk.
+  index_.CloseFile(file, index_pool_);
+  // Drop pending diagnostics, including any being computed, and clear the
+  // closed document's diagnostics in the client.
+  {
+    std::lock_guard<std::mutex> lock(diagnostics_mutex_);
+    pending_diagnostics_.erase(file);
+    ++diagnostics_generations_[file];
+  }
+  notify("textDocument/publishDiagnostics",
+         clang::clangd::PublishDiagnosticsParams{
+             .uri = params.textDocument.uri, .diagnostics = {}});
+}
+
+void LanguageServer::ScheduleDiagnostics(const clang::clangd::URIForFile& uri,
+                                         std::string text) {
+  std::string file = uri.file().str();
+  {
+    std::lock_guard<std::mutex> lock(diagnostics_mutex_);
+    pending_diagnostics_[file] = {
+        .uri = uri,
+        .text = std::move(text),
+        .generation = ++diagnostics_generations_[file],
+        .deadline = std::chrono::steady_clock::now() + diagnostics_delay_};
+  }
+  diagnostics_changed_.notify_one();
+}
+
+void LanguageServer::RunDiagnostics() {
+  std::unique_lock<std::mutex> lock(diagnostics_mutex_);
+  while (!stopping_) {
+    if (pending_diagnostics_.empty()) {
+      diagnostics_changed_.wait(lock);
+      continue;
+    }
+    auto next = std::min_element(
+        pending_diagnostics_.begin(), pending_diagnostics_.end(),
+        [](const auto& lhs, const auto& rhs) {
+          return lhs.second.deadline < rhs.second.deadline;
+        });
+    if (std::chrono::steady_clock::now() < next->second.deadline) {
+      diagnostics_changed_.wait_until(lock, next->second.deadline);
+      continue;
+    }
+    std::string file = next->first().str();
+    PendingDiagnostics pending = std::move(next->second);
+    pending_diagnostics_.erase(next);
+
+    // Check a separate copy of the document, so that the client's requests
+    // aren't blocked meanwhile.
+    lock.unlock();
+    Document document(builtins_, file, std::move(pending.text));
+    auto params = MakeDiagnostics(pending.uri, document);
+    lock.lock();
+
+    // Publishing while holding the lock ensures that diagnostics for an older
+    // version of the document can't be published after a newer one changes it.
+    if (diagnostics_generations_[file] == pending.generation) {
+      notify("textDocument/publishDiagnostics", params);
+    }
+  }
+}
+
+auto LanguageServer::MakeDiagnostics(const clang::clangd::URIForFile& uri,
+                                     Document& document)
+    -> clang::clangd::PublishDiagnosticsParams {
+  clang::clangd::PublishDiagnosticsParams params{.uri = uri};
+  for (const auto& diagnostic : document.diagnostics()) {
+    clang::clangd::Position pos{diagnostic.line, diagnostic.column};
+    int severity;
+    switch (diagnostic.level) {
+      case DiagnosticLevel::Error:
+        severity = 1;
+        break;
+      case DiagnosticLevel::Warning:
+        severity = 2;
+        break;
+      case DiagnosticLevel::Note:
+        severity = 3;
+        break;
+    }
+    params.diagnostics.push_back({.range = {.start = pos, .end = pos},
+                                  .severity = severity,
+                                  .source = "carbon",
+                                  .message = diagnostic.message});
+  }
+  return params;
 }
 
 void LanguageServer::OnInitialize(
-    clang::clangd::NoParams const& client_capabilities,
+    clang::clangd::InitializeParams const& params,
     clang::clangd::Callback<llvm::json::Object> cb) {
-  llvm::json::Object capabilities{{"documentSymbolProvider", true},
-                                  {"textDocumentSync", /*Full=*/1}};
+  if (params.rootUri) {
+    std::string root = params.rootUri->file().str();
+    index_path_ = root + "/.cache/carbon/symbols.idx";
+    // A missing or outdated index just means indexing everything.
+    index_.Load(index_path_);
+    index_.IndexWorkspace(root, index_pool_);
+  }
+
+  llvm::json::Object capabilities{{"definitionProvider", true},
+                                  {"documentSymbolProvider", true},
+                                  {"hoverProvider", true},
+                                  {"textDocumentSync",
+                                   llvm::json::Object{{"openClose", true},
+                                                      {"change", /*Full=*/1},
+                                                      {"save", true}}},
+                                  {"workspaceSymbolProvider", true}};
 
   llvm::json::Object reply{{"capabilities", std::move(capabilities)}};
   cb(reply);
@@ -58,9 +225,11 @@ auto LanguageServer::onCall(llvm::StringRef method, llvm::json::Value params,
     // TODO: improve this if add threads
     handler->second(std::move(params),
                     [&](llvm::Expected<llvm::json::Value> reply) {
+                      std::lock_guard<std::mutex> lock(output_mutex_);
                       transport_->reply(id, std::move(reply));
                     });
   } else {
+    std::lock_guard<std::mutex> lock(output_mutex_);
     transport_->reply(
         id, llvm::make_error<clang::clangd::LSPError>(
                 "method not found", clang::clangd::ErrorCode::MethodNotFound));
@@ -75,81 +244,133 @@ auto LanguageServer::onReply(llvm::json::Value /*id*/,
   return true;
 }
 
-// Returns the text of first child of kind Parse::NodeKind::Name.
-static auto getName(Parse::Tree& p, Parse::Node node)
-    -> std::optional<llvm::StringRef> {
-  for (auto ch : p.children(node)) {
-    if (p.node_kind(ch) == Parse::NodeKind::Name) {
-      return p.GetNodeText(ch);
-    }
-  }
-  return std::nullopt;
-}
-
 void LanguageServer::OnDocumentSymbol(
     clang::clangd::DocumentSymbolParams const& params,
     clang::clangd::Callback<std::vector<clang::clangd::DocumentSymbol>> cb) {
-  llvm::vfs::InMemoryFileSystem vfs;
-  auto file = params.textDocument.uri.file().str();
-  vfs.addFile(file, /*mtime=*/0,
-              llvm::MemoryBuffer::getMemBufferCopy(files_.at(file)));
-
-  auto buf = SourceBuffer::CreateFromFile(vfs, file, NullDiagnosticConsumer());
-  auto lexed = Lex::TokenizedBuffer::Lex(*buf, NullDiagnosticConsumer());
-  auto parsed = Parse::Tree::Parse(lexed, NullDiagnosticConsumer(), nullptr);
+  auto& document = files_.at(params.textDocument.uri.file().str());
   std::vector<clang::clangd::DocumentSymbol> result;
-  for (const auto& node : parsed.postorder()) {
-    clang::clangd::SymbolKind symbol_kind;
-    switch (parsed.node_kind(node)) {
-      case Parse::NodeKind::FunctionDeclaration:
-      case Parse::NodeKind::FunctionDefinitionStart:
-        symbol_kind = clang::clangd::SymbolKind::Function;
-        break;
-      case Parse::NodeKind::Namespace:
-        symbol_kind = clang::clangd::SymbolKind::Namespace;
-        break;
-      case Parse::NodeKind::InterfaceDefinitionStart:
-      case Parse::NodeKind::NamedConstraintDefinitionStart:
-        symbol_kind = clang::clangd::SymbolKind::Interface;
-        break;
-      case Parse::NodeKind::ClassDefinitionStart:
-        symbol_kind = clang::clangd::SymbolKind::Class;
-        break;
-      default:
-        continue;
-    }
+  for (auto& symbol : SymbolIndex::CollectSymbols(document.tokens(),
+                                                  document.parse_tree())) {
+    clang::clangd::Position pos{symbol.line, symbol.column};
+    result.push_back({
+        .name = std::move(symbol.name),
+        .kind = symbol.kind,
+        .range = {.start = pos, .end = pos},
+        .selectionRange = {.start = pos, .end = pos},
+    });
+  }
+  cb(result);
+}
 
-    if (auto name = getName(parsed, node)) {
-      auto tok = parsed.node_token(node);
-      clang::clangd::Position pos{lexed.GetLineNumber(tok) - 1,
-                                  lexed.GetColumnNumber(tok) - 1};
+void LanguageServer::OnWorkspaceSymbol(
+    clang::clangd::WorkspaceSymbolParams const& params,
+    clang::clangd::Callback<std::vector<clang::clangd::SymbolInformation>>
+        cb) {
+  for (const auto& file : unindexed_files_) {
+    IndexDocument(file.first(), files_.at(file.first().str()));
+  }
+  unindexed_files_.clear();
+  cb(index_.Query(params.query, params.limit.value_or(DefaultSymbolLimit)));
+}
 
-      clang::clangd::DocumentSymbol symbol{
-          .name = std::string(*name),
-          .kind = symbol_kind,
-          .range = {.start = pos, .end = pos},
-          .selectionRange = {.start = pos, .end = pos},
-      };
+void LanguageServer::IndexDocument(llvm::StringRef file, Document& document) {
+  index_.UpdateFile(file, SymbolIndex::EditorModificationTime,
+                    SymbolIndex::CollectSymbols(document.tokens(),
+                                                document.parse_tree()));
+}
 
-      result.push_back(symbol);
+// Returns the position of the token for the given parse node.
+static auto GetPosition(const Lex::TokenizedBuffer& tokens,
+                        const Parse::Tree& parse_tree, Parse::Node node)
+    -> clang::clangd::Position {
+  auto tok = parse_tree.node_token(node);
+  return {tokens.GetLineNumber(tok) - 1, tokens.GetColumnNumber(tok) - 1};
+}
+
+void LanguageServer::OnHover(
+    clang::clangd::TextDocumentPositionParams const& params,
+    clang::clangd::Callback<std::optional<clang::clangd::Hover>> cb) {
+  auto& document = files_.at(params.textDocument.uri.file().str());
+  auto parse_node = document.GetParseNodeAt(params.position.line,
+                                            params.position.character);
+  auto node_id = document.GetSemIRNode(parse_node);
+  if (!node_id.is_valid()) {
+    cb(std::nullopt);
+    return;
+  }
+  const auto& sem_ir = document.sem_ir();
+  auto node = sem_ir.GetNode(node_id);
+  std::string text = sem_ir.StringifyType(node.type_id());
+  if (auto name_ref = node.TryAs<SemIR::NameReference>()) {
+    text = llvm::formatv("{0}: {1}", sem_ir.GetString(name_ref->name_id), text)
+               .str();
+  }
+  const auto& lexed = document.tokens();
+  const auto& parsed = document.parse_tree();
+  auto pos = GetPosition(lexed, parsed, parse_node);
+  auto end = pos;
+  end.character +=
+      lexed.GetTokenText(parsed.node_token(parse_node)).size();
+  cb(clang::clangd::Hover{
+      .contents = {.kind = clang::clangd::MarkupKind::PlainText,
+                   .value = std::move(text)},
+      .range = clang::clangd::Range{.start = pos, .end = end}});
+}
+
+void LanguageServer::OnDefinition(
+    clang::clangd::TextDocumentPositionParams const& params,
+    clang::clangd::Callback<std::vector<clang::clangd::Location>> cb) {
+  auto& document = files_.at(params.textDocument.uri.file().str());
+  auto node_id = document.GetSemIRNode(document.GetParseNodeAt(
+      params.position.line, params.position.character));
+  if (!node_id.is_valid()) {
+    cb({});
+    return;
+  }
+  // Name lookup during checking records the resolved declaration in each name
+  // reference, so there's no need to redo it here.
+  const auto& sem_ir = document.sem_ir();
+  auto name_ref = sem_ir.GetNode(node_id).TryAs<SemIR::NameReference>();
+  if (!name_ref) {
+    cb({});
+    return;
+  }
+  // Builtins are cross-references without a parse node in this file.
+  auto decl_parse_node = sem_ir.GetNode(name_ref->value_id).parse_node();
+  if (!decl_parse_node.is_valid()) {
+    cb({});
+    return;
+  }
+  // Point at the declared name when the declaration has one, rather than at
+  // its introducer. A function's declaration is its introducer, and the name
+  // is a sibling of it.
+  const auto& index = document.parse_tree_index();
+  auto name = index.FindChild(decl_parse_node, Parse::NodeKind::Name);
+  if (!name.is_valid()) {
+    if (auto parent = index.parent(decl_parse_node); parent.is_valid()) {
+      name = index.FindChild(parent, Parse::NodeKind::Name);
     }
   }
-  cb(result);
+  if (name.is_valid()) {
+    decl_parse_node = name;
+  }
+  auto pos =
+      GetPosition(document.tokens(), document.parse_tree(), decl_parse_node);
+  cb(std::vector<clang::clangd::Location>{
+      {.uri = params.textDocument.uri, .range = {.start = pos, .end = pos}}});
 }
 
 void LanguageServer::Start() {
   auto transport =
       clang::clangd::newJSONTransport(stdin, llvm::outs(), nullptr, true);
   LanguageServer ls(std::move(transport));
-  clang::clangd::LSPBinder binder(ls.handlers_, ls);
-  binder.notification("textDocument/didOpen", &ls,
-                      &LanguageServer::OnDidOpenTextDocument);
-  binder.notification("textDocument/didChange", &ls,
-                      &LanguageServer::OnDidChangeTextDocument);
-  binder.method("initialize", &ls, &LanguageServer::OnInitialize);
-  binder.method("textDocument/documentSymbol", &ls,
-                &LanguageServer::OnDocumentSymbol);
   auto error = ls.transport_->loop(ls);
   llvm::errs() << "Error: " << error << "\n";
+  // Finish indexing so that the next session can start from it.
+  ls.index_pool_.wait();
+  if (!ls.index_path_.empty() && !ls.index_.Save(ls.index_path_)) {
+    llvm::errs() << "Error: unable to save index to " << ls.index_path_
+                 << "\n";
+  }
 }
 }  // namespace Carbon::LS
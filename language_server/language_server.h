@@ -4,6 +4,11 @@
 
 #ifndef CARBON_LANGUAGE_SERVER_LANGUAGE_SERVER_H_
 #define CARBON_LANGUAGE_SERVER_LANGUAGE_SERVER_H_
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -11,17 +16,34 @@
 #include "clang-tools-extra/clangd/Protocol.h"
 #include "clang-tools-extra/clangd/Transport.h"
 #include "clang-tools-extra/clangd/support/Function.h"
-#include "toolchain/lex/tokenized_buffer.h"
-#include "toolchain/parse/tree.h"
-#include "toolchain/source/source_buffer.h"
+#include "language_server/document.h"
+#include "language_server/symbol_index.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/ThreadPool.h"
+#include "toolchain/check/check.h"
+#include "toolchain/sem_ir/file.h"
 
 namespace Carbon::LS {
 class LanguageServer : public clang::clangd::Transport::MessageHandler,
                        public clang::clangd::LSPBinder::RawOutgoing {
  public:
+  // How long to wait after the last edit to a document before checking it and
+  // publishing its diagnostics, so that a burst of keystrokes is only checked
+  // once.
+  static constexpr std::chrono::milliseconds DefaultDiagnosticsDelay{300};
+
   // Start the language server.
   static void Start();
 
+  // Makes a server which communicates over `transport`. Messages are passed to
+  // the `Transport::MessageHandler` methods below.
+  explicit LanguageServer(
+      std::unique_ptr<clang::clangd::Transport> transport,
+      std::chrono::milliseconds diagnostics_delay = DefaultDiagnosticsDelay);
+
+  ~LanguageServer() override;
+
   // Transport::MessageHandler
   // Handlers returns true to keep processing messages, or false to shut down.
 
@@ -45,18 +67,56 @@ class LanguageServer : public clang::clangd::Transport::MessageHandler,
 
   // Send notification to client
   void notify(llvm::StringRef method, llvm::json::Value params) override {
+    std::lock_guard<std::mutex> lock(output_mutex_);
     transport_->notify(method, params);
   }
 
  private:
+  // A document whose diagnostics are waiting to be published.
+  struct PendingDiagnostics {
+    clang::clangd::URIForFile uri;
+    std::string text;
+    // The document's generation when this was scheduled. The diagnostics are
+    // dropped if the document has changed since.
+    int64_t generation;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
   const std::unique_ptr<clang::clangd::Transport> transport_;
-  // content of files managed by the language client.
-  std::unordered_map<std::string, std::string> files_;
+  // Serializes writes to `transport_`, because diagnostics are published from
+  // `diagnostics_thread_`.
+  std::mutex output_mutex_;
+  // Builtins shared by every document's SemIR.
+  const SemIR::File builtins_ = Check::MakeBuiltins();
+  // Files managed by the language client, keyed by filename. Documents can't
+  // be moved, and this relies on the node stability of `std::unordered_map`.
+  std::unordered_map<std::string, Document> files_;
+  // Declarations across the workspace, and where it's saved between sessions.
+  SymbolIndex index_;
+  std::string index_path_;
+  // Open files whose current text isn't in `index_` yet. Rather than
+  // reindexing on every edit, they're indexed when saved or when the index is
+  // queried.
+  llvm::StringSet<> unindexed_files_;
+  // Threads for indexing. Declared after `index_` so that pending tasks finish
+  // before it's destroyed.
+  llvm::ThreadPool index_pool_;
   // handlers for client methods and notifications
   clang::clangd::LSPBinder::RawHandlers handlers_;
 
-  explicit LanguageServer(std::unique_ptr<clang::clangd::Transport> transport)
-      : transport_(std::move(transport)) {}
+  // Diagnostics are computed on `diagnostics_thread_`, from a copy of the
+  // document, so that edits don't wait for checking. The members below are
+  // guarded by `diagnostics_mutex_`.
+  const std::chrono::milliseconds diagnostics_delay_;
+  std::mutex diagnostics_mutex_;
+  std::condition_variable diagnostics_changed_;
+  llvm::StringMap<PendingDiagnostics> pending_diagnostics_;
+  // Incremented for each change to a document, including closing it.
+  llvm::StringMap<int64_t> diagnostics_generations_;
+  bool stopping_ = false;
+  // Declared last so that it starts after the members it uses are
+  // initialized.
+  std::thread diagnostics_thread_;
 
   // Typed handlers for notifications and method calls by client.
 
@@ -68,14 +128,55 @@ class LanguageServer : public clang::clangd::Transport::MessageHandler,
   void OnDidChangeTextDocument(
       clang::clangd::DidChangeTextDocumentParams const& params);
 
-  // Capabilities negotiation
-  void OnInitialize(clang::clangd::NoParams const& client_capabilities,
+  // Client saved a document.
+  void OnDidSaveTextDocument(
+      clang::clangd::DidSaveTextDocumentParams const& params);
+
+  // Client closed a document.
+  void OnDidCloseTextDocument(
+      clang::clangd::DidCloseTextDocumentParams const& params);
+
+  // Replaces the symbols for `file` in the index with those in its current
+  // text.
+  void IndexDocument(llvm::StringRef file, Document& document);
+
+  // Schedules publishing the diagnostics for `text`, the new text of a
+  // document, replacing any that are pending for the document.
+  void ScheduleDiagnostics(const clang::clangd::URIForFile& uri,
+                           std::string text);
+
+  // Checks pending documents once their delay has passed, and publishes their
+  // diagnostics. Runs on `diagnostics_thread_` until `stopping_` is set.
+  void RunDiagnostics();
+
+  // Returns the diagnostics for a document, in the form sent to the client.
+  static auto MakeDiagnostics(const clang::clangd::URIForFile& uri,
+                              Document& document)
+      -> clang::clangd::PublishDiagnosticsParams;
+
+  // Capabilities negotiation, and starts indexing the workspace.
+  void OnInitialize(clang::clangd::InitializeParams const& params,
                     clang::clangd::Callback<llvm::json::Object> cb);
 
   // Code outline
   void OnDocumentSymbol(
       clang::clangd::DocumentSymbolParams const& params,
       clang::clangd::Callback<std::vector<clang::clangd::DocumentSymbol>> cb);
+
+  // Symbol search across the workspace
+  void OnWorkspaceSymbol(
+      clang::clangd::WorkspaceSymbolParams const& params,
+      clang::clangd::Callback<std::vector<clang::clangd::SymbolInformation>>
+          cb);
+
+  // Type of the expression under the cursor
+  void OnHover(clang::clangd::TextDocumentPositionParams const& params,
+               clang::clangd::Callback<std::optional<clang::clangd::Hover>> cb);
+
+  // Declaration of the name under the cursor
+  void OnDefinition(
+      clang::clangd::TextDocumentPositionParams const& params,
+      clang::clangd::Callback<std::vector<clang::clangd::Location>> cb);
 };
 
 }  // namespace Carbon::LS
@@ -0,0 +1,243 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "language_server/language_server.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "clang-tools-extra/clangd/Transport.h"
+#include "common/check.h"
+#include "llvm/Support/JSON.h"
+
+namespace Carbon::LS {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+// A transport which records the messages sent by the server. Messages from the
+// client are passed to the server directly by the tests.
+class FakeTransport : public clang::clangd::Transport {
+ public:
+  void notify(llvm::StringRef method, llvm::json::Value params) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    notifications_.push_back({method.str(), std::move(params)});
+    notified_.notify_all();
+  }
+
+  void call(llvm::StringRef /*method*/, llvm::json::Value /*params*/,
+            llvm::json::Value /*id*/) override {}
+
+  void reply(llvm::json::Value id,
+             llvm::Expected<llvm::json::Value> result) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (result) {
+      replies_.insert({*id.getAsInteger(), std::move(*result)});
+    } else {
+      replies_.insert({*id.getAsInteger(), nullptr});
+      llvm::consumeError(result.takeError());
+    }
+  }
+
+  auto loop(MessageHandler& /*handler*/) -> llvm::Error override {
+    return llvm::Error::success();
+  }
+
+  // Returns the reply to the call with the given ID.
+  auto GetReply(int64_t id) -> llvm::json::Value {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = replies_.find(id);
+    CARBON_CHECK(it != replies_.end()) << "No reply to call " << id;
+    return it->second;
+  }
+
+  // Waits for the first `textDocument/publishDiagnostics` notification, and
+  // returns its diagnostics.
+  auto WaitForDiagnostics() -> llvm::json::Array {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      for (const auto& [method, params] : notifications_) {
+        if (method == "textDocument/publishDiagnostics") {
+          return *params.getAsObject()->getArray("diagnostics");
+        }
+      }
+      notified_.wait(lock);
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable notified_;
+  std::vector<std::pair<std::string, llvm::json::Value>> notifications_;
+  std::map<int64_t, llvm::json::Value> replies_;
+};
+
+constexpr llvm::StringLiteral Uri = "file:///test.carbon";
+
+class LanguageServerTest : public ::testing::Test {
+ protected:
+  LanguageServerTest()
+      : transport_(new FakeTransport),
+        server_(std::unique_ptr<clang::clangd::Transport>(transport_),
+                std::chrono::milliseconds(0)) {}
+
+  auto Open(llvm::StringRef text) -> void {
+    server_.onNotify("textDocument/didOpen",
+                     llvm::json::Object{{"textDocument",
+                                         llvm::json::Object{
+                                             {"uri", Uri},
+                                             {"languageId", "carbon"},
+                                             {"version", 1},
+                                             {"text", text},
+                                         }}});
+  }
+
+  // Calls a method that takes a position in the document, returning the reply.
+  auto CallAt(llvm::StringRef method, int line, int character)
+      -> llvm::json::Value {
+    int64_t id = ++last_id_;
+    server_.onCall(
+        method,
+        llvm::json::Object{
+            {"textDocument", llvm::json::Object{{"uri", Uri}}},
+            {"position",
+             llvm::json::Object{{"line", line}, {"character", character}}}},
+        id);
+    return transport_->GetReply(id);
+  }
+
+  // Owned by `server_`.
+  FakeTransport* transport_;
+  LanguageServer server_;
+  int64_t last_id_ = 0;
+};
+
+constexpr llvm::StringLiteral Program = R"(fn Echo(a: i32) -> i32 {
+  return a;
+}
+
+fn Main() {
+  var b: i32 = Echo(1);
+}
+)";
+
+TEST_F(LanguageServerTest, HoverName) {
+  Open(Program);
+  auto hover = CallAt("textDocument/hover", 1, 9);
+  ASSERT_NE(hover.getAsObject(), nullptr);
+  EXPECT_EQ(hover, llvm::json::Value(llvm::json::Object{
+                       {"contents",
+                        llvm::json::Object{{"kind", "plaintext"},
+                                           {"value", "a: i32"}}},
+                       {"range",
+                        llvm::json::Object{
+                            {"start", llvm::json::Object{{"line", 1},
+                                                         {"character", 9}}},
+                            {"end", llvm::json::Object{{"line", 1},
+                                                       {"character", 10}}}}},
+                   }));
+}
+
+TEST_F(LanguageServerTest, HoverFunctionName) {
+  Open(Program);
+  auto hover = CallAt("textDocument/hover", 5, 16);
+  ASSERT_NE(hover.getAsObject(), nullptr);
+  EXPECT_EQ(*hover.getAsObject()->getObject("contents")->getString("value"),
+            "Echo: <function>");
+}
+
+TEST_F(LanguageServerTest, HoverWhitespace) {
+  Open(Program);
+  EXPECT_EQ(CallAt("textDocument/hover", 3, 0), llvm::json::Value(nullptr));
+  EXPECT_EQ(CallAt("textDocument/hover", 1, 1), llvm::json::Value(nullptr));
+}
+
+// Returns the start of the single location in a `textDocument/definition`
+// reply, as a (line, character) pair.
+auto GetDefinitionStart(const llvm::json::Value& reply)
+    -> std::pair<int64_t, int64_t> {
+  const auto* locations = reply.getAsArray();
+  CARBON_CHECK(locations && locations->size() == 1)
+      << "Expected one location in " << reply;
+  const auto* start =
+      (*locations)[0].getAsObject()->getObject("range")->getObject("start");
+  return {*start->getInteger("line"), *start->getInteger("character")};
+}
+
+TEST_F(LanguageServerTest, DefinitionOfParameter) {
+  Open(Program);
+  auto definition = CallAt("textDocument/definition", 1, 9);
+  EXPECT_EQ(GetDefinitionStart(definition),
+            std::make_pair(int64_t{0}, int64_t{8}));
+  EXPECT_EQ(*definition.getAsArray()->front().getAsObject()->getString("uri"),
+            Uri);
+}
+
+TEST_F(LanguageServerTest, DefinitionOfFunction) {
+  Open(Program);
+  auto definition = CallAt("textDocument/definition", 5, 16);
+  EXPECT_EQ(GetDefinitionStart(definition),
+            std::make_pair(int64_t{0}, int64_t{3}));
+}
+
+TEST_F(LanguageServerTest, DefinitionOfNonName) {
+  Open(Program);
+  // The integer literal `1`.
+  EXPECT_THAT(*CallAt("textDocument/definition", 5, 20).getAsArray(),
+              IsEmpty());
+  // The `fn` keyword.
+  EXPECT_THAT(*CallAt("textDocument/definition", 0, 0).getAsArray(),
+              IsEmpty());
+}
+
+TEST_F(LanguageServerTest, QueriesAfterEdit) {
+  Open(Program);
+  server_.onNotify(
+      "textDocument/didChange",
+      llvm::json::Object{
+          {"textDocument", llvm::json::Object{{"uri", Uri}, {"version", 2}}},
+          {"contentChanges",
+           llvm::json::Array{llvm::json::Object{
+               {"text", "fn F(x: i32) -> i32 {\n  return x;\n}\n"}}}}});
+  auto hover = CallAt("textDocument/hover", 1, 9);
+  ASSERT_NE(hover.getAsObject(), nullptr);
+  EXPECT_EQ(*hover.getAsObject()->getObject("contents")->getString("value"),
+            "x: i32");
+  EXPECT_EQ(GetDefinitionStart(CallAt("textDocument/definition", 1, 9)),
+            std::make_pair(int64_t{0}, int64_t{5}));
+}
+
+TEST_F(LanguageServerTest, WorkspaceSymbolAfterEdit) {
+  Open(Program);
+  server_.onNotify(
+      "textDocument/didChange",
+      llvm::json::Object{
+          {"textDocument", llvm::json::Object{{"uri", Uri}, {"version", 2}}},
+          {"contentChanges", llvm::json::Array{llvm::json::Object{
+                                 {"text", "fn Renamed() {}\n"}}}}});
+  // The edit isn't indexed until the index is queried.
+  int64_t id = ++last_id_;
+  server_.onCall("workspace/symbol", llvm::json::Object{{"query", "renamed"}},
+                 id);
+  const auto* symbols = transport_->GetReply(id).getAsArray();
+  ASSERT_NE(symbols, nullptr);
+  ASSERT_THAT(*symbols, SizeIs(1));
+  EXPECT_EQ(*(*symbols)[0].getAsObject()->getString("name"), "Renamed");
+}
+
+TEST_F(LanguageServerTest, DiagnosticsArePublishedOffTheEditPath) {
+  Open("fn F() -> i32 {\n  return x;\n}\n");
+  EXPECT_THAT(transport_->WaitForDiagnostics(), SizeIs(1));
+}
+
+}  // namespace
+}  // namespace Carbon::LS
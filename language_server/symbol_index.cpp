@@ -0,0 +1,391 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "language_server/symbol_index.h"
+
+#include <algorithm>
+#include <optional>
+#include <tuple>
+
+#include "clang-tools-extra/clangd/FuzzyMatch.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "toolchain/diagnostics/null_diagnostics.h"
+#include "toolchain/parse/node_kind.h"
+#include "toolchain/source/source_buffer.h"
+
+namespace Carbon::LS {
+
+// Identifies the on-disk format. Bump the version when changing the layout.
+static constexpr llvm::StringLiteral IndexMagic = "CBSI";
+static constexpr uint32_t IndexVersion = 1;
+
+// Returns a mask with a bit for each letter, digit and underscore in `text`,
+// ignoring case. Other characters share the last bit.
+static auto GetCharMask(llvm::StringRef text) -> uint64_t {
+  uint64_t mask = 0;
+  for (char c : text) {
+    c = llvm::toLower(c);
+    int bit;
+    if (c >= 'a' && c <= 'z') {
+      bit = c - 'a';
+    } else if (c >= '0' && c <= '9') {
+      bit = 26 + (c - '0');
+    } else if (c == '_') {
+      bit = 36;
+    } else {
+      bit = 37;
+    }
+    mask |= uint64_t{1} << bit;
+  }
+  return mask;
+}
+
+// Returns the modification time of `file` as a count since the epoch, or
+// nullopt if it can't be read.
+static auto GetModificationTime(llvm::StringRef file)
+    -> std::optional<int64_t> {
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(file, status)) {
+    return std::nullopt;
+  }
+  return status.getLastModificationTime().time_since_epoch().count();
+}
+
+// Reads a little-endian integer from the front of `data`. On running out of
+// data, sets `ok` to false and returns 0.
+template <typename IntT>
+static auto ReadInt(llvm::StringRef& data, bool& ok) -> IntT {
+  if (data.size() < sizeof(IntT)) {
+    ok = false;
+    return 0;
+  }
+  auto value =
+      llvm::support::endian::read<IntT, llvm::support::little>(data.data());
+  data = data.drop_front(sizeof(IntT));
+  return value;
+}
+
+// Reads a size-prefixed string from the front of `data`. On running out of
+// data, sets `ok` to false and returns an empty string.
+static auto ReadString(llvm::StringRef& data, bool& ok) -> llvm::StringRef {
+  auto size = ReadInt<uint32_t>(data, ok);
+  if (data.size() < size) {
+    ok = false;
+    return "";
+  }
+  auto str = data.take_front(size);
+  data = data.drop_front(size);
+  return str;
+}
+
+auto SymbolIndex::CollectSymbols(const Lex::TokenizedBuffer& tokens,
+                                 const Parse::Tree& parse_tree)
+    -> std::vector<Symbol> {
+  std::vector<Symbol> symbols;
+  for (auto node : parse_tree.postorder()) {
+    clang::clangd::SymbolKind kind;
+    switch (parse_tree.node_kind(node)) {
+      case Parse::NodeKind::FunctionDeclaration:
+      case Parse::NodeKind::FunctionDefinitionStart:
+        kind = clang::clangd::SymbolKind::Function;
+        break;
+      case Parse::NodeKind::Namespace:
+        kind = clang::clangd::SymbolKind::Namespace;
+        break;
+      case Parse::NodeKind::InterfaceDefinitionStart:
+      case Parse::NodeKind::NamedConstraintDefinitionStart:
+        kind = clang::clangd::SymbolKind::Interface;
+        break;
+      case Parse::NodeKind::ClassDefinitionStart:
+        kind = clang::clangd::SymbolKind::Class;
+        break;
+      default:
+        continue;
+    }
+
+    // The declared name is the first child of kind Name.
+    for (auto child : parse_tree.children(node)) {
+      if (parse_tree.node_kind(child) == Parse::NodeKind::Name) {
+        auto token = parse_tree.node_token(child);
+        symbols.push_back({.name = parse_tree.GetNodeText(child).str(),
+                           .kind = kind,
+                           .line = tokens.GetLineNumber(token) - 1,
+                           .column = tokens.GetColumnNumber(token) - 1});
+        break;
+      }
+    }
+  }
+  return symbols;
+}
+
+auto SymbolIndex::Load(llvm::StringRef path) -> bool {
+  std::lock_guard<std::mutex> lock(mutex_);
+  files_.clear();
+
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    return false;
+  }
+  llvm::StringRef data = (*buffer)->getBuffer();
+
+  bool ok = true;
+  auto read_string = [&]() { return ReadString(data, ok); };
+  auto read_u32 = [&]() { return ReadInt<uint32_t>(data, ok); };
+
+  if (!data.consume_front(IndexMagic) || read_u32() != IndexVersion) {
+    return false;
+  }
+  auto num_files = read_u32();
+  for (uint32_t i = 0; ok && i < num_files; ++i) {
+    auto file = read_string();
+    auto modification_time = ReadInt<int64_t>(data, ok);
+    auto num_symbols = read_u32();
+    std::vector<Symbol> symbols;
+    for (uint32_t j = 0; ok && j < num_symbols; ++j) {
+      auto name = read_string();
+      auto kind =
+          static_cast<clang::clangd::SymbolKind>(ReadInt<uint8_t>(data, ok));
+      int line = read_u32();
+      int column = read_u32();
+      symbols.push_back(
+          {.name = name.str(), .kind = kind, .line = line, .column = column});
+    }
+    UpdateFileLocked(file, modification_time, std::move(symbols));
+  }
+  if (!ok || !data.empty()) {
+    files_.clear();
+    return false;
+  }
+  return true;
+}
+
+auto SymbolIndex::Save(llvm::StringRef path) const -> bool {
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path))) {
+    return false;
+  }
+  // Write to a temporary file first so that a concurrent reader or a crash
+  // never sees a partial index.
+  std::string temp_path = (path + ".tmp").str();
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream out(temp_path, ec);
+    if (ec) {
+      return false;
+    }
+    llvm::support::endian::Writer writer(out, llvm::support::little);
+    auto write_string = [&](llvm::StringRef str) {
+      writer.write<uint32_t>(str.size());
+      out << str;
+    };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    out << IndexMagic;
+    writer.write<uint32_t>(IndexVersion);
+    writer.write<uint32_t>(files_.size());
+    for (const auto& file : files_) {
+      write_string(file.first());
+      writer.write<int64_t>(file.second.modification_time);
+      writer.write<uint32_t>(file.second.symbols.size());
+      for (const auto& indexed : file.second.symbols) {
+        write_string(indexed.symbol.name);
+        writer.write<uint8_t>(static_cast<uint8_t>(indexed.symbol.kind));
+        writer.write<uint32_t>(indexed.symbol.line);
+        writer.write<uint32_t>(indexed.symbol.column);
+      }
+    }
+    if (out.has_error()) {
+      out.clear_error();
+      return false;
+    }
+  }
+  return !llvm::sys::fs::rename(temp_path, path);
+}
+
+auto SymbolIndex::IndexWorkspace(llvm::StringRef root, llvm::ThreadPool& pool)
+    -> void {
+  // Walking a large workspace takes a while, so it's also done on the pool.
+  pool.async([this, root = root.str(), &pool] {
+    llvm::StringSet<> seen;
+    std::error_code ec;
+    for (llvm::sys::fs::recursive_directory_iterator
+             it(root, ec, /*follow_symlinks=*/false),
+         end;
+         it != end && !ec; it.increment(ec)) {
+      llvm::StringRef path = it->path();
+      llvm::StringRef filename = llvm::sys::path::filename(path);
+      if (it->type() == llvm::sys::fs::file_type::directory_file) {
+        if (filename.startswith(".")) {
+          it.no_push();
+        }
+        continue;
+      }
+      if (llvm::sys::path::extension(path) != ".carbon") {
+        continue;
+      }
+      auto modification_time = GetModificationTime(path);
+      if (!modification_time) {
+        continue;
+      }
+      seen.insert(path);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = files_.find(path);
+        if (existing != files_.end() &&
+            existing->second.modification_time == *modification_time) {
+          continue;
+        }
+      }
+      pool.async([this, file = path.str(), time = *modification_time] {
+        IndexFile(file, time);
+      });
+    }
+    if (ec) {
+      return;
+    }
+
+    // Drop files deleted since the index was saved.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = files_.begin(); it != files_.end();) {
+      auto current = it++;
+      if (!seen.contains(current->first()) &&
+          current->second.modification_time != EditorModificationTime) {
+        files_.erase(current);
+      }
+    }
+  });
+}
+
+auto SymbolIndex::CloseFile(llvm::StringRef file, llvm::ThreadPool& pool)
+    -> void {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto existing = files_.find(file);
+    if (existing == files_.end()) {
+      return;
+    }
+    // No longer from the client, and not matching any time on disk until
+    // reindexed.
+    existing->second.modification_time = 0;
+  }
+  pool.async([this, file = file.str()] {
+    if (auto modification_time = GetModificationTime(file)) {
+      IndexFile(file, *modification_time);
+    } else {
+      std::lock_guard<std::mutex> lock(mutex_);
+      files_.erase(file);
+    }
+  });
+}
+
+auto SymbolIndex::IndexFile(std::string file, int64_t modification_time)
+    -> void {
+  auto fs = llvm::vfs::getRealFileSystem();
+  auto source =
+      SourceBuffer::CreateFromFile(*fs, file, NullDiagnosticConsumer());
+  if (!source) {
+    return;
+  }
+  auto tokens = Lex::TokenizedBuffer::Lex(*source, NullDiagnosticConsumer());
+  auto parse_tree = Parse::Tree::Parse(tokens, NullDiagnosticConsumer(),
+                                       /*vlog_stream=*/nullptr);
+  UpdateFile(file, modification_time, CollectSymbols(tokens, parse_tree));
+}
+
+auto SymbolIndex::UpdateFile(llvm::StringRef file, int64_t modification_time,
+                             std::vector<Symbol> symbols) -> void {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (modification_time != EditorModificationTime) {
+    auto existing = files_.find(file);
+    if (existing != files_.end() &&
+        existing->second.modification_time == EditorModificationTime) {
+      return;
+    }
+  }
+  UpdateFileLocked(file, modification_time, std::move(symbols));
+}
+
+auto SymbolIndex::UpdateFileLocked(llvm::StringRef file,
+                                   int64_t modification_time,
+                                   std::vector<Symbol> symbols) -> void {
+  auto& entry = files_[file];
+  entry.modification_time = modification_time;
+  entry.symbols.clear();
+  entry.symbols.reserve(symbols.size());
+  for (auto& symbol : symbols) {
+    uint64_t char_mask = GetCharMask(symbol.name);
+    entry.symbols.push_back(
+        {.symbol = std::move(symbol), .char_mask = char_mask});
+  }
+}
+
+auto SymbolIndex::Query(llvm::StringRef query, int limit) const
+    -> std::vector<clang::clangd::SymbolInformation> {
+  clang::clangd::FuzzyMatcher matcher(query);
+  uint64_t query_mask = GetCharMask(query);
+
+  struct Match {
+    float score;
+    llvm::StringRef file;
+    const Symbol* symbol;
+  };
+  std::vector<Match> matches;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& file : files_) {
+    for (const auto& indexed : file.second.symbols) {
+      // Every character of the query must appear in a matching name.
+      if ((indexed.char_mask & query_mask) != query_mask) {
+        continue;
+      }
+      if (auto score = matcher.match(indexed.symbol.name)) {
+        matches.push_back(
+            {.score = *score, .file = file.first(), .symbol = &indexed.symbol});
+      }
+    }
+  }
+
+  // Only the best `limit` matches need to be ordered. Ties are broken by name
+  // and location so that the results don't depend on the order of `files_`.
+  auto by_score = [](const Match& lhs, const Match& rhs) {
+    if (lhs.score != rhs.score) {
+      return lhs.score > rhs.score;
+    }
+    return std::tie(lhs.symbol->name, lhs.file, lhs.symbol->line,
+                    lhs.symbol->column) <
+           std::tie(rhs.symbol->name, rhs.file, rhs.symbol->line,
+                    rhs.symbol->column);
+  };
+  if (limit > 0 && static_cast<int>(matches.size()) > limit) {
+    std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(),
+                      by_score);
+    matches.resize(limit);
+  } else {
+    std::sort(matches.begin(), matches.end(), by_score);
+  }
+
+  std::vector<clang::clangd::SymbolInformation> results;
+  results.reserve(matches.size());
+  for (const auto& match : matches) {
+    clang::clangd::Position start{match.symbol->line, match.symbol->column};
+    clang::clangd::Position end = start;
+    end.character += match.symbol->name.size();
+    results.push_back(
+        {.name = match.symbol->name,
+         .kind = match.symbol->kind,
+         .location = {.uri = clang::clangd::URIForFile::canonicalize(
+                          match.file, /*TUPath=*/match.file),
+                      .range = {.start = start, .end = end}},
+         .score = match.score});
+  }
+  return results;
+}
+
+}  // namespace Carbon::LS
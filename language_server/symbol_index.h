@@ -0,0 +1,103 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_LANGUAGE_SERVER_SYMBOL_INDEX_H_
+#define CARBON_LANGUAGE_SERVER_SYMBOL_INDEX_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "clang-tools-extra/clangd/Protocol.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ThreadPool.h"
+#include "toolchain/lex/tokenized_buffer.h"
+#include "toolchain/parse/tree.h"
+
+namespace Carbon::LS {
+
+// An index of the declarations in every Carbon file of a workspace, for
+// `workspace/symbol` queries.
+//
+// Files are indexed in the background on a thread pool. The index is saved to
+// disk along with each file's modification time, so that a later session only
+// needs to reindex files which changed. Files open in the client are indexed
+// from their current text instead.
+//
+// All methods are thread-safe.
+class SymbolIndex {
+ public:
+  // A declaration in a file. Positions are 0-based, as in the language server
+  // protocol, and refer to the declared name.
+  struct Symbol {
+    std::string name;
+    clang::clangd::SymbolKind kind;
+    int line;
+    int column;
+  };
+
+  // The modification time recorded for files indexed from the client's text.
+  // Such files are always reindexed in the next session.
+  static constexpr int64_t EditorModificationTime = -1;
+
+  // Returns the declarations in a parse tree.
+  static auto CollectSymbols(const Lex::TokenizedBuffer& tokens,
+                             const Parse::Tree& parse_tree)
+      -> std::vector<Symbol>;
+
+  // Loads an index saved by `Save`, replacing the current contents. Returns
+  // false if the file is missing or malformed, leaving the index empty.
+  auto Load(llvm::StringRef path) -> bool;
+
+  // Saves the index to `path`, creating parent directories as needed.
+  auto Save(llvm::StringRef path) const -> bool;
+
+  // Starts indexing every `.carbon` file under `root` on `pool`, skipping files
+  // whose modification time matches the index. Hidden directories are skipped.
+  // Use `pool.wait()` to wait for indexing to finish.
+  auto IndexWorkspace(llvm::StringRef root, llvm::ThreadPool& pool) -> void;
+
+  // Reindexes `file` from disk on `pool`, once the client stops providing its
+  // text.
+  auto CloseFile(llvm::StringRef file, llvm::ThreadPool& pool) -> void;
+
+  // Replaces the symbols for `file`. An update from disk doesn't replace
+  // symbols from the client's text, which are newer.
+  auto UpdateFile(llvm::StringRef file, int64_t modification_time,
+                  std::vector<Symbol> symbols) -> void;
+
+  // Returns up to `limit` symbols whose name fuzzy-matches `query`, best match
+  // first. An empty query matches every symbol.
+  auto Query(llvm::StringRef query, int limit) const
+      -> std::vector<clang::clangd::SymbolInformation>;
+
+ private:
+  // A symbol along with a mask of the characters in its name, used to skip
+  // most non-matching names without running the fuzzy matcher.
+  struct IndexedSymbol {
+    Symbol symbol;
+    uint64_t char_mask;
+  };
+
+  struct FileEntry {
+    int64_t modification_time;
+    std::vector<IndexedSymbol> symbols;
+  };
+
+  // Indexes a file from disk. Runs on the thread pool.
+  auto IndexFile(std::string file, int64_t modification_time) -> void;
+
+  // Replaces the symbols for `file`. `mutex_` must be held.
+  auto UpdateFileLocked(llvm::StringRef file, int64_t modification_time,
+                        std::vector<Symbol> symbols) -> void;
+
+  mutable std::mutex mutex_;
+  llvm::StringMap<FileEntry> files_;
+};
+
+}  // namespace Carbon::LS
+
+#endif  // CARBON_LANGUAGE_SERVER_SYMBOL_INDEX_H_
@@ -0,0 +1,83 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/random/random.h"
+#include "language_server/symbol_index.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/Support/FormatVariadic.h"
+
+namespace Carbon::LS {
+namespace {
+
+// The size of a large workspace. `workspace/symbol` queries are made on each
+// keystroke, so should stay well under a millisecond at this size.
+constexpr int NumSymbols = 100'000;
+constexpr int SymbolsPerFile = 100;
+
+// Generates a random CamelCase name of two to four words.
+auto GenerateRandomName(absl::BitGen& gen) -> std::string {
+  std::string name;
+  int num_words = absl::Uniform<int>(gen, 2, 5);
+  for (int i : llvm::seq(0, num_words)) {
+    static_cast<void>(i);
+    name += absl::Uniform<char>(gen, 'A', 'Z' + 1);
+    int length = absl::Uniform<int>(gen, 2, 8);
+    for (int j : llvm::seq(0, length)) {
+      static_cast<void>(j);
+      name += absl::Uniform<char>(gen, 'a', 'z' + 1);
+    }
+  }
+  return name;
+}
+
+// Returns an index of `NumSymbols` random symbols, built once.
+auto GetIndex() -> const SymbolIndex& {
+  static const SymbolIndex* index = [] {
+    absl::BitGen gen;
+    auto* index = new SymbolIndex;
+    for (int file : llvm::seq(0, NumSymbols / SymbolsPerFile)) {
+      std::vector<SymbolIndex::Symbol> symbols;
+      for (int line : llvm::seq(0, SymbolsPerFile)) {
+        symbols.push_back({.name = GenerateRandomName(gen),
+                           .kind = clang::clangd::SymbolKind::Function,
+                           .line = line,
+                           .column = 3});
+      }
+      index->UpdateFile(llvm::formatv("/workspace/file{0}.carbon", file).str(),
+                        /*modification_time=*/1, std::move(symbols));
+    }
+    return index;
+  }();
+  return *index;
+}
+
+auto BM_Query(benchmark::State& state, llvm::StringRef query) -> void {
+  const SymbolIndex& index = GetIndex();
+  int num_results = 0;
+  for (auto _ : state) {
+    auto results = index.Query(query, /*limit=*/100);
+    num_results = results.size();
+    benchmark::DoNotOptimize(results);
+  }
+  state.counters["results"] = num_results;
+  state.counters["symbols_per_second"] = benchmark::Counter(
+      NumSymbols, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// A query as typed early on, which most names fail.
+BENCHMARK_CAPTURE(BM_Query, ShortQuery, "xq");
+// A typical query, which the character mask filters before fuzzy matching.
+BENCHMARK_CAPTURE(BM_Query, WordQuery, "fooba");
+// A query whose characters appear in many names.
+BENCHMARK_CAPTURE(BM_Query, CommonQuery, "ae");
+// Every symbol matches, so this is dominated by fuzzy matching and sorting.
+BENCHMARK_CAPTURE(BM_Query, EmptyQuery, "");
+
+}  // namespace
+}  // namespace Carbon::LS
@@ -0,0 +1,216 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "language_server/symbol_index.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "common/check.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Carbon::LS {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+using Kind = clang::clangd::SymbolKind;
+
+class SymbolIndexTest : public ::testing::Test {
+ protected:
+  SymbolIndexTest() {
+    CARBON_CHECK(!llvm::sys::fs::createUniqueDirectory("symbol_index_test",
+                                                       temp_dir_));
+    index_path_ = (temp_dir_ + "/.cache/carbon/symbols.idx").str();
+  }
+
+  ~SymbolIndexTest() override {
+    llvm::sys::fs::remove_directories(temp_dir_);
+  }
+
+  // Replaces the contents of the saved index.
+  auto WriteIndexFile(llvm::StringRef contents) -> void {
+    std::error_code ec;
+    llvm::raw_fd_ostream out(index_path_, ec);
+    CARBON_CHECK(!ec) << ec.message();
+    out << contents;
+  }
+
+  // Returns the contents of the saved index.
+  auto ReadIndexFile() -> std::string {
+    auto buffer = llvm::MemoryBuffer::getFile(index_path_);
+    CARBON_CHECK(buffer) << buffer.getError().message();
+    return (*buffer)->getBuffer().str();
+  }
+
+  // Returns a description of each symbol in `index`, to compare against.
+  static auto Describe(const SymbolIndex& index) -> std::vector<std::string> {
+    std::vector<std::string> result;
+    for (const auto& info : index.Query("", /*limit=*/0)) {
+      result.push_back(llvm::formatv("{0} {1} {2}:{3}:{4}", info.name,
+                                     static_cast<int>(info.kind),
+                                     info.location.uri.file(),
+                                     info.location.range.start.line,
+                                     info.location.range.start.character)
+                           .str());
+    }
+    return result;
+  }
+
+  // Saves an index with a few symbols.
+  auto SaveIndex() -> void {
+    SymbolIndex index;
+    index.UpdateFile("/a.carbon", 42,
+                     {{.name = "Foo", .kind = Kind::Function, .line = 1,
+                       .column = 3},
+                      {.name = "Bar", .kind = Kind::Class, .line = 4,
+                       .column = 6}});
+    index.UpdateFile("/b.carbon", SymbolIndex::EditorModificationTime,
+                     {{.name = "N", .kind = Kind::Namespace, .line = 0,
+                       .column = 10}});
+    ASSERT_TRUE(index.Save(index_path_));
+  }
+
+  llvm::SmallString<128> temp_dir_;
+  std::string index_path_;
+};
+
+TEST_F(SymbolIndexTest, SaveAndLoad) {
+  SaveIndex();
+  SymbolIndex loaded;
+  ASSERT_TRUE(loaded.Load(index_path_));
+  EXPECT_THAT(Describe(loaded),
+              UnorderedElementsAre("Foo 12 /a.carbon:1:3", "Bar 5 /a.carbon:4:6",
+                                   "N 3 /b.carbon:0:10"));
+}
+
+TEST_F(SymbolIndexTest, LoadMissing) {
+  SymbolIndex index;
+  EXPECT_FALSE(index.Load(index_path_));
+  EXPECT_THAT(Describe(index), IsEmpty());
+}
+
+TEST_F(SymbolIndexTest, LoadRejectsOtherVersion) {
+  SaveIndex();
+  std::string contents = ReadIndexFile();
+  // The version follows the four-byte magic.
+  ++contents[4];
+  WriteIndexFile(contents);
+
+  SymbolIndex index;
+  index.UpdateFile("/c.carbon", 1,
+                   {{.name = "Old", .kind = Kind::Class, .line = 0,
+                     .column = 0}});
+  EXPECT_FALSE(index.Load(index_path_));
+  // A failed load leaves the index empty.
+  EXPECT_THAT(Describe(index), IsEmpty());
+}
+
+TEST_F(SymbolIndexTest, LoadRejectsCorruptFiles) {
+  SaveIndex();
+  std::string contents = ReadIndexFile();
+  std::vector<std::string> corrupt = {
+      "",
+      "XXXX" + contents.substr(4),
+      contents.substr(0, contents.size() - 1),
+      contents.substr(0, contents.size() / 2),
+      contents + "x",
+  };
+  for (const auto& file : corrupt) {
+    SCOPED_TRACE(file.size());
+    WriteIndexFile(file);
+    SymbolIndex index;
+    EXPECT_FALSE(index.Load(index_path_));
+    EXPECT_THAT(Describe(index), IsEmpty());
+  }
+}
+
+TEST_F(SymbolIndexTest, Query) {
+  SymbolIndex index;
+  index.UpdateFile("/a.carbon", 1,
+                   {{.name = "FooBar", .kind = Kind::Class, .line = 0,
+                     .column = 0},
+                    {.name = "Foo", .kind = Kind::Function, .line = 1,
+                     .column = 0},
+                    {.name = "Baz", .kind = Kind::Function, .line = 2,
+                     .column = 0}});
+
+  auto names = [&](llvm::StringRef query, int limit) {
+    std::vector<std::string> result;
+    for (const auto& info : index.Query(query, limit)) {
+      result.push_back(info.name);
+    }
+    return result;
+  };
+  EXPECT_THAT(names("foo", 0), UnorderedElementsAre("Foo", "FooBar"));
+  EXPECT_THAT(names("fb", 0), ElementsAre("FooBar"));
+  EXPECT_THAT(names("q", 0), IsEmpty());
+  EXPECT_THAT(names("", 0), SizeIs(3));
+
+  // Better matches come first, and a limit keeps the best.
+  auto all = index.Query("foo", 0);
+  ASSERT_THAT(all, SizeIs(2));
+  EXPECT_GE(all[0].score, all[1].score);
+  EXPECT_THAT(names("foo", 1), ElementsAre(all[0].name));
+
+  auto results = index.Query("baz", 0);
+  ASSERT_THAT(results, SizeIs(1));
+  EXPECT_EQ(results[0].location.uri.file(), "/a.carbon");
+  EXPECT_EQ(results[0].location.range.start.line, 2);
+  EXPECT_EQ(results[0].location.range.end.character, 3);
+}
+
+TEST_F(SymbolIndexTest, QueryBreaksTiesByNameAndLocation) {
+  SymbolIndex index;
+  index.UpdateFile("/b.carbon", 1,
+                   {{.name = "Foo", .kind = Kind::Class, .line = 3,
+                     .column = 0},
+                    {.name = "Foo", .kind = Kind::Class, .line = 1,
+                     .column = 4},
+                    {.name = "Foo", .kind = Kind::Class, .line = 1,
+                     .column = 2}});
+  index.UpdateFile("/a.carbon", 1,
+                   {{.name = "Foo", .kind = Kind::Class, .line = 5,
+                     .column = 0}});
+
+  auto locations = [&](int limit) {
+    std::vector<std::string> result;
+    for (const auto& info : index.Query("foo", limit)) {
+      result.push_back(llvm::formatv("{0}:{1}:{2}", info.location.uri.file(),
+                                     info.location.range.start.line,
+                                     info.location.range.start.character)
+                           .str());
+    }
+    return result;
+  };
+  EXPECT_THAT(locations(0), ElementsAre("/a.carbon:5:0", "/b.carbon:1:2",
+                                        "/b.carbon:1:4", "/b.carbon:3:0"));
+  EXPECT_THAT(locations(2), ElementsAre("/a.carbon:5:0", "/b.carbon:1:2"));
+}
+
+TEST_F(SymbolIndexTest, EditorSymbolsReplaceDiskSymbols) {
+  SymbolIndex index;
+  index.UpdateFile("/a.carbon", SymbolIndex::EditorModificationTime,
+                   {{.name = "Edited", .kind = Kind::Class, .line = 0,
+                     .column = 0}});
+  // A file indexed from disk doesn't replace the editor's newer text.
+  index.UpdateFile("/a.carbon", 1,
+                   {{.name = "Saved", .kind = Kind::Class, .line = 0,
+                     .column = 0}});
+  EXPECT_THAT(Describe(index), ElementsAre("Edited 5 /a.carbon:0:0"));
+}
+
+}  // namespace
+}  // namespace Carbon::LS
@@ -31,7 +31,8 @@ auto CheckParseTree(const SemIR::File& builtin_ir,
   context.PushScope();
 
   // Loops over all nodes in the tree. On some errors, this may return early,
-  // for example if an unrecoverable state is encountered.
+  // for example if an unrecoverable state is encountered or the error limit is
+  // reached.
   for (auto parse_node : parse_tree.postorder()) {
     // clang warns on unhandled enum values; clang-tidy is incorrect here.
     // NOLINTNEXTLINE(bugprone-switch-missing-default-case)
@@ -48,6 +49,12 @@ auto CheckParseTree(const SemIR::File& builtin_ir,
   }
 #include "toolchain/parse/node_kind.def"
     }
+
+    // Further diagnostics would be discarded, so stop checking.
+    if (err_tracker.reached_error_limit()) {
+      semantics_ir.set_has_errors(true);
+      return semantics_ir;
+    }
   }
 
   // Pop information for the file-level scope.
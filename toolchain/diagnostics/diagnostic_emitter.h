@@ -5,7 +5,6 @@
 #ifndef CARBON_TOOLCHAIN_DIAGNOSTICS_DIAGNOSTIC_EMITTER_H_
 #define CARBON_TOOLCHAIN_DIAGNOSTICS_DIAGNOSTIC_EMITTER_H_
 
-#include <functional>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -63,15 +62,18 @@ struct DiagnosticLocation {
 // A message composing a diagnostic. This may be the main message, but can also
 // be notes providing more information.
 struct DiagnosticMessage {
-  explicit DiagnosticMessage(
-      DiagnosticKind kind, DiagnosticLocation location,
-      llvm::StringLiteral format, llvm::SmallVector<llvm::Any> format_args,
-      std::function<std::string(const DiagnosticMessage&)> format_fn)
+  // The signature of `format_fn`.
+  using FormatFnT = auto(const DiagnosticMessage& message) -> std::string;
+
+  explicit DiagnosticMessage(DiagnosticKind kind, DiagnosticLocation location,
+                             llvm::StringLiteral format,
+                             llvm::SmallVector<llvm::Any> format_args,
+                             FormatFnT* format_fn)
       : kind(kind),
         location(location),
         format(format),
         format_args(std::move(format_args)),
-        format_fn(std::move(format_fn)) {}
+        format_fn(format_fn) {}
 
   // The diagnostic's kind.
   DiagnosticKind kind;
@@ -92,7 +94,11 @@ struct DiagnosticMessage {
   llvm::SmallVector<llvm::Any> format_args;
 
   // Returns the formatted string. By default, this uses llvm::formatv.
-  std::function<std::string(const DiagnosticMessage&)> format_fn;
+  //
+  // This is a plain function pointer rather than a `std::function` so that
+  // buffered diagnostics don't carry a type-erased callable each. Formatting
+  // only depends on `format` and `format_args`, so no state is needed.
+  FormatFnT* format_fn;
 };
 
 // An instance of a single error or warning.  Information about the diagnostic
@@ -131,6 +137,12 @@ class DiagnosticConsumer {
 
   // Flushes any buffered input.
   virtual auto Flush() -> void {}
+
+  // Returns true if this consumer, or a consumer it forwards to, will discard
+  // any further errors because an error limit has been reached. Producers of
+  // diagnostics may use this to stop work early. Adaptors that forward to
+  // another consumer should forward this query too.
+  virtual auto HasReachedErrorLimit() const -> bool { return false; }
 };
 
 // An interface that can translate some representation of a location into a
@@ -157,8 +169,9 @@ struct DiagnosticBase {
                                     llvm::StringLiteral format)
       : Kind(kind), Level(level), Format(format) {}
 
-  // Calls formatv with the diagnostic's arguments.
-  auto FormatFn(const DiagnosticMessage& message) const -> std::string {
+  // Calls formatv with the diagnostic's arguments. This is static so that it
+  // can be stored as a `DiagnosticMessage::FormatFnT*`.
+  static auto FormatFn(const DiagnosticMessage& message) -> std::string {
     return FormatFnImpl(message, std::make_index_sequence<sizeof...(Args)>());
   };
 
@@ -175,8 +188,8 @@ struct DiagnosticBase {
   // affects all formatv calls. Consider replacing formatv with a custom call
   // that allows diagnostic-specific formatting.
   template <std::size_t... N>
-  inline auto FormatFnImpl(const DiagnosticMessage& message,
-                           std::index_sequence<N...> /*indices*/) const
+  static auto FormatFnImpl(const DiagnosticMessage& message,
+                           std::index_sequence<N...> /*indices*/)
       -> std::string {
     assert(message.format_args.size() == sizeof...(Args));
     return llvm::formatv(message.format.data(),
@@ -262,9 +275,7 @@ class DiagnosticEmitter {
       return DiagnosticMessage(
           diagnostic_base.Kind, emitter->translator_->GetLocation(location),
           diagnostic_base.Format, std::move(args),
-          [&diagnostic_base](const DiagnosticMessage& message) -> std::string {
-            return diagnostic_base.FormatFn(message);
-          });
+          &Internal::DiagnosticBase<Args...>::FormatFn);
     }
 
     DiagnosticEmitter<LocationT>* emitter_;
@@ -390,6 +401,15 @@ class ErrorTrackingDiagnosticConsumer : public DiagnosticConsumer {
   auto HandleDiagnostic(Diagnostic diagnostic) -> void override {
     seen_error_ |= diagnostic.level == DiagnosticLevel::Error;
     next_consumer_->HandleDiagnostic(std::move(diagnostic));
+    // The error limit can only change when a diagnostic is handled, so cache
+    // it here to keep `reached_error_limit` cheap for hot loops.
+    reached_error_limit_ = next_consumer_->HasReachedErrorLimit();
+  }
+
+  auto Flush() -> void override { next_consumer_->Flush(); }
+
+  auto HasReachedErrorLimit() const -> bool override {
+    return reached_error_limit_;
   }
 
   // Reset whether we've seen an error.
@@ -398,9 +418,69 @@ class ErrorTrackingDiagnosticConsumer : public DiagnosticConsumer {
   // Returns whether we've seen an error since the last reset.
   auto seen_error() const -> bool { return seen_error_; }
 
+  // A non-virtual version of `HasReachedErrorLimit`, as of the last diagnostic.
+  auto reached_error_limit() const -> bool { return reached_error_limit_; }
+
  private:
   DiagnosticConsumer* next_consumer_;
   bool seen_error_ = false;
+  bool reached_error_limit_ = false;
+};
+
+// Diagnostic consumer adaptor that stops forwarding errors once a limit has
+// been reached. This bounds the number of diagnostics that downstream
+// consumers, such as `SortingDiagnosticConsumer`, need to buffer for badly
+// broken inputs. Once the limit is reached, warnings are dropped too, and a
+// single error saying so is forwarded on `Flush`.
+class ErrorLimitDiagnosticConsumer : public DiagnosticConsumer {
+ public:
+  // A `limit` of 0 means there is no limit.
+  explicit ErrorLimitDiagnosticConsumer(DiagnosticConsumer& next_consumer,
+                                        int limit)
+      : next_consumer_(&next_consumer), limit_(limit) {}
+
+  auto HandleDiagnostic(Diagnostic diagnostic) -> void override {
+    if (HasReachedErrorLimit()) {
+      return;
+    }
+    if (diagnostic.level == DiagnosticLevel::Error) {
+      ++error_count_;
+    }
+    // Save the file name for the error about reaching the limit. File names
+    // outlive the diagnostics that refer to them.
+    file_name_ = diagnostic.message.location.file_name;
+    next_consumer_->HandleDiagnostic(std::move(diagnostic));
+  }
+
+  // Flushes the next consumer, followed by an error saying that the limit was
+  // reached, if it was. That error is flushed separately so that a sorting
+  // consumer doesn't move it among the other errors.
+  auto Flush() -> void override {
+    next_consumer_->Flush();
+    if (HasReachedErrorLimit() && !reported_limit_) {
+      CARBON_DIAGNOSTIC(TooManyErrors, Error,
+                        "Reached the limit of {0} errors, stopping.", int);
+      next_consumer_->HandleDiagnostic(
+          {.level = TooManyErrors.Level,
+           .message = DiagnosticMessage(
+               TooManyErrors.Kind, {.file_name = file_name_},
+               TooManyErrors.Format, {llvm::Any(limit_)},
+               &Internal::DiagnosticBase<int>::FormatFn)});
+      reported_limit_ = true;
+      next_consumer_->Flush();
+    }
+  }
+
+  auto HasReachedErrorLimit() const -> bool override {
+    return limit_ > 0 && error_count_ >= limit_;
+  }
+
+ private:
+  DiagnosticConsumer* next_consumer_;
+  int limit_;
+  int error_count_ = 0;
+  bool reported_limit_ = false;
+  llvm::StringRef file_name_;
 };
 
 // An RAII object that denotes a scope in which any diagnostic produced should
@@ -69,5 +69,33 @@ TEST_F(DiagnosticEmitterTest, EmitNote) {
   emitter_.Build(1, TestDiagnostic).Note(2, TestDiagnosticNote).Emit();
 }
 
+TEST(ErrorLimitDiagnosticConsumerTest, StopsAtLimit) {
+  CARBON_DIAGNOSTIC(TestDiagnostic, Error, "simple error");
+  FakeDiagnosticLocationTranslator translator;
+  Testing::MockDiagnosticConsumer consumer;
+  ErrorLimitDiagnosticConsumer limit_consumer(consumer, 2);
+  DiagnosticEmitter<int> emitter(translator, limit_consumer);
+
+  ::testing::InSequence s;
+  EXPECT_CALL(consumer, HandleDiagnostic(IsDiagnostic(
+                            DiagnosticKind::TestDiagnostic,
+                            DiagnosticLevel::Error, 1, 1, "simple error")));
+  EXPECT_CALL(consumer, HandleDiagnostic(IsDiagnostic(
+                            DiagnosticKind::TestDiagnostic,
+                            DiagnosticLevel::Error, 1, 2, "simple error")));
+  EXPECT_CALL(consumer,
+              HandleDiagnostic(IsDiagnostic(
+                  DiagnosticKind::TooManyErrors, DiagnosticLevel::Error, -1,
+                  -1, "Reached the limit of 2 errors, stopping.")));
+  emitter.Emit(1, TestDiagnostic);
+  EXPECT_FALSE(limit_consumer.HasReachedErrorLimit());
+  emitter.Emit(2, TestDiagnostic);
+  EXPECT_TRUE(limit_consumer.HasReachedErrorLimit());
+  emitter.Emit(3, TestDiagnostic);
+  limit_consumer.Flush();
+  // The limit is only reported once.
+  limit_consumer.Flush();
+}
+
 }  // namespace
 }  // namespace Carbon
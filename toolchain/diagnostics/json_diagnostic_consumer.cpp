@@ -0,0 +1,64 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "toolchain/diagnostics/json_diagnostic_consumer.h"
+
+namespace Carbon {
+
+static auto LevelName(DiagnosticLevel level) -> llvm::StringLiteral {
+  switch (level) {
+    case DiagnosticLevel::Note:
+      return "note";
+    case DiagnosticLevel::Warning:
+      return "warning";
+    case DiagnosticLevel::Error:
+      return "error";
+  }
+  llvm_unreachable("All levels handled!");
+}
+
+auto JsonDiagnosticConsumer::HandleDiagnostic(Diagnostic diagnostic) -> void {
+  {
+    llvm::raw_string_ostream out(buffer_);
+    llvm::json::OStream json(out);
+    json.object([&] {
+      json.attribute("level", LevelName(diagnostic.level));
+      PrintMessageFields(json, diagnostic.message);
+      json.attributeArray("notes", [&] {
+        for (const auto& note : diagnostic.notes) {
+          json.object([&] { PrintMessageFields(json, note); });
+        }
+      });
+    });
+  }
+  buffer_ += '\n';
+
+  if (static_cast<int>(buffer_.size()) >= buffer_size_) {
+    Flush();
+  }
+}
+
+auto JsonDiagnosticConsumer::Flush() -> void {
+  if (buffer_.empty()) {
+    return;
+  }
+  *stream_ << buffer_;
+  stream_->flush();
+  buffer_.clear();
+}
+
+auto JsonDiagnosticConsumer::PrintMessageFields(
+    llvm::json::OStream& json, const DiagnosticMessage& message) -> void {
+  json.attribute("kind", message.kind.name());
+  json.attribute("file", message.location.file_name);
+  if (message.location.line_number > 0) {
+    json.attribute("line", message.location.line_number);
+    if (message.location.column_number > 0) {
+      json.attribute("column", message.location.column_number);
+    }
+  }
+  json.attribute("message", message.format_fn(message));
+}
+
+}  // namespace Carbon
@@ -0,0 +1,62 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_TOOLCHAIN_DIAGNOSTICS_JSON_DIAGNOSTIC_CONSUMER_H_
+#define CARBON_TOOLCHAIN_DIAGNOSTICS_JSON_DIAGNOSTIC_CONSUMER_H_
+
+#include <string>
+
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include "toolchain/diagnostics/diagnostic_emitter.h"
+
+namespace Carbon {
+
+// Prints diagnostics as JSON lines: one JSON object per diagnostic, each on its
+// own line. For example:
+//
+// clang-format off
+// ```
+// {"level":"error","kind":"InvalidDigit","file":"a.carbon","line":3,"column":10,"message":"Invalid digit 'a' in decimal numeric literal.","notes":[]}
+// ```
+// clang-format on
+//
+// Notes have the same fields as the diagnostic, other than `level` and
+// `notes`. `line` and `column` are omitted when unknown.
+//
+// Output is buffered and written to the stream in large chunks, because the
+// stream is typically unbuffered stderr and tooling may consume a very large
+// number of diagnostics. Buffered output is written when it exceeds the buffer
+// size, on `Flush`, and on destruction.
+class JsonDiagnosticConsumer : public DiagnosticConsumer {
+ public:
+  static constexpr int DefaultBufferSize = 64 * 1024;
+
+  explicit JsonDiagnosticConsumer(llvm::raw_ostream& stream,
+                                  int buffer_size = DefaultBufferSize)
+      : stream_(&stream), buffer_size_(buffer_size) {}
+
+  // Buffered output is already formatted and doesn't refer to any compilation
+  // state, so unlike `SortingDiagnosticConsumer` it's safe to flush here.
+  ~JsonDiagnosticConsumer() override { Flush(); }
+
+  // Formats the diagnostic into the buffer.
+  auto HandleDiagnostic(Diagnostic diagnostic) -> void override;
+
+  // Writes any buffered output to the stream.
+  auto Flush() -> void override;
+
+ private:
+  // Prints the fields shared by diagnostics and notes.
+  auto PrintMessageFields(llvm::json::OStream& json,
+                          const DiagnosticMessage& message) -> void;
+
+  llvm::raw_ostream* stream_;
+  int buffer_size_;
+  std::string buffer_;
+};
+
+}  // namespace Carbon
+
+#endif  // CARBON_TOOLCHAIN_DIAGNOSTICS_JSON_DIAGNOSTIC_CONSUMER_H_
@@ -0,0 +1,63 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "toolchain/diagnostics/json_diagnostic_consumer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "llvm/ADT/StringRef.h"
+#include "testing/base/test_raw_ostream.h"
+#include "toolchain/diagnostics/diagnostic_emitter.h"
+
+namespace Carbon {
+namespace {
+
+using ::Carbon::Testing::TestRawOstream;
+
+CARBON_DIAGNOSTIC(TestDiagnostic, Error, "M{0}", int);
+CARBON_DIAGNOSTIC(TestDiagnosticNote, Note, "\"quoted\" note");
+
+struct FakeDiagnosticLocationTranslator
+    : DiagnosticLocationTranslator<DiagnosticLocation> {
+  auto GetLocation(DiagnosticLocation loc) -> DiagnosticLocation override {
+    return loc;
+  }
+};
+
+TEST(JsonDiagnosticConsumerTest, PrintsJsonLines) {
+  FakeDiagnosticLocationTranslator translator;
+  TestRawOstream stream;
+  JsonDiagnosticConsumer consumer(stream);
+  DiagnosticEmitter<DiagnosticLocation> emitter(translator, consumer);
+
+  emitter.Emit({"f", "line", 2, 1}, TestDiagnostic, 1);
+  emitter.Build({"f", "line", 3, 4}, TestDiagnostic, 2)
+      .Note({"g", "", -1, -1}, TestDiagnosticNote)
+      .Emit();
+  // Output is buffered until flushed.
+  EXPECT_EQ(stream.TakeStr(), "");
+
+  consumer.Flush();
+  EXPECT_EQ(stream.TakeStr(),
+            "{\"level\":\"error\",\"kind\":\"TestDiagnostic\",\"file\":\"f\","
+            "\"line\":2,\"column\":1,\"message\":\"M1\",\"notes\":[]}\n"
+            "{\"level\":\"error\",\"kind\":\"TestDiagnostic\",\"file\":\"f\","
+            "\"line\":3,\"column\":4,\"message\":\"M2\",\"notes\":["
+            "{\"kind\":\"TestDiagnosticNote\",\"file\":\"g\","
+            "\"message\":\"\\\"quoted\\\" note\"}]}\n");
+}
+
+TEST(JsonDiagnosticConsumerTest, WritesWhenBufferIsFull) {
+  FakeDiagnosticLocationTranslator translator;
+  TestRawOstream stream;
+  JsonDiagnosticConsumer consumer(stream, /*buffer_size=*/1);
+  DiagnosticEmitter<DiagnosticLocation> emitter(translator, consumer);
+
+  emitter.Emit({"f", "line", 1, 1}, TestDiagnostic, 1);
+  EXPECT_THAT(stream.TakeStr(), ::testing::HasSubstr("\"message\":\"M1\""));
+}
+
+}  // namespace
+}  // namespace Carbon
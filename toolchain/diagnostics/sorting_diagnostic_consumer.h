@@ -46,6 +46,10 @@ class SortingDiagnosticConsumer : public DiagnosticConsumer {
     diagnostics_.clear();
   }
 
+  auto HasReachedErrorLimit() const -> bool override {
+    return next_consumer_->HasReachedErrorLimit();
+  }
+
  private:
   // A Diagnostic is undesirably large for inline storage by SmallVector, so we
   // specify 0.
@@ -19,6 +19,7 @@
 #include "toolchain/check/check.h"
 #include "toolchain/codegen/codegen.h"
 #include "toolchain/diagnostics/diagnostic_emitter.h"
+#include "toolchain/diagnostics/json_diagnostic_consumer.h"
 #include "toolchain/diagnostics/sorting_diagnostic_consumer.h"
 #include "toolchain/lex/tokenized_buffer.h"
 #include "toolchain/lower/lower.h"
@@ -52,6 +53,11 @@ can be written to standard output as these phases progress.
     CodeGen,
   };
 
+  enum class DiagnosticFormat : int8_t {
+    Text,
+    Json,
+  };
+
   friend auto operator<<(llvm::raw_ostream& out, Phase phase)
       -> llvm::raw_ostream& {
     switch (phase) {
@@ -170,6 +176,20 @@ of a binary object file instead. Ignored for other `--output` values.
         },
         [&](auto& arg_b) { arg_b.Set(&force_obj_output); });
 
+    b.AddFlag(
+        {
+            .name = "prune-unreachable",
+            .help = R"""(
+Skip lowering and code generation for functions that can't be called from
+outside the file. When the file defines the program's entry point, these are
+the functions that the entry point doesn't use. Enabled by default.
+)""",
+        },
+        [&](auto& arg_b) {
+          arg_b.Default(true);
+          arg_b.Set(&prune_unreachable);
+        });
+
     b.AddFlag(
         {
             .name = "stream-errors",
@@ -180,6 +200,57 @@ and displaying them in source order.
         },
         [&](auto& arg_b) { arg_b.Set(&stream_errors); });
 
+    b.AddOneOfOption(
+        {
+            .name = "diagnostic-format",
+            .help = R"""(
+Selects the format of diagnostics written to the standard error stream.
+
+`text` is human-readable. `json` writes one JSON object per line for each
+diagnostic, with `level`, `kind`, `file`, `line`, `column`, `message` and
+`notes` fields, for consumption by tools.
+)""",
+        },
+        [&](auto& arg_b) {
+          arg_b.SetOneOf(
+              {
+                  arg_b.OneOfValue("text", DiagnosticFormat::Text)
+                      .Default(true),
+                  arg_b.OneOfValue("json", DiagnosticFormat::Json),
+              },
+              &diagnostic_format);
+        });
+
+    b.AddIntegerOption(
+        {
+            .name = "error-limit",
+            .value_name = "N",
+            .help = R"""(
+Stop reporting errors for a file after N errors have been produced for it, and
+stop compiling that file as soon as possible. A value of 0, the default, means
+there is no limit.
+)""",
+        },
+        [&](auto& arg_b) {
+          arg_b.Default(0);
+          arg_b.Set(&error_limit);
+        });
+
+    b.AddIntegerOption(
+        {
+            .name = "parse-threads",
+            .value_name = "N",
+            .help = R"""(
+Parse the top-level declarations of a large file on up to N threads. Files with
+parse errors are parsed again on one thread so that errors are reported in
+order. The default is 1.
+)""",
+        },
+        [&](auto& arg_b) {
+          arg_b.Default(1);
+          arg_b.Set(&parse_threads);
+        });
+
     b.AddFlag(
         {
             .name = "dump-tokens",
@@ -257,6 +328,7 @@ Dump the generated assembly to stdout after codegen.
 
   bool asm_output = false;
   bool force_obj_output = false;
+  bool prune_unreachable = true;
   bool dump_tokens = false;
   bool dump_parse_tree = false;
   bool dump_raw_sem_ir = false;
@@ -264,6 +336,9 @@ Dump the generated assembly to stdout after codegen.
   bool dump_llvm_ir = false;
   bool dump_asm = false;
   bool stream_errors = false;
+  DiagnosticFormat diagnostic_format;
+  int error_limit = 0;
+  int parse_threads = 1;
   bool preorder_parse_tree = false;
   bool builtin_sem_ir = false;
 };
@@ -390,12 +465,23 @@ class Driver::CompilationUnit {
         input_file_name_(input_file_name),
         vlog_stream_(driver_->vlog_stream_),
         stream_consumer_(driver_->error_stream_) {
+    DiagnosticConsumer* output_consumer = &stream_consumer_;
+    if (options_.diagnostic_format == CompileOptions::DiagnosticFormat::Json) {
+      json_consumer_.emplace(driver_->error_stream_);
+      output_consumer = &*json_consumer_;
+    }
     if (vlog_stream_ != nullptr || options_.stream_errors) {
-      consumer_ = &stream_consumer_;
+      consumer_ = output_consumer;
     } else {
-      sorting_consumer_ = SortingDiagnosticConsumer(stream_consumer_);
+      sorting_consumer_ = SortingDiagnosticConsumer(*output_consumer);
       consumer_ = &*sorting_consumer_;
     }
+    // The limit is applied before sorting so that dropped diagnostics are never
+    // buffered.
+    if (options_.error_limit > 0) {
+      error_limit_consumer_.emplace(*consumer_, options_.error_limit);
+      consumer_ = &*error_limit_consumer_;
+    }
   }
 
   // Loads source and lexes it. Returns true on success.
@@ -427,9 +513,15 @@ class Driver::CompilationUnit {
       return false;
     }
     CARBON_CHECK(tokens_);
+    if (consumer_->HasReachedErrorLimit()) {
+      CARBON_VLOG() << "*** Skipping Parse::Tree::Parse: error limit reached "
+                       "***\n";
+      return false;
+    }
 
     LogCall("Parse::Tree::Parse", [&] {
-      parse_tree_ = Parse::Tree::Parse(*tokens_, *consumer_, vlog_stream_);
+      parse_tree_ = Parse::Tree::Parse(*tokens_, *consumer_, vlog_stream_,
+                                       options_.parse_threads);
     });
     if (options_.dump_parse_tree) {
       consumer_->Flush();
@@ -441,11 +533,17 @@ class Driver::CompilationUnit {
 
   // Check the parse tree and produce SemIR. Returns true on success.
   auto RunCheck(const SemIR::File& builtins) -> bool {
-    // Can be called when the file fails to load, so ensure there's source.
-    if (!source_) {
+    // Can be called when the file fails to load or parsing was skipped, so
+    // ensure there's a parse tree.
+    if (!parse_tree_) {
+      return false;
+    }
+    if (consumer_->HasReachedErrorLimit()) {
+      CARBON_VLOG() << "*** Skipping Check::CheckParseTree: error limit reached "
+                       "***\n";
+      consumer_->Flush();
       return false;
     }
-    CARBON_CHECK(parse_tree_);
 
     LogCall("Check::CheckParseTree", [&] {
       sem_ir_ = Check::CheckParseTree(builtins, *tokens_, *parse_tree_,
@@ -483,7 +581,7 @@ class Driver::CompilationUnit {
     LogCall("Lower::LowerToLLVM", [&] {
       llvm_context_ = std::make_unique<llvm::LLVMContext>();
       module_ = Lower::LowerToLLVM(*llvm_context_, input_file_name_, *sem_ir_,
-                                   vlog_stream_);
+                                   options_.prune_unreachable, vlog_stream_);
     });
     if (vlog_stream_) {
       CARBON_VLOG() << "*** llvm::Module ***\n";
@@ -558,7 +656,12 @@ class Driver::CompilationUnit {
   }
 
   // Flushes output.
-  auto Flush() -> void { consumer_->Flush(); }
+  auto Flush() -> void {
+    consumer_->Flush();
+    if (json_consumer_) {
+      json_consumer_->Flush();
+    }
+  }
 
  private:
   // Wraps a call with log statements to indicate start and end.
@@ -576,9 +679,12 @@ class Driver::CompilationUnit {
   // Copied from driver_ for CARBON_VLOG.
   llvm::raw_pwrite_stream* vlog_stream_;
 
-  // Diagnostics are sent to consumer_, with optional sorting.
+  // Diagnostics are sent to consumer_, with optional error limiting and
+  // sorting, and printed by either stream_consumer_ or json_consumer_.
   StreamDiagnosticConsumer stream_consumer_;
+  std::optional<JsonDiagnosticConsumer> json_consumer_;
   std::optional<SortingDiagnosticConsumer> sorting_consumer_;
+  std::optional<ErrorLimitDiagnosticConsumer> error_limit_consumer_;
   DiagnosticConsumer* consumer_;
 
   // These are initialized as steps are run.
@@ -54,7 +54,7 @@ inline auto IsLower(char c) -> bool { return 'a' <= c && c <= 'z'; }
 // Is this character considered to be horizontal whitespace?
 //
 // Such characters can appear in the indentation of a line.
-inline auto IsHorizontalWhitespace(char c) -> bool {
+constexpr auto IsHorizontalWhitespace(char c) -> bool {
   return c == ' ' || c == '\t';
 }
 
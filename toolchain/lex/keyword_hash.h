@@ -0,0 +1,142 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_TOOLCHAIN_LEX_KEYWORD_HASH_H_
+#define CARBON_TOOLCHAIN_LEX_KEYWORD_HASH_H_
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/StringRef.h"
+#include "toolchain/lex/token_kind.h"
+
+namespace Carbon::Lex {
+
+// Hashes the text of a word: a keyword or an identifier. The lexer hashes each
+// word once, and uses the hash both to recognize keywords and to find the
+// word in the identifier table.
+//
+// This is FNV-1a followed by a finalizer that mixes the high bits into the low
+// bits, because hash tables use the low bits to pick a bucket.
+constexpr auto HashWord(std::string_view text) -> uint64_t {
+  uint64_t hash = 0xcbf2'9ce4'8422'2325;
+  for (char c : text) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100'0000'01b3;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51'afd7'ed55'8ccd;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+// The text of a word along with its `HashWord` hash, so that hash tables keyed
+// on words don't need to hash them again.
+struct HashedWord {
+  llvm::StringRef text;
+  uint64_t hash;
+};
+
+namespace Internal {
+
+struct KeywordSpelling {
+  std::string_view spelling;
+  TokenKind kind;
+};
+
+inline constexpr KeywordSpelling KeywordSpellings[] = {
+#define CARBON_KEYWORD_TOKEN(TokenName, Spelling) \
+  {Spelling, TokenKind::TokenName},
+#include "toolchain/lex/token_kind.def"
+};
+
+// The keyword table has many more slots than there are keywords, so that a
+// perfect hash is quick to find. Its entries are a single byte, so the table
+// is still only 1 KiB.
+inline constexpr int KeywordTableBits = 10;
+
+constexpr auto KeywordTableIndex(uint64_t hash, uint64_t multiplier)
+    -> size_t {
+  return (hash * multiplier) >> (64 - KeywordTableBits);
+}
+
+// Finds a multiplier for which each keyword has its own slot in the keyword
+// table, or returns 0 if there isn't one.
+constexpr auto FindKeywordTableMultiplier() -> uint64_t {
+  std::array<uint64_t, std::size(KeywordSpellings)> hashes = {};
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    hashes[i] = HashWord(KeywordSpellings[i].spelling);
+  }
+  for (uint64_t attempt = 1; attempt <= 1000; ++attempt) {
+    uint64_t multiplier = (attempt * 0x9e37'79b9'7f4a'7c15) | 1;
+    std::array<bool, 1 << KeywordTableBits> used = {};
+    bool collision = false;
+    for (uint64_t hash : hashes) {
+      bool& slot = used[KeywordTableIndex(hash, multiplier)];
+      if (slot) {
+        collision = true;
+        break;
+      }
+      slot = true;
+    }
+    if (!collision) {
+      return multiplier;
+    }
+  }
+  return 0;
+}
+
+inline constexpr uint64_t KeywordTableMultiplier = FindKeywordTableMultiplier();
+static_assert(KeywordTableMultiplier != 0,
+              "No perfect hash found for the keywords; increase "
+              "KeywordTableBits.");
+
+// Maps each slot to the keyword whose hash selects it, or to `Error`.
+inline constexpr auto KeywordTable = [] {
+  std::array<TokenKind, 1 << KeywordTableBits> table = {};
+  table.fill(TokenKind::Error);
+  for (const auto& keyword : KeywordSpellings) {
+    table[KeywordTableIndex(HashWord(keyword.spelling),
+                            KeywordTableMultiplier)] = keyword.kind;
+  }
+  return table;
+}();
+
+}  // namespace Internal
+
+// Returns the keyword spelled `word`, or `Error` if it isn't a keyword. Each
+// possible hash selects at most one keyword, so this needs a single
+// comparison.
+inline auto LookupKeyword(HashedWord word) -> TokenKind {
+  TokenKind kind = Internal::KeywordTable[Internal::KeywordTableIndex(
+      word.hash, Internal::KeywordTableMultiplier)];
+  if (kind != TokenKind::Error && kind.fixed_spelling() == word.text) {
+    return kind;
+  }
+  return TokenKind::Error;
+}
+
+}  // namespace Carbon::Lex
+
+// Support use of HashedWord as a DenseMap key, reusing its hash.
+template <>
+struct llvm::DenseMapInfo<Carbon::Lex::HashedWord> {
+  using Base = llvm::DenseMapInfo<llvm::StringRef>;
+  using HashedWord = Carbon::Lex::HashedWord;
+  static inline auto getEmptyKey() -> HashedWord {
+    return {.text = Base::getEmptyKey(), .hash = 0};
+  }
+  static inline auto getTombstoneKey() -> HashedWord {
+    return {.text = Base::getTombstoneKey(), .hash = 0};
+  }
+  static inline auto getHashValue(const HashedWord& word) -> unsigned {
+    return static_cast<unsigned>(word.hash);
+  }
+  static auto isEqual(const HashedWord& a, const HashedWord& b) -> bool {
+    return a.hash == b.hash && Base::isEqual(a.text, b.text);
+  }
+};
+
+#endif  // CARBON_TOOLCHAIN_LEX_KEYWORD_HASH_H_
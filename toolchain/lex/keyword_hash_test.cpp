@@ -0,0 +1,46 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "toolchain/lex/keyword_hash.h"
+
+#include <gtest/gtest.h>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "toolchain/lex/token_kind.h"
+
+namespace Carbon::Lex {
+namespace {
+
+auto Hashed(llvm::StringRef text) -> HashedWord {
+  return {.text = text, .hash = HashWord(text)};
+}
+
+TEST(KeywordHashTest, FindsKeywords) {
+  for (TokenKind kind : TokenKind::KeywordTokens) {
+    EXPECT_EQ(LookupKeyword(Hashed(kind.fixed_spelling())), kind)
+        << kind.fixed_spelling();
+  }
+}
+
+TEST(KeywordHashTest, RejectsOtherWords) {
+  for (llvm::StringRef word :
+       {"abstrac", "abstracts", "Abstract", "self_", "Self2", "x", "__", "i32",
+        "u8", "f64", "identifier"}) {
+    EXPECT_EQ(LookupKeyword(Hashed(word)), TokenKind::Error) << word;
+  }
+}
+
+TEST(KeywordHashTest, IdentifierMap) {
+  llvm::DenseMap<HashedWord, int> map;
+  map.insert({Hashed("foo"), 1});
+  map.insert({Hashed("bar"), 2});
+  EXPECT_FALSE(map.insert({Hashed("foo"), 3}).second);
+  EXPECT_EQ(map.lookup(Hashed("foo")), 1);
+  EXPECT_EQ(map.lookup(Hashed("bar")), 2);
+  EXPECT_EQ(map.count(Hashed("baz")), 0);
+}
+
+}  // namespace
+}  // namespace Carbon::Lex
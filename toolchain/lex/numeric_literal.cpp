@@ -5,9 +5,11 @@
 #include "toolchain/lex/numeric_literal.h"
 
 #include <bitset>
+#include <cstring>
 
 #include "common/check.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Endian.h"
 #include "toolchain/lex/character_set.h"
 #include "toolchain/lex/helpers.h"
 
@@ -461,4 +463,88 @@ auto NumericLiteral::ComputeValue(DiagnosticEmitter<const char*>& emitter) const
       .exponent = parser.GetExponent()};
 }
 
+// Parses up to eight decimal digits at once. The digits are loaded into the
+// bytes of a 64-bit word, most significant first, and adjacent pairs of bytes,
+// then 16-bit and 32-bit lanes, are combined with a multiply and shift each.
+// Returns `std::nullopt` if any of the characters isn't a decimal digit.
+static auto ParseDecimalDigitsSWAR(llvm::StringRef digits)
+    -> std::optional<uint32_t> {
+  CARBON_DCHECK(digits.size() <= 8) << "Too many digits: " << digits;
+
+  // Left-pad with '0's to fill the word.
+  char bytes[8];
+  std::memset(bytes, '0', 8 - digits.size());
+  std::memcpy(bytes + 8 - digits.size(), digits.data(), digits.size());
+  uint64_t word = llvm::support::endian::read64le(bytes);
+
+  // A byte is a decimal digit if its high nibble is 3, and still is after
+  // adding 6.
+  constexpr uint64_t HighNibbles = 0xF0F0'F0F0'F0F0'F0F0;
+  if (((word & HighNibbles) |
+       (((word + 0x0606'0606'0606'0606) & HighNibbles) >> 4)) !=
+      0x3333'3333'3333'3333) {
+    return std::nullopt;
+  }
+
+  word = ((word & 0x0F0F'0F0F'0F0F'0F0F) * (10 * 0x100 + 1)) >> 8;
+  word = ((word & 0x00FF'00FF'00FF'00FF) * (100 * 0x1'0000 + 1)) >> 16;
+  return ((word & 0x0000'FFFF'0000'FFFF) * (10000 * 0x1'0000'0000 + 1)) >> 32;
+}
+
+auto NumericLiteral::ComputeSmallIntegerValue() const
+    -> std::optional<uint32_t> {
+  if (radix_point_ != static_cast<int>(text_.size())) {
+    return std::nullopt;
+  }
+
+  llvm::StringRef digits = text_;
+  if (digits.consume_front("0x")) {
+    if (digits.empty() || digits.size() > 8) {
+      return std::nullopt;
+    }
+    uint32_t value = 0;
+    for (char c : digits) {
+      // Lowercase hexadecimal digits are invalid.
+      if (!IsDecimalDigit(c) && !(c >= 'A' && c <= 'F')) {
+        return std::nullopt;
+      }
+      value = (value << 4) | llvm::hexDigitValue(c);
+    }
+    return value;
+  }
+
+  if (digits.consume_front("0b")) {
+    if (digits.empty() || digits.size() > 32) {
+      return std::nullopt;
+    }
+    uint32_t value = 0;
+    for (char c : digits) {
+      if (c != '0' && c != '1') {
+        return std::nullopt;
+      }
+      value = (value << 1) | (c - '0');
+    }
+    return value;
+  }
+
+  // Any nine-digit decimal number fits in 32 bits. A leading zero is only
+  // valid for `0` itself.
+  if (digits.size() > 9 || (digits.size() > 1 && digits.front() == '0')) {
+    return std::nullopt;
+  }
+  uint32_t high_digit = 0;
+  if (digits.size() == 9) {
+    if (!IsDecimalDigit(digits.front())) {
+      return std::nullopt;
+    }
+    high_digit = digits.front() - '0';
+    digits = digits.drop_front();
+  }
+  auto low_digits = ParseDecimalDigitsSWAR(digits);
+  if (!low_digits) {
+    return std::nullopt;
+  }
+  return high_digit * 100'000'000 + *low_digits;
+}
+
 }  // namespace Carbon::Lex
@@ -48,6 +48,12 @@ class NumericLiteral {
   // emitter if the token is not valid.
   auto ComputeValue(DiagnosticEmitter<const char*>& emitter) const -> Value;
 
+  // Compute the value of the token without allocating, if it's a valid integer
+  // literal with no digit separators whose value fits in 32 bits, which covers
+  // almost all integer literals. Otherwise returns `std::nullopt`, and
+  // `ComputeValue` should be used instead.
+  auto ComputeSmallIntegerValue() const -> std::optional<uint32_t>;
+
   // Get the text corresponding to this literal.
   [[nodiscard]] auto text() const -> llvm::StringRef { return text_; }
 
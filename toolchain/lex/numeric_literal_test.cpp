@@ -7,7 +7,11 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <string>
+
 #include "common/check.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/StringExtras.h"
 #include "toolchain/diagnostics/diagnostic_emitter.h"
 #include "toolchain/lex/test_helpers.h"
 
@@ -100,6 +104,39 @@ TEST_F(NumericLiteralTest, HandlesIntegerLiteral) {
   }
 }
 
+TEST_F(NumericLiteralTest, ComputesSmallIntegerValue) {
+  // The fast path should agree with `ComputeValue` for every value it handles,
+  // in each radix.
+  for (uint64_t value :
+       {0ULL, 1ULL, 9ULL, 10ULL, 99ULL, 100ULL, 12345678ULL, 99999999ULL,
+        100000000ULL, 123456789ULL, 999999999ULL, 0xFFFF'FFFFULL}) {
+    for (std::string text :
+         {llvm::utostr(value), "0x" + llvm::utohexstr(value),
+          "0b" + llvm::toString(llvm::APInt(64, value), 2, false)}) {
+      if (text.size() > 9 && llvm::all_of(text, llvm::isDigit)) {
+        // Decimal literals with ten digits are left to `ComputeValue`.
+        EXPECT_EQ(Lex(text).ComputeSmallIntegerValue(), std::nullopt) << text;
+        continue;
+      }
+      EXPECT_EQ(Lex(text).ComputeSmallIntegerValue(), value) << text;
+      EXPECT_THAT(Parse(text), HasIntValue(IsUnsignedInteger(value))) << text;
+    }
+  }
+
+  // Anything else, valid or not, is left to `ComputeValue`.
+  llvm::StringLiteral not_small[] = {
+      "1_234",       "0x1_0000",  "0b1_0",         "00",
+      "0x12ab",      "0x",        "0b",            "0b102",
+      "1234567890",  "123456789A", "0x1_2345_6789", "0x123456789",
+      "1.5",         "0x1.8p1",   "12e",
+      "0b111111111111111111111111111111111",
+  };
+  for (llvm::StringLiteral literal : not_small) {
+    EXPECT_EQ(Lex(literal).ComputeSmallIntegerValue(), std::nullopt)
+        << literal;
+  }
+}
+
 TEST_F(NumericLiteralTest, ValidatesBaseSpecifier) {
   llvm::StringLiteral valid[] = {
       // Decimal integer literals.
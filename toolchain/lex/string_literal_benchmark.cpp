@@ -4,6 +4,9 @@
 
 #include <benchmark/benchmark.h>
 
+#include <string>
+#include <string_view>
+
 #include "toolchain/diagnostics/null_diagnostics.h"
 #include "toolchain/lex/string_literal.h"
 
@@ -114,5 +117,73 @@ BENCHMARK(BM_SimpleStringValue_Multiline);
 BENCHMARK(BM_SimpleStringValue_MultilineDoubleQuote);
 BENCHMARK(BM_SimpleStringValue_Raw);
 
+// Builds a long literal with an escape sequence every `escape_interval`
+// characters, similar to embedded data in generated code.
+static auto MakeLongStringWithEscapes(std::string_view introducer,
+                                      std::string_view escape,
+                                      std::string_view terminator,
+                                      int escape_interval) -> std::string {
+  std::string x(introducer);
+  while (x.size() < 1000000) {
+    x.append(escape_interval, 'a');
+    x.append(escape);
+    x.append("n");
+  }
+  x.append(terminator);
+  return x;
+}
+
+static void BM_LongStringWithEscapes(benchmark::State& state,
+                                     std::string_view introducer,
+                                     std::string_view escape,
+                                     std::string_view terminator) {
+  std::string x = MakeLongStringWithEscapes(introducer, escape, terminator,
+                                            state.range(0));
+  for (auto _ : state) {
+    StringLiteral::Lex(x);
+  }
+  state.SetBytesProcessed(state.iterations() * x.size());
+}
+
+static void BM_LongStringWithEscapes_Simple(benchmark::State& state) {
+  BM_LongStringWithEscapes(state, "\"", "\\", "\"");
+}
+
+static void BM_LongStringWithEscapes_Raw(benchmark::State& state) {
+  BM_LongStringWithEscapes(state, "#\"", "\\#", "\"#");
+}
+
+BENCHMARK(BM_LongStringWithEscapes_Simple)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_LongStringWithEscapes_Raw)->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_LongStringWithEscapesValue(benchmark::State& state) {
+  std::string x =
+      MakeLongStringWithEscapes("\"", "\\", "\"", state.range(0));
+  for (auto _ : state) {
+    StringLiteral::Lex(x)->ComputeValue(NullDiagnosticEmitter<const char*>());
+  }
+  state.SetBytesProcessed(state.iterations() * x.size());
+}
+
+BENCHMARK(BM_LongStringWithEscapesValue)->Arg(16)->Arg(256)->Arg(4096);
+
+// Benchmarks a long multi-line block literal whose indented lines each have
+// `state.range(0)` characters of content.
+static void BM_LongMultilineValue(benchmark::State& state) {
+  std::string x("'''\n");
+  while (x.size() < 1000000) {
+    x.append("    ");
+    x.append(state.range(0), 'a');
+    x.append("\n");
+  }
+  x.append("    '''");
+  for (auto _ : state) {
+    StringLiteral::Lex(x)->ComputeValue(NullDiagnosticEmitter<const char*>());
+  }
+  state.SetBytesProcessed(state.iterations() * x.size());
+}
+
+BENCHMARK(BM_LongMultilineValue)->Arg(20)->Arg(80)->Arg(1000);
+
 }  // namespace
 }  // namespace Carbon::Lex
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
 
 #include "common/check.h"
 #include "common/string_helpers.h"
@@ -242,8 +243,9 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     bool formed_token_;
   };
 
-  Lexer(TokenizedBuffer& buffer, DiagnosticConsumer& consumer)
+  Lexer(TokenizedBuffer& buffer, ErrorTrackingDiagnosticConsumer& consumer)
       : buffer_(&buffer),
+        consumer_(&consumer),
         translator_(&buffer),
         emitter_(translator_, consumer),
         token_translator_(&buffer),
@@ -266,6 +268,9 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     // baseline performance target when adding those features.
     const char* const text = source_text.data();
     const ssize_t size = source_text.size();
+    CARBON_CHECK(size <= std::numeric_limits<int32_t>::max())
+        << "Source buffers are limited to 2 GiB, as tokens store 32-bit "
+           "offsets.";
     ssize_t start = 0;
     while (const char* nl = reinterpret_cast<const char*>(
                memchr(&text[start], '\n', size - start))) {
@@ -293,6 +298,11 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     set_indent_ = false;
   }
 
+  // Returns the byte offset in the source buffer of the current position.
+  auto current_byte_offset() const -> int32_t {
+    return current_line_info_->start + current_column_;
+  }
+
   auto NoteWhitespace() -> void {
     buffer_->token_infos_.back().has_trailing_space = true;
   }
@@ -309,6 +319,13 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     NoteWhitespace();
     source_text = source_text.drop_front();
     HandleNewline();
+
+    // Once the error limit is reached, further diagnostics would be discarded,
+    // so stop lexing as if the file ended here. This is checked once per line
+    // rather than once per token to keep it off the hottest path.
+    if (LLVM_UNLIKELY(consumer_->reached_error_limit())) {
+      source_text = llvm::StringRef();
+    }
   }
 
   auto LexCommentOrSlash(llvm::StringRef& source_text) -> void {
@@ -367,6 +384,7 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     }
 
     int int_column = current_column_;
+    int32_t byte_offset = current_byte_offset();
     int token_size = literal->text().size();
     current_column_ += token_size;
     source_text = source_text.drop_front(token_size);
@@ -376,23 +394,37 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
       set_indent_ = true;
     }
 
+    auto add_integer_literal = [&](llvm::APInt value) {
+      auto token =
+          buffer_->AddToken({.kind = TokenKind::IntegerLiteral}, byte_offset);
+      auto& token_info = buffer_->GetTokenInfo(token);
+      if (value.ult(TokenInfo::InlineIntegerLimit)) {
+        token_info.set_payload(value.getZExtValue());
+      } else {
+        token_info.set_payload(TokenInfo::InlineIntegerLimit +
+                               buffer_->literal_int_storage_.size());
+        buffer_->literal_int_storage_.push_back(std::move(value));
+      }
+      return token;
+    };
+
+    // Most integer literals are small, so try to compute the value without
+    // building an `APInt` from the digits first. Those below
+    // `InlineIntegerLimit` are then stored in the token.
+    if (auto value = literal->ComputeSmallIntegerValue()) {
+      return add_integer_literal(llvm::APInt(32, *value));
+    }
+
     return VariantMatch(
         literal->ComputeValue(emitter_),
         [&](NumericLiteral::IntegerValue&& value) {
-          auto token = buffer_->AddToken({.kind = TokenKind::IntegerLiteral,
-                                          .token_line = current_line_,
-                                          .column = int_column});
-          buffer_->GetTokenInfo(token).literal_index =
-              buffer_->literal_int_storage_.size();
-          buffer_->literal_int_storage_.push_back(std::move(value.value));
-          return token;
+          return add_integer_literal(std::move(value.value));
         },
         [&](NumericLiteral::RealValue&& value) {
-          auto token = buffer_->AddToken({.kind = TokenKind::RealLiteral,
-                                          .token_line = current_line_,
-                                          .column = int_column});
-          buffer_->GetTokenInfo(token).literal_index =
-              buffer_->literal_int_storage_.size();
+          auto token =
+              buffer_->AddToken({.kind = TokenKind::RealLiteral}, byte_offset);
+          buffer_->GetTokenInfo(token).set_payload(
+              buffer_->literal_int_storage_.size());
           buffer_->literal_int_storage_.push_back(std::move(value.mantissa));
           buffer_->literal_int_storage_.push_back(std::move(value.exponent));
           CARBON_CHECK(buffer_->GetRealLiteral(token).is_decimal ==
@@ -400,12 +432,9 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
           return token;
         },
         [&](NumericLiteral::UnrecoverableError) {
-          auto token = buffer_->AddToken({
-              .kind = TokenKind::Error,
-              .token_line = current_line_,
-              .column = int_column,
-              .error_length = token_size,
-          });
+          auto token =
+              buffer_->AddToken({.kind = TokenKind::Error}, byte_offset);
+          buffer_->GetTokenInfo(token).set_payload(token_size);
           return token;
         });
   }
@@ -416,8 +445,8 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
       return LexError(source_text);
     }
 
-    Line string_line = current_line_;
     int string_column = current_column_;
+    int32_t byte_offset = current_byte_offset();
     int literal_size = literal->text().size();
     source_text = source_text.drop_front(literal_size);
 
@@ -445,11 +474,9 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
 
     if (literal->is_terminated()) {
       auto token =
-          buffer_->AddToken({.kind = TokenKind::StringLiteral,
-                             .token_line = string_line,
-                             .column = string_column,
-                             .literal_index = static_cast<int32_t>(
-                                 buffer_->literal_string_storage_.size())});
+          buffer_->AddToken({.kind = TokenKind::StringLiteral}, byte_offset);
+      buffer_->GetTokenInfo(token).set_payload(
+          buffer_->literal_string_storage_.size());
       buffer_->literal_string_storage_.push_back(
           literal->ComputeValue(emitter_));
       return token;
@@ -457,10 +484,9 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
       CARBON_DIAGNOSTIC(UnterminatedString, Error,
                         "String is missing a terminator.");
       emitter_.Emit(literal->text().begin(), UnterminatedString);
-      return buffer_->AddToken({.kind = TokenKind::Error,
-                                .token_line = string_line,
-                                .column = string_column,
-                                .error_length = literal_size});
+      auto token = buffer_->AddToken({.kind = TokenKind::Error}, byte_offset);
+      buffer_->GetTokenInfo(token).set_payload(literal_size);
+      return token;
     }
   }
 
@@ -498,8 +524,7 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     CloseInvalidOpenGroups(kind);
 
     const char* location = source_text.begin();
-    Token token = buffer_->AddToken(
-        {.kind = kind, .token_line = current_line_, .column = current_column_});
+    Token token = buffer_->AddToken({.kind = kind}, current_byte_offset());
     current_column_ += kind.fixed_spelling().size();
     source_text = source_text.drop_front(kind.fixed_spelling().size());
 
@@ -520,7 +545,7 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     // a closing symbol.
     if (open_groups_.empty()) {
       closing_token_info.kind = TokenKind::Error;
-      closing_token_info.error_length = kind.fixed_spelling().size();
+      closing_token_info.set_payload(kind.fixed_spelling().size());
 
       CARBON_DIAGNOSTIC(
           UnmatchedClosing, Error,
@@ -533,14 +558,14 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     // Finally can handle a normal closing symbol.
     Token opening_token = open_groups_.pop_back_val();
     TokenInfo& opening_token_info = buffer_->GetTokenInfo(opening_token);
-    opening_token_info.closing_token = token;
-    closing_token_info.opening_token = opening_token;
+    opening_token_info.payload = token.index;
+    closing_token_info.payload = opening_token.index;
     return token;
   }
 
   // Given a word that has already been lexed, determine whether it is a type
   // literal and if so form the corresponding token.
-  auto LexWordAsTypeLiteralToken(llvm::StringRef word, int column)
+  auto LexWordAsTypeLiteralToken(llvm::StringRef word, int32_t byte_offset)
       -> LexResult {
     if (word.size() < 2) {
       // Too short to form one of these tokens.
@@ -568,21 +593,18 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
 
     llvm::StringRef suffix = word.substr(1);
     if (!CanLexInteger(emitter_, suffix)) {
-      return buffer_->AddToken(
-          {.kind = TokenKind::Error,
-           .token_line = current_line_,
-           .column = column,
-           .error_length = static_cast<int32_t>(word.size())});
+      auto token = buffer_->AddToken({.kind = TokenKind::Error}, byte_offset);
+      buffer_->GetTokenInfo(token).set_payload(word.size());
+      return token;
     }
     llvm::APInt suffix_value;
     if (suffix.getAsInteger(10, suffix_value)) {
       return LexResult::NoMatch();
     }
 
-    auto token = buffer_->AddToken(
-        {.kind = *kind, .token_line = current_line_, .column = column});
-    buffer_->GetTokenInfo(token).literal_index =
-        buffer_->literal_int_storage_.size();
+    auto token = buffer_->AddToken({.kind = *kind}, byte_offset);
+    buffer_->GetTokenInfo(token).set_payload(
+        buffer_->literal_int_storage_.size());
     buffer_->literal_int_storage_.push_back(std::move(suffix_value));
     return token;
   }
@@ -636,21 +658,20 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
       Token closing_token = buffer_->AddToken(
           {.kind = opening_kind.closing_symbol(),
            .has_trailing_space = buffer_->HasTrailingWhitespace(prev_token),
-           .is_recovery = true,
-           .token_line = current_line_,
-           .column = current_column_});
+           .is_recovery = true},
+          current_byte_offset());
       TokenInfo& opening_token_info = buffer_->GetTokenInfo(opening_token);
       TokenInfo& closing_token_info = buffer_->GetTokenInfo(closing_token);
-      opening_token_info.closing_token = closing_token;
-      closing_token_info.opening_token = opening_token;
+      opening_token_info.payload = closing_token.index;
+      closing_token_info.payload = opening_token.index;
     } while (!open_groups_.empty());
   }
 
-  auto GetOrCreateIdentifier(llvm::StringRef text) -> Identifier {
+  auto GetOrCreateIdentifier(HashedWord word) -> Identifier {
     auto insert_result = buffer_->identifier_map_.insert(
-        {text, Identifier(buffer_->identifier_infos_.size())});
+        {word, Identifier(buffer_->identifier_infos_.size())});
     if (insert_result.second) {
-      buffer_->identifier_infos_.push_back({text});
+      buffer_->identifier_infos_.push_back({word.text});
     }
     return insert_result.first->second;
   }
@@ -671,32 +692,33 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     llvm::StringRef identifier_text = ScanForIdentifierPrefix(source_text);
     CARBON_CHECK(!identifier_text.empty())
         << "Must have at least one character!";
-    int identifier_column = current_column_;
+    int32_t byte_offset = current_byte_offset();
     current_column_ += identifier_text.size();
     source_text = source_text.drop_front(identifier_text.size());
 
-    // Check if the text is a type literal, and if so form such a literal.
+    // Check if the text is a type literal, and if so form such a literal. This
+    // only needs to look at the first two characters to reject other words.
     if (LexResult result =
-            LexWordAsTypeLiteralToken(identifier_text, identifier_column)) {
+            LexWordAsTypeLiteralToken(identifier_text, byte_offset)) {
       return result;
     }
 
+    // Hash the word once, and use that hash both to check whether it's a
+    // keyword and to find it in the identifier table.
+    HashedWord word = {.text = identifier_text,
+                       .hash = HashWord(identifier_text)};
+
     // Check if the text matches a keyword token, and if so use that.
-    TokenKind kind = llvm::StringSwitch<TokenKind>(identifier_text)
-#define CARBON_KEYWORD_TOKEN(Name, Spelling) .Case(Spelling, TokenKind::Name)
-#include "toolchain/lex/token_kind.def"
-                         .Default(TokenKind::Error);
+    TokenKind kind = LookupKeyword(word);
     if (kind != TokenKind::Error) {
-      return buffer_->AddToken({.kind = kind,
-                                .token_line = current_line_,
-                                .column = identifier_column});
+      return buffer_->AddToken({.kind = kind}, byte_offset);
     }
 
     // Otherwise we have a generic identifier.
-    return buffer_->AddToken({.kind = TokenKind::Identifier,
-                              .token_line = current_line_,
-                              .column = identifier_column,
-                              .id = GetOrCreateIdentifier(identifier_text)});
+    return buffer_->AddToken(
+        {.kind = TokenKind::Identifier,
+         .payload = static_cast<uint32_t>(GetOrCreateIdentifier(word).index)},
+        byte_offset);
   }
 
   auto LexError(llvm::StringRef& source_text) -> LexResult {
@@ -723,11 +745,9 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
       error_text = source_text.take_front(1);
     }
 
-    auto token = buffer_->AddToken(
-        {.kind = TokenKind::Error,
-         .token_line = current_line_,
-         .column = current_column_,
-         .error_length = static_cast<int32_t>(error_text.size())});
+    auto token =
+        buffer_->AddToken({.kind = TokenKind::Error}, current_byte_offset());
+    buffer_->GetTokenInfo(token).set_payload(error_text.size());
     CARBON_DIAGNOSTIC(UnrecognizedCharacters, Error,
                       "Encountered unrecognized characters while parsing.");
     emitter_.Emit(error_text.begin(), UnrecognizedCharacters);
@@ -741,10 +761,9 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     // Before lexing any source text, add the start-of-file token so that code
     // can assume a non-empty token buffer for the rest of lexing. Note that the
     // start-of-file always has trailing space because it *is* whitespace.
-    buffer_->AddToken({.kind = TokenKind::StartOfFile,
-                       .has_trailing_space = true,
-                       .token_line = current_line_,
-                       .column = current_column_});
+    buffer_->AddToken(
+        {.kind = TokenKind::StartOfFile, .has_trailing_space = true},
+        current_byte_offset());
   }
 
   auto LexEndOfFile(llvm::StringRef& source_text) -> void {
@@ -772,9 +791,7 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
     // preserve that.
     CloseInvalidOpenGroups(TokenKind::Error);
 
-    buffer_->AddToken({.kind = TokenKind::EndOfFile,
-                       .token_line = current_line_,
-                       .column = current_column_});
+    buffer_->AddToken({.kind = TokenKind::EndOfFile}, current_byte_offset());
   }
 
   // We use a collection of static member functions for table-based dispatch to
@@ -958,6 +975,8 @@ class [[clang::internal_linkage]] TokenizedBuffer::Lexer {
 
   TokenizedBuffer* buffer_;
 
+  ErrorTrackingDiagnosticConsumer* consumer_;
+
   SourceBufferLocationTranslator translator_;
   LexerDiagnosticEmitter emitter_;
 
@@ -997,7 +1016,14 @@ auto TokenizedBuffer::GetKind(Token token) const -> TokenKind {
 }
 
 auto TokenizedBuffer::GetLine(Token token) const -> Line {
-  return GetTokenInfo(token).token_line;
+  int32_t offset = GetByteOffset(token);
+  // Find the first line starting after the token, and step back one line.
+  const auto* line_it = std::partition_point(
+      line_infos_.begin(), line_infos_.end(),
+      [offset](const LineInfo& line) { return line.start <= offset; });
+  CARBON_CHECK(line_it != line_infos_.begin())
+      << "token precedes the start of the first line";
+  return Line(line_it - line_infos_.begin() - 1);
 }
 
 auto TokenizedBuffer::GetLineNumber(Token token) const -> int {
@@ -1005,7 +1031,7 @@ auto TokenizedBuffer::GetLineNumber(Token token) const -> int {
 }
 
 auto TokenizedBuffer::GetColumnNumber(Token token) const -> int {
-  return GetTokenInfo(token).column + 1;
+  return GetByteOffset(token) - GetLineInfo(GetLine(token)).start + 1;
 }
 
 auto TokenizedBuffer::GetTokenText(Token token) const -> llvm::StringRef {
@@ -1016,17 +1042,15 @@ auto TokenizedBuffer::GetTokenText(Token token) const -> llvm::StringRef {
   }
 
   if (token_info.kind == TokenKind::Error) {
-    const auto& line_info = GetLineInfo(token_info.token_line);
-    int64_t token_start = line_info.start + token_info.column;
-    return source_->text().substr(token_start, token_info.error_length);
+    int64_t token_start = GetByteOffset(token);
+    return source_->text().substr(token_start, token_info.error_length());
   }
 
   // Refer back to the source text to preserve oddities like radix or digit
   // separators the author included.
   if (token_info.kind == TokenKind::IntegerLiteral ||
       token_info.kind == TokenKind::RealLiteral) {
-    const auto& line_info = GetLineInfo(token_info.token_line);
-    int64_t token_start = line_info.start + token_info.column;
+    int64_t token_start = GetByteOffset(token);
     std::optional<NumericLiteral> relexed_token =
         NumericLiteral::Lex(source_->text().substr(token_start));
     CARBON_CHECK(relexed_token) << "Could not reform numeric literal token.";
@@ -1036,8 +1060,7 @@ auto TokenizedBuffer::GetTokenText(Token token) const -> llvm::StringRef {
   // Refer back to the source text to find the original spelling, including
   // escape sequences etc.
   if (token_info.kind == TokenKind::StringLiteral) {
-    const auto& line_info = GetLineInfo(token_info.token_line);
-    int64_t token_start = line_info.start + token_info.column;
+    int64_t token_start = GetByteOffset(token);
     std::optional<StringLiteral> relexed_token =
         StringLiteral::Lex(source_->text().substr(token_start));
     CARBON_CHECK(relexed_token) << "Could not reform string literal token.";
@@ -1047,8 +1070,7 @@ auto TokenizedBuffer::GetTokenText(Token token) const -> llvm::StringRef {
   // Refer back to the source text to avoid needing to reconstruct the
   // spelling from the size.
   if (token_info.kind.is_sized_type_literal()) {
-    const auto& line_info = GetLineInfo(token_info.token_line);
-    int64_t token_start = line_info.start + token_info.column;
+    int64_t token_start = GetByteOffset(token);
     llvm::StringRef suffix =
         source_->text().substr(token_start + 1).take_while(IsDecimalDigit);
     return llvm::StringRef(suffix.data() - 1, suffix.size() + 1);
@@ -1060,20 +1082,23 @@ auto TokenizedBuffer::GetTokenText(Token token) const -> llvm::StringRef {
   }
 
   CARBON_CHECK(token_info.kind == TokenKind::Identifier) << token_info.kind;
-  return GetIdentifierText(token_info.id);
+  return GetIdentifierText(token_info.id());
 }
 
 auto TokenizedBuffer::GetIdentifier(Token token) const -> Identifier {
   const auto& token_info = GetTokenInfo(token);
   CARBON_CHECK(token_info.kind == TokenKind::Identifier) << token_info.kind;
-  return token_info.id;
+  return token_info.id();
 }
 
-auto TokenizedBuffer::GetIntegerLiteral(Token token) const
-    -> const llvm::APInt& {
+auto TokenizedBuffer::GetIntegerLiteral(Token token) const -> llvm::APInt {
   const auto& token_info = GetTokenInfo(token);
   CARBON_CHECK(token_info.kind == TokenKind::IntegerLiteral) << token_info.kind;
-  return literal_int_storage_[token_info.literal_index];
+  if (token_info.literal_index() < TokenInfo::InlineIntegerLimit) {
+    return llvm::APInt(32, token_info.literal_index());
+  }
+  return literal_int_storage_[token_info.literal_index() -
+                              TokenInfo::InlineIntegerLimit];
 }
 
 auto TokenizedBuffer::GetRealLiteral(Token token) const -> RealLiteralValue {
@@ -1083,27 +1108,26 @@ auto TokenizedBuffer::GetRealLiteral(Token token) const -> RealLiteralValue {
   // Note that every real literal is at least three characters long, so we can
   // safely look at the second character to determine whether we have a
   // decimal or hexadecimal literal.
-  const auto& line_info = GetLineInfo(token_info.token_line);
-  int64_t token_start = line_info.start + token_info.column;
+  int64_t token_start = GetByteOffset(token);
   char second_char = source_->text()[token_start + 1];
   bool is_decimal = second_char != 'x' && second_char != 'b';
 
-  return {.mantissa = literal_int_storage_[token_info.literal_index],
-          .exponent = literal_int_storage_[token_info.literal_index + 1],
+  return {.mantissa = literal_int_storage_[token_info.literal_index()],
+          .exponent = literal_int_storage_[token_info.literal_index() + 1],
           .is_decimal = is_decimal};
 }
 
 auto TokenizedBuffer::GetStringLiteral(Token token) const -> llvm::StringRef {
   const auto& token_info = GetTokenInfo(token);
   CARBON_CHECK(token_info.kind == TokenKind::StringLiteral) << token_info.kind;
-  return literal_string_storage_[token_info.literal_index];
+  return literal_string_storage_[token_info.literal_index()];
 }
 
 auto TokenizedBuffer::GetTypeLiteralSize(Token token) const
     -> const llvm::APInt& {
   const auto& token_info = GetTokenInfo(token);
   CARBON_CHECK(token_info.kind.is_sized_type_literal()) << token_info.kind;
-  return literal_int_storage_[token_info.literal_index];
+  return literal_int_storage_[token_info.literal_index()];
 }
 
 auto TokenizedBuffer::GetMatchedClosingToken(Token opening_token) const
@@ -1111,7 +1135,7 @@ auto TokenizedBuffer::GetMatchedClosingToken(Token opening_token) const
   const auto& opening_token_info = GetTokenInfo(opening_token);
   CARBON_CHECK(opening_token_info.kind.is_opening_symbol())
       << opening_token_info.kind;
-  return opening_token_info.closing_token;
+  return opening_token_info.closing_token();
 }
 
 auto TokenizedBuffer::GetMatchedOpeningToken(Token closing_token) const
@@ -1119,7 +1143,7 @@ auto TokenizedBuffer::GetMatchedOpeningToken(Token closing_token) const
   const auto& closing_token_info = GetTokenInfo(closing_token);
   CARBON_CHECK(closing_token_info.kind.is_closing_symbol())
       << closing_token_info.kind;
-  return closing_token_info.opening_token;
+  return closing_token_info.opening_token();
 }
 
 auto TokenizedBuffer::HasLeadingWhitespace(Token token) const -> bool {
@@ -1223,6 +1247,7 @@ auto TokenizedBuffer::PrintToken(llvm::raw_ostream& output_stream, Token token,
   widths.Widen(GetTokenPrintWidths(token));
   int token_index = token.index;
   const auto& token_info = GetTokenInfo(token);
+  Line line = GetLine(token);
   llvm::StringRef token_text = GetTokenText(token);
 
   // Output the main chunk using one format string. We have to do the
@@ -1234,10 +1259,9 @@ auto TokenizedBuffer::PrintToken(llvm::raw_ostream& output_stream, Token token,
       llvm::format_decimal(token_index, widths.index),
       llvm::right_justify(llvm::formatv("'{0}'", token_info.kind.name()).str(),
                           widths.kind + 2),
-      llvm::format_decimal(GetLineNumber(token_info.token_line), widths.line),
+      llvm::format_decimal(GetLineNumber(line), widths.line),
       llvm::format_decimal(GetColumnNumber(token), widths.column),
-      llvm::format_decimal(GetIndentColumnNumber(token_info.token_line),
-                           widths.indent),
+      llvm::format_decimal(GetIndentColumnNumber(line), widths.indent),
       token_text);
 
   switch (token_info.kind) {
@@ -1297,8 +1321,13 @@ auto TokenizedBuffer::GetTokenInfo(Token token) const -> const TokenInfo& {
   return token_infos_[token.index];
 }
 
-auto TokenizedBuffer::AddToken(TokenInfo info) -> Token {
+auto TokenizedBuffer::GetByteOffset(Token token) const -> int32_t {
+  return token_byte_offsets_[token.index];
+}
+
+auto TokenizedBuffer::AddToken(TokenInfo info, int32_t byte_offset) -> Token {
   token_infos_.push_back(info);
+  token_byte_offsets_.push_back(byte_offset);
   expected_parse_tree_size_ += info.kind.expected_parse_tree_size();
   return Token(static_cast<int>(token_infos_.size()) - 1);
 }
@@ -1354,10 +1383,8 @@ auto TokenizedBuffer::SourceBufferLocationTranslator::GetLocation(
 
 auto TokenLocationTranslator::GetLocation(Token token) -> DiagnosticLocation {
   // Map the token location into a position within the source buffer.
-  const auto& token_info = buffer_->GetTokenInfo(token);
-  const auto& line_info = buffer_->GetLineInfo(token_info.token_line);
-  const char* token_start =
-      buffer_->source_->text().begin() + line_info.start + token_info.column;
+  const char* token_start = buffer_->source_->text().begin() +
+                            buffer_->GetByteOffset(token);
 
   // Find the corresponding file location.
   // TODO: Should we somehow indicate in the diagnostic location if this token
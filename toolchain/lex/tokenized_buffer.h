@@ -7,7 +7,9 @@
 
 #include <cstdint>
 #include <iterator>
+#include <limits>
 
+#include "common/check.h"
 #include "common/ostream.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/DenseMap.h"
@@ -18,6 +20,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "toolchain/base/index_base.h"
 #include "toolchain/diagnostics/diagnostic_emitter.h"
+#include "toolchain/lex/keyword_hash.h"
 #include "toolchain/lex/token_kind.h"
 #include "toolchain/source/source_buffer.h"
 
@@ -179,6 +182,9 @@ class TokenizedBuffer : public Printable<TokenizedBuffer> {
       -> TokenizedBuffer;
 
   [[nodiscard]] auto GetKind(Token token) const -> TokenKind;
+
+  // Returns the line containing the token. Tokens only store their offset in
+  // the source, so this searches the lines and is best kept off hot paths.
   [[nodiscard]] auto GetLine(Token token) const -> Line;
 
   // Returns the 1-based line number.
@@ -195,7 +201,7 @@ class TokenizedBuffer : public Printable<TokenizedBuffer> {
   [[nodiscard]] auto GetIdentifier(Token token) const -> Identifier;
 
   // Returns the value of an `IntegerLiteral()` token.
-  [[nodiscard]] auto GetIntegerLiteral(Token token) const -> const llvm::APInt&;
+  [[nodiscard]] auto GetIntegerLiteral(Token token) const -> llvm::APInt;
 
   // Returns the value of an `RealLiteral()` token.
   [[nodiscard]] auto GetRealLiteral(Token token) const -> RealLiteralValue;
@@ -320,49 +326,65 @@ class TokenizedBuffer : public Printable<TokenizedBuffer> {
     int indent;
   };
 
+  // Information about a token, packed into 8 bytes to keep the token array
+  // dense for the parser. The token's byte offset is stored separately, in
+  // `token_byte_offsets_`, because it's only needed to compute locations and
+  // spellings; with it, each token takes 12 bytes. The line and column aren't
+  // stored, and are instead computed from the byte offset when needed.
   struct TokenInfo {
+    // Returns whether `value` can be stored in the payload. Every value the
+    // lexer stores is bounded by the size of the source buffer, which is
+    // limited to 2GiB, so this always holds.
+    static constexpr auto FitsInPayload(int64_t value) -> bool {
+      return value >= 0 && value <= std::numeric_limits<uint32_t>::max();
+    }
+
+    // Integer literals with values below this are stored in the payload.
+    // Larger values are stored in `literal_int_storage_`, and the payload is
+    // their index plus this limit.
+    static constexpr int64_t InlineIntegerLimit = int64_t{1} << 31;
+
+    // Accessors for the payload, based on the kind of token.
+    auto id() const -> Identifier { return Identifier(payload); }
+    auto literal_index() const -> uint32_t { return payload; }
+    auto closing_token() const -> Token { return Token(payload); }
+    auto opening_token() const -> Token { return Token(payload); }
+    auto error_length() const -> int32_t { return payload; }
+
+    auto set_payload(int64_t value) -> void {
+      CARBON_CHECK(FitsInPayload(value))
+          << "Token payload " << value << " is too large";
+      payload = value;
+    }
+
     TokenKind kind;
 
     // Whether the token has trailing whitespace.
-    bool has_trailing_space = false;
+    bool has_trailing_space : 1 = false;
 
     // Whether the token was injected artificially during error recovery.
-    bool is_recovery = false;
-
-    // Line on which the Token starts.
-    Line token_line;
-
-    // Zero-based byte offset of the token within its line.
-    int32_t column;
-
-    // We may have up to 32 bits of payload, based on the kind of token.
-    union {
-      static_assert(
-          sizeof(Token) <= sizeof(int32_t),
-          "Unable to pack token and identifier index into the same space!");
-
-      Identifier id = Identifier::Invalid;
-      int32_t literal_index;
-      Token closing_token;
-      Token opening_token;
-      int32_t error_length;
-    };
+    bool is_recovery : 1 = false;
+
+    // The identifier, literal index, matching grouping token or error length,
+    // based on the kind of token.
+    uint32_t payload = 0;
   };
+  static_assert(sizeof(TokenInfo) == 8, "TokenInfo should be packed");
 
   struct LineInfo {
     // The length will always be assigned later. Indent may be assigned if
     // non-zero.
-    explicit LineInfo(int64_t start)
+    explicit LineInfo(int32_t start)
         : start(start),
           length(static_cast<int32_t>(llvm::StringRef::npos)),
           indent(0) {}
 
-    explicit LineInfo(int64_t start, int32_t length)
+    explicit LineInfo(int32_t start, int32_t length)
         : start(start), length(length), indent(0) {}
 
     // Zero-based byte offset of the start of the line within the source buffer
     // provided.
-    int64_t start;
+    int32_t start;
 
     // The byte length of the line. Does not include the newline character (or a
     // nul-terminator or EOF).
@@ -388,7 +410,10 @@ class TokenizedBuffer : public Printable<TokenizedBuffer> {
   auto AddLine(LineInfo info) -> Line;
   auto GetTokenInfo(Token token) -> TokenInfo&;
   [[nodiscard]] auto GetTokenInfo(Token token) const -> const TokenInfo&;
-  auto AddToken(TokenInfo info) -> Token;
+  // Adds a token starting at the given zero-based byte offset within the source
+  // buffer.
+  auto AddToken(TokenInfo info, int32_t byte_offset) -> Token;
+  [[nodiscard]] auto GetByteOffset(Token token) const -> int32_t;
   [[nodiscard]] auto GetTokenPrintWidths(Token token) const -> PrintWidths;
   auto PrintToken(llvm::raw_ostream& output_stream, Token token,
                   PrintWidths widths) const -> void;
@@ -397,17 +422,22 @@ class TokenizedBuffer : public Printable<TokenizedBuffer> {
 
   llvm::SmallVector<TokenInfo> token_infos_;
 
+  // The zero-based byte offset of each token within the source buffer, indexed
+  // in parallel with `token_infos_`.
+  llvm::SmallVector<int32_t> token_byte_offsets_;
+
   llvm::SmallVector<LineInfo> line_infos_;
 
   llvm::SmallVector<IdentifierInfo> identifier_infos_;
 
   // Storage for integers that form part of the value of a numeric or type
-  // literal.
+  // literal, other than small integer literals, which are stored in the token.
   llvm::SmallVector<llvm::APInt> literal_int_storage_;
 
   llvm::SmallVector<std::string> literal_string_storage_;
 
-  llvm::DenseMap<llvm::StringRef, Identifier> identifier_map_;
+  // Keyed on words hashed by the lexer, so that each word is only hashed once.
+  llvm::DenseMap<HashedWord, Identifier> identifier_map_;
 
   // The number of parse tree nodes that we expect to be created for the tokens
   // in this buffer.
@@ -0,0 +1,75 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Lexer tests that need sources of several megabytes, which are kept out of
+// the small `tokenized_buffer_test`.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <forward_list>
+#include <string>
+
+#include "common/check.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "toolchain/diagnostics/diagnostic_emitter.h"
+#include "toolchain/diagnostics/null_diagnostics.h"
+#include "toolchain/lex/tokenized_buffer.h"
+#include "toolchain/lex/tokenized_buffer_test_helpers.h"
+
+namespace Carbon::Lex {
+namespace {
+
+using ::Carbon::Testing::ExpectedToken;
+
+class LexerLargeTest : public ::testing::Test {
+ protected:
+  auto Lex(llvm::StringRef text,
+           DiagnosticConsumer& consumer = ConsoleDiagnosticConsumer())
+      -> TokenizedBuffer {
+    CARBON_CHECK(fs_.addFile("test.carbon", /*ModificationTime=*/0,
+                             llvm::MemoryBuffer::getMemBuffer(text)));
+    source_storage_.push_front(std::move(*SourceBuffer::CreateFromFile(
+        fs_, "test.carbon", ConsoleDiagnosticConsumer())));
+    return TokenizedBuffer::Lex(source_storage_.front(), consumer);
+  }
+
+  llvm::vfs::InMemoryFileSystem fs_;
+  std::forward_list<SourceBuffer> source_storage_;
+};
+
+// Token indices are stored in the tokens that refer to them, so check that
+// they aren't truncated when there are more than 2^22 tokens.
+TEST_F(LexerLargeTest, ManyTokens) {
+  constexpr int NumSemis = (1 << 22) + 1;
+  std::string source = "(" + std::string(NumSemis, ';') + ")";
+  auto buffer = Lex(source);
+  EXPECT_FALSE(buffer.has_errors());
+  // The semicolons, the parentheses, and the start- and end-of-file tokens.
+  ASSERT_EQ(buffer.size(), NumSemis + 4);
+  Token open_paren = buffer.tokens().begin()[1];
+  Token close_paren = buffer.GetMatchedClosingToken(open_paren);
+  EXPECT_EQ(buffer.GetKind(close_paren), TokenKind::CloseParen);
+  EXPECT_EQ(buffer.GetColumnNumber(close_paren), NumSemis + 2);
+  EXPECT_EQ(buffer.GetMatchedOpeningToken(close_paren), open_paren);
+}
+
+// Error token lengths are stored in the token, so check that they aren't
+// truncated when they're longer than 4MiB.
+TEST_F(LexerLargeTest, LongErrorToken) {
+  constexpr int Length = (1 << 22) + 1;
+  std::string source = std::string(Length, '\b') + ";";
+  auto buffer = Lex(source, NullDiagnosticConsumer());
+  EXPECT_TRUE(buffer.has_errors());
+  EXPECT_THAT(buffer, HasTokens(llvm::ArrayRef<ExpectedToken>{
+                          {TokenKind::StartOfFile},
+                          {.kind = TokenKind::Error, .column = 1},
+                          {.kind = TokenKind::Semi, .column = Length + 1},
+                          {TokenKind::EndOfFile}}));
+  Token error = buffer.tokens().begin()[1];
+  EXPECT_EQ(buffer.GetTokenText(error).size(), Length);
+}
+
+}  // namespace
+}  // namespace Carbon::Lex
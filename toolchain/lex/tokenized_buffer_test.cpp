@@ -9,8 +9,10 @@
 
 #include <forward_list>
 #include <iterator>
+#include <string>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "testing/base/test_raw_ostream.h"
 #include "toolchain/diagnostics/diagnostic_emitter.h"
 #include "toolchain/diagnostics/mocks.h"
@@ -171,6 +173,28 @@ TEST_F(LexerTest, HandlesNumericLiteral) {
   EXPECT_EQ(value_1_5e9.is_decimal, true);
 }
 
+TEST_F(LexerTest, HandlesLargeIntegerLiterals) {
+  // Small values are stored in the token, and others separately, so check
+  // values around the boundaries. Hexadecimal literals without separators take
+  // the path that doesn't build an `APInt` from the digits.
+  auto buffer = Lex(
+      "2147483647 2147483648 0x7FFFFFFF 0x80000000 0x7FFF_FFFF 0x8000_0000 "
+      "4294967295 4294967296 123456789012345678901234567890");
+  EXPECT_FALSE(buffer.has_errors());
+  llvm::SmallVector<std::string> values;
+  for (auto token : buffer.tokens()) {
+    if (buffer.GetKind(token) == TokenKind::IntegerLiteral) {
+      values.push_back(llvm::toString(buffer.GetIntegerLiteral(token), 10,
+                                      /*Signed=*/false));
+    }
+  }
+  EXPECT_THAT(values,
+              ElementsAre("2147483647", "2147483648", "2147483647",
+                          "2147483648", "2147483647", "2147483648",
+                          "4294967295", "4294967296",
+                          "123456789012345678901234567890"));
+}
+
 TEST_F(LexerTest, HandlesInvalidNumericLiterals) {
   auto buffer = Lex("14x 15_49 0x3.5q 0x3_4.5_6 0ops");
   EXPECT_TRUE(buffer.has_errors());
@@ -1035,6 +1059,28 @@ TEST_F(LexerTest, DiagnosticUnrecognizedChar) {
   Lex("\b", consumer);
 }
 
+TEST_F(LexerTest, DiagnosticErrorLimit) {
+  Testing::MockDiagnosticConsumer consumer;
+  ErrorLimitDiagnosticConsumer limit_consumer(consumer, 2);
+  EXPECT_CALL(consumer, HandleDiagnostic(IsDiagnostic(
+                            DiagnosticKind::UnrecognizedCharacters,
+                            DiagnosticLevel::Error, 1, 1, _)));
+  EXPECT_CALL(consumer, HandleDiagnostic(IsDiagnostic(
+                            DiagnosticKind::UnrecognizedCharacters,
+                            DiagnosticLevel::Error, 1, 3, _)));
+  // Lexing stops at the end of the line where the limit is reached.
+  auto buffer = Lex("\b;\b;\b\n\b\n;", limit_consumer);
+  EXPECT_TRUE(buffer.has_errors());
+  EXPECT_THAT(buffer, HasTokens(llvm::ArrayRef<ExpectedToken>{
+                          {TokenKind::StartOfFile},
+                          {TokenKind::Error},
+                          {TokenKind::Semi},
+                          {TokenKind::Error},
+                          {TokenKind::Semi},
+                          {TokenKind::Error},
+                          {TokenKind::EndOfFile}}));
+}
+
 TEST_F(LexerTest, PrintingAsYaml) {
   // Test that we can parse this into YAML and verify line and indent data.
   auto buffer = Lex("\n ;\n\n\n; ;\n\n\n\n\n\n\n\n\n\n\n");
@@ -12,16 +12,18 @@
 #include "toolchain/sem_ir/file.h"
 #include "toolchain/sem_ir/node.h"
 #include "toolchain/sem_ir/node_kind.h"
+#include "toolchain/sem_ir/reachability.h"
 
 namespace Carbon::Lower {
 
 FileContext::FileContext(llvm::LLVMContext& llvm_context,
                          llvm::StringRef module_name,
                          const SemIR::File& semantics_ir,
-                         llvm::raw_ostream* vlog_stream)
+                         bool prune_unreachable, llvm::raw_ostream* vlog_stream)
     : llvm_context_(&llvm_context),
       llvm_module_(std::make_unique<llvm::Module>(module_name, llvm_context)),
       semantics_ir_(&semantics_ir),
+      prune_unreachable_(prune_unreachable),
       vlog_stream_(vlog_stream) {
   CARBON_CHECK(!semantics_ir.has_errors())
       << "Generating LLVM IR from invalid SemIR::File is unsupported.";
@@ -31,28 +33,41 @@ FileContext::FileContext(llvm::LLVMContext& llvm_context,
 auto FileContext::Run() -> std::unique_ptr<llvm::Module> {
   CARBON_CHECK(llvm_module_) << "Run can only be called once.";
 
-  // Lower types.
-  auto types = semantics_ir_->types();
-  types_.resize_for_overwrite(types.size());
-  for (auto [i, type] : llvm::enumerate(types)) {
-    types_[i] = BuildType(type);
-  }
-
-  // Lower function declarations.
-  functions_.resize_for_overwrite(semantics_ir_->functions_size());
-  for (auto i : llvm::seq(semantics_ir_->functions_size())) {
-    functions_[i] = BuildFunctionDeclaration(SemIR::FunctionId(i));
-  }
+  // Types and function declarations are lowered when they're first used, so
+  // that types and functions which aren't used by the lowered code aren't
+  // materialized.
+  types_.resize(semantics_ir_->types().size(), nullptr);
+  functions_.resize(semantics_ir_->functions_size(), nullptr);
 
   // TODO: Lower global variable declarations.
 
-  // Lower function definitions.
+  // Lower function definitions. Functions which can't be called from outside
+  // the file are skipped, along with anything only they use.
+  llvm::BitVector reachable;
+  if (prune_unreachable_) {
+    reachable = SemIR::ComputeReachableFunctions(semantics_ir());
+  }
   for (auto i : llvm::seq(semantics_ir_->functions_size())) {
+    if (prune_unreachable_ && !reachable.test(i)) {
+      CARBON_VLOG() << "Skipping unreachable " << SemIR::FunctionId(i) << "\n";
+      continue;
+    }
     BuildFunctionDefinition(SemIR::FunctionId(i));
   }
 
   // TODO: Lower global variable initializers.
 
+  // Functions are added to the module when they're first used. Put them in
+  // the order of the SemIR instead, so that the output doesn't depend on the
+  // order of uses.
+  auto& function_list = llvm_module_->getFunctionList();
+  for (auto* function : functions_) {
+    if (function) {
+      function_list.splice(function_list.end(), function_list,
+                           function->getIterator());
+    }
+  }
+
   return std::move(llvm_module_);
 }
 
@@ -64,8 +79,7 @@ auto FileContext::BuildFunctionDeclaration(SemIR::FunctionId function_id)
 
   SemIR::InitializingRepresentation return_rep =
       function.return_type_id.is_valid()
-          ? SemIR::GetInitializingRepresentation(semantics_ir(),
-                                                 function.return_type_id)
+          ? GetInitializingRepresentation(function.return_type_id)
           : SemIR::InitializingRepresentation{
                 .kind = SemIR::InitializingRepresentation::None};
   CARBON_CHECK(return_rep.has_return_slot() == has_return_slot);
@@ -84,8 +98,7 @@ auto FileContext::BuildFunctionDeclaration(SemIR::FunctionId function_id)
   }
   for (auto param_ref_id : param_refs) {
     auto param_type_id = semantics_ir().GetNode(param_ref_id).type_id();
-    switch (auto value_rep =
-                SemIR::GetValueRepresentation(semantics_ir(), param_type_id);
+    switch (auto value_rep = GetValueRepresentation(param_type_id);
             value_rep.kind) {
       case SemIR::ValueRepresentation::None:
         break;
@@ -166,7 +179,7 @@ auto FileContext::BuildFunctionDefinition(SemIR::FunctionId function_id)
   }
   for (auto param_ref_id : param_refs) {
     auto param_type_id = semantics_ir().GetNode(param_ref_id).type_id();
-    if (SemIR::GetValueRepresentation(semantics_ir(), param_type_id).kind ==
+    if (GetValueRepresentation(param_type_id).kind ==
         SemIR::ValueRepresentation::None) {
       function_lowering.SetLocal(
           param_ref_id, llvm::PoisonValue::get(GetType(param_type_id)));
@@ -187,13 +200,7 @@ auto FileContext::BuildFunctionDefinition(SemIR::FunctionId function_id)
     function_lowering.LowerBlock(block_id);
   }
 
-  // LLVM requires that the entry block has no predecessors.
-  auto* entry_block = &llvm_function->getEntryBlock();
-  if (entry_block->hasNPredecessorsOrMore(1)) {
-    auto* new_entry_block = llvm::BasicBlock::Create(
-        llvm_context(), "entry", llvm_function, entry_block);
-    llvm::BranchInst::Create(entry_block, new_entry_block);
-  }
+  function_lowering.FinishFunction();
 }
 
 auto FileContext::BuildType(SemIR::NodeId node_id) -> llvm::Type* {
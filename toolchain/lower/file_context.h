@@ -19,26 +19,45 @@ class FileContext {
   explicit FileContext(llvm::LLVMContext& llvm_context,
                        llvm::StringRef module_name,
                        const SemIR::File& semantics_ir,
-                       llvm::raw_ostream* vlog_stream);
+                       bool prune_unreachable, llvm::raw_ostream* vlog_stream);
 
   // Lowers the SemIR::File to LLVM IR. Should only be called once, and handles
   // the main execution loop.
   auto Run() -> std::unique_ptr<llvm::Module>;
 
-  // Gets a callable's function.
+  // Gets a callable's function, declaring it on first use.
   auto GetFunction(SemIR::FunctionId function_id) -> llvm::Function* {
-    CARBON_CHECK(functions_[function_id.index] != nullptr) << function_id;
-    return functions_[function_id.index];
+    llvm::Function*& function = functions_[function_id.index];
+    if (!function) {
+      function = BuildFunctionDeclaration(function_id);
+    }
+    return function;
   }
 
-  // Returns a lowered type for the given type_id.
+  // Returns a lowered type for the given type_id, lowering it on first use.
   auto GetType(SemIR::TypeId type_id) -> llvm::Type* {
     // InvalidType should not be passed in.
     if (type_id == SemIR::TypeId::TypeType) {
       return GetTypeType();
     }
     CARBON_CHECK(type_id.index >= 0) << type_id;
-    return types_[type_id.index];
+    llvm::Type*& type = types_[type_id.index];
+    if (!type) {
+      type = BuildType(semantics_ir_->GetType(type_id));
+    }
+    return type;
+  }
+
+  // Returns the value representation of the given type.
+  auto GetValueRepresentation(SemIR::TypeId type_id)
+      -> SemIR::ValueRepresentation {
+    return SemIR::GetValueRepresentation(*semantics_ir_, type_id);
+  }
+
+  // Returns the initializing representation of the given type.
+  auto GetInitializingRepresentation(SemIR::TypeId type_id)
+      -> SemIR::InitializingRepresentation {
+    return SemIR::GetInitializingRepresentation(*semantics_ir_, type_id);
   }
 
   // Returns a lowered value to use for a value of type `type`.
@@ -52,7 +71,7 @@ class FileContext {
 
  private:
   // Builds the declaration for the given function, which should then be cached
-  // by the caller.
+  // by the caller. Called by `GetFunction`.
   auto BuildFunctionDeclaration(SemIR::FunctionId function_id)
       -> llvm::Function*;
 
@@ -61,7 +80,7 @@ class FileContext {
   auto BuildFunctionDefinition(SemIR::FunctionId function_id) -> void;
 
   // Builds the type for the given node, which should then be cached by the
-  // caller.
+  // caller. Called by `GetType`.
   auto BuildType(SemIR::NodeId node_id) -> llvm::Type*;
 
   // Returns the empty LLVM struct type used to represent the type `type`.
@@ -80,14 +99,18 @@ class FileContext {
   // The input SemIR.
   const SemIR::File* const semantics_ir_;
 
+  // Whether to skip functions which can't be called from outside the file.
+  bool prune_unreachable_;
+
   // The optional vlog stream.
   llvm::raw_ostream* vlog_stream_;
 
   // Maps callables to lowered functions. SemIR treats callables as the
-  // canonical form of a function, so lowering needs to do the same.
+  // canonical form of a function, so lowering needs to do the same. Null until
+  // the function is used or defined.
   llvm::SmallVector<llvm::Function*> functions_;
 
-  // Provides lowered versions of types.
+  // Provides lowered versions of types. Null until the type is used.
   llvm::SmallVector<llvm::Type*> types_;
 
   // Lowered version of the builtin type `type`.
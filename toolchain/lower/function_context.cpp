@@ -4,7 +4,10 @@
 
 #include "toolchain/lower/function_context.h"
 
+#include <optional>
+
 #include "common/vlog.h"
+#include "llvm/IR/Dominators.h"
 #include "toolchain/sem_ir/file.h"
 
 namespace Carbon::Lower {
@@ -73,6 +76,93 @@ auto FunctionContext::GetBlockArg(SemIR::NodeBlockId block_id,
   return phi;
 }
 
+auto FunctionContext::CreateAlloca(llvm::Type* type, const llvm::Twine& name)
+    -> llvm::AllocaInst* {
+  // The first lowered block is the entry block until `FinishFunction`.
+  llvm::BasicBlock* entry_block = &function_->getEntryBlock();
+  llvm::IRBuilder<> entry_builder(
+      entry_block, allocas_.empty()
+                       ? entry_block->getFirstInsertionPt()
+                       : std::next(allocas_.back()->getIterator()));
+  auto* alloca = entry_builder.CreateAlloca(type, /*ArraySize=*/nullptr, name);
+  allocas_.push_back(alloca);
+  return alloca;
+}
+
+auto FunctionContext::FinishFunction() -> void {
+  auto* entry_block = &function_->getEntryBlock();
+  if (entry_block->hasNPredecessorsOrMore(1)) {
+    auto* new_entry_block = llvm::BasicBlock::Create(llvm_context(), "entry",
+                                                     function_, entry_block);
+    auto* branch = llvm::BranchInst::Create(entry_block, new_entry_block);
+    for (auto* alloca : allocas_) {
+      alloca->moveBefore(branch);
+    }
+  }
+
+  std::optional<llvm::DominatorTree> dominators;
+  llvm::erase_if(allocas_, [&](llvm::AllocaInst* alloca) {
+    return TryToPromoteAlloca(alloca, dominators);
+  });
+}
+
+// Returns the store to `alloca` if it's stored to exactly once and otherwise
+// only loaded from, or null if it's used in any other way.
+static auto GetSingleStore(llvm::AllocaInst* alloca) -> llvm::StoreInst* {
+  llvm::StoreInst* store = nullptr;
+  for (llvm::User* user : alloca->users()) {
+    if (llvm::isa<llvm::LoadInst>(user)) {
+      continue;
+    }
+    auto* user_store = llvm::dyn_cast<llvm::StoreInst>(user);
+    // Storing the address of the alloca, or storing to it twice, means it
+    // can't be replaced by a single value.
+    if (!user_store || user_store->getPointerOperand() != alloca || store) {
+      return nullptr;
+    }
+    store = user_store;
+  }
+  return store;
+}
+
+auto FunctionContext::TryToPromoteAlloca(
+    llvm::AllocaInst* alloca, std::optional<llvm::DominatorTree>& dominators)
+    -> bool {
+  auto* store = GetSingleStore(alloca);
+  if (!store) {
+    return false;
+  }
+  llvm::Value* value = store->getValueOperand();
+
+  llvm::SmallVector<llvm::LoadInst*> loads;
+  for (llvm::User* user : alloca->users()) {
+    if (user == store) {
+      continue;
+    }
+    auto* load = llvm::cast<llvm::LoadInst>(user);
+    if (load->getType() != value->getType()) {
+      return false;
+    }
+    // A load that isn't dominated by the store could see an uninitialized
+    // value, so leave those to LLVM's mem2reg.
+    if (!dominators) {
+      dominators.emplace(*function_);
+    }
+    if (!dominators->dominates(store, load)) {
+      return false;
+    }
+    loads.push_back(load);
+  }
+
+  for (auto* load : loads) {
+    load->replaceAllUsesWith(value);
+    load->eraseFromParent();
+  }
+  store->eraseFromParent();
+  alloca->eraseFromParent();
+  return true;
+}
+
 auto FunctionContext::CreateSyntheticBlock() -> llvm::BasicBlock* {
   synthetic_block_ = llvm::BasicBlock::Create(llvm_context(), "", function_);
   return synthetic_block_;
@@ -81,7 +171,7 @@ auto FunctionContext::CreateSyntheticBlock() -> llvm::BasicBlock* {
 auto FunctionContext::FinishInitialization(SemIR::TypeId type_id,
                                            SemIR::NodeId dest_id,
                                            SemIR::NodeId source_id) -> void {
-  switch (SemIR::GetInitializingRepresentation(semantics_ir(), type_id).kind) {
+  switch (GetInitializingRepresentation(type_id).kind) {
     case SemIR::InitializingRepresentation::None:
     case SemIR::InitializingRepresentation::InPlace:
       break;
@@ -93,8 +183,7 @@ auto FunctionContext::FinishInitialization(SemIR::TypeId type_id,
 
 auto FunctionContext::CopyValue(SemIR::TypeId type_id, SemIR::NodeId source_id,
                                 SemIR::NodeId dest_id) -> void {
-  switch (auto rep = SemIR::GetValueRepresentation(semantics_ir(), type_id);
-          rep.kind) {
+  switch (auto rep = GetValueRepresentation(type_id); rep.kind) {
     case SemIR::ValueRepresentation::None:
       break;
     case SemIR::ValueRepresentation::Copy:
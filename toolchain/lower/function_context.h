@@ -5,6 +5,9 @@
 #ifndef CARBON_TOOLCHAIN_LOWER_FUNCTION_CONTEXT_H_
 #define CARBON_TOOLCHAIN_LOWER_FUNCTION_CONTEXT_H_
 
+#include <optional>
+
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
@@ -72,6 +75,32 @@ class FunctionContext {
     return file_context_->GetTypeAsValue();
   }
 
+  // Returns the value representation of the given type.
+  auto GetValueRepresentation(SemIR::TypeId type_id)
+      -> SemIR::ValueRepresentation {
+    return file_context_->GetValueRepresentation(type_id);
+  }
+
+  // Returns the initializing representation of the given type.
+  auto GetInitializingRepresentation(SemIR::TypeId type_id)
+      -> SemIR::InitializingRepresentation {
+    return file_context_->GetInitializingRepresentation(type_id);
+  }
+
+  // Creates an alloca for a local object of type `type`. Allocas are placed at
+  // the start of the function's entry block rather than at the current
+  // insertion point, so that each is a fixed stack slot, even when created
+  // inside a loop, and can be promoted to SSA values by mem2reg.
+  auto CreateAlloca(llvm::Type* type, const llvm::Twine& name)
+      -> llvm::AllocaInst*;
+
+  // Called after the function's blocks are lowered. LLVM requires that the
+  // entry block has no predecessors, so if the first block is branched to, this
+  // adds a new entry block and moves the allocas into it. Then promotes allocas
+  // to SSA values where that's trivial, so that the IR is reasonable even
+  // without optimization.
+  auto FinishFunction() -> void;
+
   // Create a synthetic block that corresponds to no SemIR::NodeBlockId. Such
   // a block should only ever have a single predecessor, and is used when we
   // need multiple `llvm::BasicBlock`s to model the linear control flow in a
@@ -100,6 +129,15 @@ class FunctionContext {
   }
 
  private:
+  // Replaces `alloca` by the value stored to it, if it's initialized by a
+  // single store that dominates every load from it, as is the case for most
+  // temporaries and for `var`s which are never assigned to or addressed.
+  // Returns whether `alloca` was removed. `dominators` is computed on first
+  // use.
+  auto TryToPromoteAlloca(llvm::AllocaInst* alloca,
+                          std::optional<llvm::DominatorTree>& dominators)
+      -> bool;
+
   // Emits a value copy for type `type_id` from `source_id` to `dest_id`.
   // `source_id` must produce a value representation for `type_id`, and
   // `dest_id` must be a pointer to a `type_id` object.
@@ -124,6 +162,9 @@ class FunctionContext {
   // such block.
   llvm::BasicBlock* synthetic_block_ = nullptr;
 
+  // The allocas at the start of the entry block, in order of creation.
+  llvm::SmallVector<llvm::AllocaInst*> allocas_;
+
   // Maps a function's SemIR::File nodes to lowered values.
   // TODO: Handle nested scopes. Right now this is just cleared at the end of
   // every block.
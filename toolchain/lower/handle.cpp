@@ -143,8 +143,8 @@ auto HandleCall(FunctionContext& context, SemIR::NodeId node_id,
 
   for (auto arg_id : arg_ids) {
     auto arg_type_id = context.semantics_ir().GetNode(arg_id).type_id();
-    if (SemIR::GetValueRepresentation(context.semantics_ir(), arg_type_id)
-            .kind != SemIR::ValueRepresentation::None) {
+    if (context.GetValueRepresentation(arg_type_id).kind !=
+        SemIR::ValueRepresentation::None) {
       args.push_back(context.GetLocal(arg_id));
     }
   }
@@ -241,9 +241,9 @@ auto HandleReturn(FunctionContext& context, SemIR::NodeId /*node_id*/,
 
 auto HandleReturnExpression(FunctionContext& context, SemIR::NodeId /*node_id*/,
                             SemIR::ReturnExpression node) -> void {
-  switch (SemIR::GetInitializingRepresentation(
-              context.semantics_ir(),
-              context.semantics_ir().GetNode(node.expr_id).type_id())
+  switch (context
+              .GetInitializingRepresentation(
+                  context.semantics_ir().GetNode(node.expr_id).type_id())
               .kind) {
     case SemIR::InitializingRepresentation::None:
     case SemIR::InitializingRepresentation::InPlace:
@@ -282,8 +282,8 @@ static auto GetStructOrTupleElement(FunctionContext& context,
   auto aggr_cat =
       SemIR::GetExpressionCategory(context.semantics_ir(), aggr_node_id);
   if (aggr_cat == SemIR::ExpressionCategory::Value &&
-      SemIR::GetValueRepresentation(context.semantics_ir(), aggr_node.type_id())
-              .kind == SemIR::ValueRepresentation::Copy) {
+      context.GetValueRepresentation(aggr_node.type_id()).kind ==
+          SemIR::ValueRepresentation::Copy) {
     // We are holding the values of the aggregate directly, elementwise.
     return context.builder().CreateExtractValue(aggr_value, idx, name);
   }
@@ -297,9 +297,7 @@ static auto GetStructOrTupleElement(FunctionContext& context,
 
   // If this is a value access, load the element if necessary.
   if (aggr_cat == SemIR::ExpressionCategory::Value) {
-    switch (
-        SemIR::GetValueRepresentation(context.semantics_ir(), result_type_id)
-            .kind) {
+    switch (context.GetValueRepresentation(result_type_id).kind) {
       case SemIR::ValueRepresentation::None:
         return llvm::PoisonValue::get(context.GetType(result_type_id));
       case SemIR::ValueRepresentation::Copy:
@@ -350,7 +348,7 @@ auto EmitStructOrTupleValueRepresentation(FunctionContext& context,
                                           llvm::Twine name) -> llvm::Value* {
   auto* llvm_type = context.GetType(type_id);
 
-  switch (SemIR::GetValueRepresentation(context.semantics_ir(), type_id).kind) {
+  switch (context.GetValueRepresentation(type_id).kind) {
     case SemIR::ValueRepresentation::None:
       // TODO: Add a helper to get a "no value representation" value.
       return llvm::PoisonValue::get(llvm_type);
@@ -368,10 +366,22 @@ auto EmitStructOrTupleValueRepresentation(FunctionContext& context,
     case SemIR::ValueRepresentation::Pointer: {
       // Write the object representation to a local alloca so we can produce a
       // pointer to it as the value representation.
-      auto* alloca = context.builder().CreateAlloca(
-          llvm_type, /*ArraySize=*/nullptr, name);
-      for (auto [i, ref] :
-           llvm::enumerate(context.semantics_ir().GetNodeBlock(refs_id))) {
+      auto* alloca = context.CreateAlloca(llvm_type, name);
+      auto refs = context.semantics_ir().GetNodeBlock(refs_id);
+
+      // Zero-initialize with a single memset rather than a store per element.
+      if (llvm::all_of(refs, [&](SemIR::NodeId ref) {
+            auto* value = llvm::dyn_cast<llvm::Constant>(context.GetLocal(ref));
+            return value && value->isNullValue();
+          })) {
+        const auto& layout = context.llvm_module().getDataLayout();
+        context.builder().CreateMemSet(alloca, context.builder().getInt8(0),
+                                       layout.getTypeAllocSize(llvm_type),
+                                       layout.getABITypeAlign(llvm_type));
+        return alloca;
+      }
+
+      for (auto [i, ref] : llvm::enumerate(refs)) {
         auto* gep = context.builder().CreateStructGEP(llvm_type, alloca, i);
         // TODO: We are loading a value representation here and storing an
         // object representation!
@@ -390,9 +400,7 @@ auto HandleStructInit(FunctionContext& context, SemIR::NodeId node_id,
                       SemIR::StructInit node) -> void {
   auto* llvm_type = context.GetType(node.type_id);
 
-  switch (
-      SemIR::GetInitializingRepresentation(context.semantics_ir(), node.type_id)
-          .kind) {
+  switch (context.GetInitializingRepresentation(node.type_id).kind) {
     case SemIR::InitializingRepresentation::None:
     case SemIR::InitializingRepresentation::InPlace:
       // TODO: Add a helper to poison a value slot.
@@ -451,9 +459,7 @@ auto HandleTupleInit(FunctionContext& context, SemIR::NodeId node_id,
                      SemIR::TupleInit node) -> void {
   auto* llvm_type = context.GetType(node.type_id);
 
-  switch (
-      SemIR::GetInitializingRepresentation(context.semantics_ir(), node.type_id)
-          .kind) {
+  switch (context.GetInitializingRepresentation(node.type_id).kind) {
     case SemIR::InitializingRepresentation::None:
     case SemIR::InitializingRepresentation::InPlace:
       // TODO: Add a helper to poison a value slot.
@@ -488,9 +494,8 @@ auto HandleVarStorage(FunctionContext& context, SemIR::NodeId node_id,
   // something like `var` as a default. However, that's not possible right now
   // so cannot be tested.
   auto name = context.semantics_ir().GetString(node.name_id);
-  auto* alloca = context.builder().CreateAlloca(context.GetType(node.type_id),
-                                                /*ArraySize=*/nullptr, name);
-  context.SetLocal(node_id, alloca);
+  context.SetLocal(node_id,
+                   context.CreateAlloca(context.GetType(node.type_id), name));
 }
 
 }  // namespace Carbon::Lower
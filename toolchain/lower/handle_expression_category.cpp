@@ -9,9 +9,7 @@ namespace Carbon::Lower {
 
 auto HandleBindValue(FunctionContext& context, SemIR::NodeId node_id,
                      SemIR::BindValue node) -> void {
-  switch (auto rep = SemIR::GetValueRepresentation(context.semantics_ir(),
-                                                   node.type_id);
-          rep.kind) {
+  switch (auto rep = context.GetValueRepresentation(node.type_id); rep.kind) {
     case SemIR::ValueRepresentation::None:
       // Nothing should use this value, but StubReference needs a value to
       // propagate.
@@ -40,9 +38,8 @@ auto HandleTemporary(FunctionContext& context, SemIR::NodeId node_id,
 
 auto HandleTemporaryStorage(FunctionContext& context, SemIR::NodeId node_id,
                             SemIR::TemporaryStorage node) -> void {
-  context.SetLocal(node_id,
-                   context.builder().CreateAlloca(context.GetType(node.type_id),
-                                                  nullptr, "temp"));
+  context.SetLocal(
+      node_id, context.CreateAlloca(context.GetType(node.type_id), "temp"));
 }
 
 auto HandleValueAsReference(FunctionContext& context, SemIR::NodeId node_id,
@@ -50,9 +47,8 @@ auto HandleValueAsReference(FunctionContext& context, SemIR::NodeId node_id,
   CARBON_CHECK(
       SemIR::GetExpressionCategory(context.semantics_ir(), node.value_id) ==
       SemIR::ExpressionCategory::Value);
-  CARBON_CHECK(
-      SemIR::GetValueRepresentation(context.semantics_ir(), node.type_id)
-          .kind == SemIR::ValueRepresentation::Pointer);
+  CARBON_CHECK(context.GetValueRepresentation(node.type_id).kind ==
+               SemIR::ValueRepresentation::Pointer);
   context.SetLocal(node_id, context.GetLocal(node.value_id));
 }
 
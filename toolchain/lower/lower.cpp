@@ -9,10 +9,11 @@
 namespace Carbon::Lower {
 
 auto LowerToLLVM(llvm::LLVMContext& llvm_context, llvm::StringRef module_name,
-                 const SemIR::File& semantics_ir,
+                 const SemIR::File& semantics_ir, bool prune_unreachable,
                  llvm::raw_ostream* vlog_stream)
     -> std::unique_ptr<llvm::Module> {
-  FileContext context(llvm_context, module_name, semantics_ir, vlog_stream);
+  FileContext context(llvm_context, module_name, semantics_ir,
+                      prune_unreachable, vlog_stream);
   return context.Run();
 }
 
@@ -4,40 +4,86 @@
 
 #include "toolchain/parse/tree.h"
 
+#include <thread>
+
 #include "common/check.h"
 #include "common/error.h"
 #include "llvm/ADT/Sequence.h"
 #include "llvm/ADT/SmallVector.h"
 #include "toolchain/base/pretty_stack_trace_function.h"
+#include "toolchain/diagnostics/null_diagnostics.h"
 #include "toolchain/lex/tokenized_buffer.h"
 #include "toolchain/parse/context.h"
 #include "toolchain/parse/node_kind.h"
 
 namespace Carbon::Parse {
 
+// The minimum number of tokens in each part of a file parsed in parallel.
+// Smaller files are parsed sequentially.
+static constexpr int MinTokensPerPart = 4096;
+
 auto Tree::Parse(Lex::TokenizedBuffer& tokens, DiagnosticConsumer& consumer,
-                 llvm::raw_ostream* vlog_stream) -> Tree {
-  Lex::TokenLocationTranslator translator(&tokens);
-  Lex::TokenDiagnosticEmitter emitter(translator, consumer);
+                 llvm::raw_ostream* vlog_stream, int num_threads) -> Tree {
+  std::optional<Tree> parallel_tree;
+  // Verbose output would be interleaved, so it forces a sequential parse.
+  if (num_threads > 1 && !vlog_stream) {
+    parallel_tree = ParseInParallel(tokens, num_threads);
+  }
 
-  // Delegate to the parser.
+  // Delegate to the parser. A file with errors is parsed again sequentially,
+  // so that diagnostics are emitted in order.
   Tree tree(tokens);
+  if (parallel_tree) {
+    tree = std::move(*parallel_tree);
+  } else {
+    Lex::TokenLocationTranslator translator(&tokens);
+    Lex::TokenDiagnosticEmitter emitter(translator, consumer);
+    // If the tree is valid, there will be one node per token, so reserve once.
+    tree.node_impls_.reserve(tokens.expected_parse_tree_size());
+    ParseRange(tree, tokens, emitter, vlog_stream, tokens.tokens().begin(),
+               /*part_end=*/std::nullopt);
+  }
+
+  if (auto verify = tree.Verify(); !verify.ok()) {
+    if (vlog_stream) {
+      tree.Print(*vlog_stream);
+    }
+    CARBON_FATAL() << "Invalid tree returned by Parse(): " << verify.error();
+  }
+  return tree;
+}
+
+auto Tree::ParseRange(Tree& tree, Lex::TokenizedBuffer& tokens,
+                      Lex::TokenDiagnosticEmitter& emitter,
+                      llvm::raw_ostream* vlog_stream, Lex::TokenIterator begin,
+                      std::optional<Lex::TokenIterator> part_end) -> bool {
   Context context(tree, tokens, emitter, vlog_stream);
   PrettyStackTraceFunction context_dumper(
       [&](llvm::raw_ostream& output) { context.PrintForStackDump(output); });
+  context.position() = begin;
 
-  context.AddLeafNode(NodeKind::FileStart,
-                      context.ConsumeChecked(Lex::TokenKind::StartOfFile));
+  bool at_file_start = tokens.GetKind(*begin) == Lex::TokenKind::StartOfFile;
+  if (at_file_start) {
+    context.AddLeafNode(NodeKind::FileStart,
+                        context.ConsumeChecked(Lex::TokenKind::StartOfFile));
+  }
 
   context.PushState(State::DeclarationScopeLoop);
 
   // The package should always be the first token, if it's present. Any other
   // use is invalid.
-  if (context.PositionIs(Lex::TokenKind::Package)) {
+  if (at_file_start && context.PositionIs(Lex::TokenKind::Package)) {
     context.PushState(State::Package);
   }
 
   while (!context.state_stack().empty()) {
+    // Only the top-level `DeclarationScopeLoop` is left between top-level
+    // declarations, which is where a part ends.
+    if (part_end && context.state_stack().size() == 1 &&
+        context.position() >= *part_end) {
+      return context.position() == *part_end;
+    }
+
     // clang warns on unhandled enum values; clang-tidy is incorrect here.
     // NOLINTNEXTLINE(bugprone-switch-missing-default-case)
     switch (context.state_stack().back().state) {
@@ -49,13 +95,106 @@ auto Tree::Parse(Lex::TokenizedBuffer& tokens, DiagnosticConsumer& consumer,
     }
   }
 
+  // Parsing a part stops before the end of the file.
+  if (part_end) {
+    return false;
+  }
   context.AddLeafNode(NodeKind::FileEnd, *context.position());
+  return true;
+}
 
-  if (auto verify = tree.Verify(); !verify.ok()) {
-    if (vlog_stream) {
-      tree.Print(*vlog_stream);
+// Returns whether a top-level declaration can start with a token of kind
+// `kind`.
+static auto IsDeclarationIntroducer(Lex::TokenKind kind) -> bool {
+  return kind.IsOneOf({Lex::TokenKind::Class, Lex::TokenKind::Constraint,
+                       Lex::TokenKind::Fn, Lex::TokenKind::Interface,
+                       Lex::TokenKind::Let, Lex::TokenKind::Namespace,
+                       Lex::TokenKind::Var});
+}
+
+// Splits the tokens into at most `num_parts` parts of at least
+// `MinTokensPerPart` tokens each, returning the first token of each part
+// followed by the `EndOfFile` token.
+//
+// Parts are split before a declaration introducer that follows a `;` or `}`
+// outside any brackets. That's where a top-level declaration ends in a file
+// without errors. Brackets are skipped using the matching computed by the
+// lexer, so this only visits the top-level tokens.
+static auto FindParts(const Lex::TokenizedBuffer& tokens, int num_parts)
+    -> llvm::SmallVector<Lex::TokenIterator> {
+  auto begin = tokens.tokens().begin();
+  // The `EndOfFile` token.
+  auto end = tokens.tokens().end() - 1;
+  int part_size = std::max<int>((end - begin) / num_parts, MinTokensPerPart);
+
+  llvm::SmallVector<Lex::TokenIterator> parts = {begin};
+  auto next_part = begin + part_size;
+  Lex::TokenKind prev_kind = Lex::TokenKind::StartOfFile;
+  for (auto it = begin + 1; it < end && end - it >= MinTokensPerPart; ++it) {
+    Lex::TokenKind kind = tokens.GetKind(*it);
+    if (it >= next_part &&
+        (prev_kind == Lex::TokenKind::Semi ||
+         prev_kind == Lex::TokenKind::CloseCurlyBrace) &&
+        IsDeclarationIntroducer(kind)) {
+      parts.push_back(it);
+      next_part = it + part_size;
     }
-    CARBON_FATAL() << "Invalid tree returned by Parse(): " << verify.error();
+    if (kind.is_opening_symbol()) {
+      it = Lex::TokenIterator(tokens.GetMatchedClosingToken(*it));
+      kind = tokens.GetKind(*it);
+    }
+    prev_kind = kind;
+  }
+  parts.push_back(end);
+  return parts;
+}
+
+auto Tree::ParseInParallel(Lex::TokenizedBuffer& tokens, int num_threads)
+    -> std::optional<Tree> {
+  llvm::SmallVector<Lex::TokenIterator> part_begins =
+      FindParts(tokens, num_threads);
+  int num_parts = part_begins.size() - 1;
+  if (num_parts < 2) {
+    return std::nullopt;
+  }
+
+  // Each part is parsed into its own tree. Only whether a part has errors
+  // matters, because a file with errors is parsed again sequentially.
+  llvm::SmallVector<Tree> parts(num_parts, Tree(tokens));
+  llvm::SmallVector<bool> parsed(num_parts, false);
+  auto parse_part = [&](int i) {
+    Lex::TokenLocationTranslator translator(&tokens);
+    ErrorTrackingDiagnosticConsumer consumer(NullDiagnosticConsumer());
+    Lex::TokenDiagnosticEmitter emitter(translator, consumer);
+    std::optional<Lex::TokenIterator> part_end;
+    if (i + 1 < num_parts) {
+      part_end = part_begins[i + 1];
+    }
+    bool ended_at_part_end =
+        ParseRange(parts[i], tokens, emitter, /*vlog_stream=*/nullptr,
+                   part_begins[i], part_end);
+    parsed[i] =
+        ended_at_part_end && !consumer.seen_error() && !parts[i].has_errors_;
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_parts - 1);
+  for (int i : llvm::seq(1, num_parts)) {
+    threads.emplace_back(parse_part, i);
+  }
+  parse_part(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (!llvm::all_of(parsed, [](bool part_parsed) { return part_parsed; })) {
+    return std::nullopt;
+  }
+
+  // Top-level declarations are roots, so their subtree sizes don't depend on
+  // what precedes them, and the parts can be concatenated.
+  Tree tree(tokens);
+  tree.node_impls_.reserve(tokens.expected_parse_tree_size());
+  for (const Tree& part : parts) {
+    tree.node_impls_.append(part.node_impls_.begin(), part.node_impls_.end());
   }
   return tree;
 }
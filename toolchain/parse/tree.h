@@ -6,6 +6,7 @@
 #define CARBON_TOOLCHAIN_PARSE_TREE_H_
 
 #include <iterator>
+#include <optional>
 
 #include "common/error.h"
 #include "common/ostream.h"
@@ -65,8 +66,14 @@ class Tree : public Printable<Tree> {
   // Parses the token buffer into a `Tree`.
   //
   // This is the factory function which is used to build parse trees.
+  //
+  // When `num_threads` is more than 1, large files are split between
+  // top-level declarations and the parts are parsed concurrently, then
+  // spliced into one tree. If any part has errors, the whole file is parsed
+  // again sequentially so that diagnostics and error recovery are unchanged.
   static auto Parse(Lex::TokenizedBuffer& tokens, DiagnosticConsumer& consumer,
-                    llvm::raw_ostream* vlog_stream) -> Tree;
+                    llvm::raw_ostream* vlog_stream, int num_threads = 1)
+      -> Tree;
 
   // Tests whether there are any errors in the parse tree.
   [[nodiscard]] auto has_errors() const -> bool { return has_errors_; }
@@ -166,6 +173,7 @@ class Tree : public Printable<Tree> {
 
  private:
   friend class Context;
+  friend class TreeIndex;
 
   // The in-memory representation of data used for a particular node in the
   // tree.
@@ -223,10 +231,22 @@ class Tree : public Printable<Tree> {
 
   // Wires up the reference to the tokenized buffer. The `Parse` function should
   // be used to actually parse the tokens into a tree.
-  explicit Tree(Lex::TokenizedBuffer& tokens_arg) : tokens_(&tokens_arg) {
-    // If the tree is valid, there will be one node per token, so reserve once.
-    node_impls_.reserve(tokens_->expected_parse_tree_size());
-  }
+  explicit Tree(Lex::TokenizedBuffer& tokens_arg) : tokens_(&tokens_arg) {}
+
+  // Parses the tokens from `begin` into `tree`. If `part_end` is set, parsing
+  // stops at the first top-level declaration boundary at or after it, and
+  // this returns whether that boundary is `part_end`. Otherwise, parsing
+  // continues to the end of the file and this returns true.
+  static auto ParseRange(Tree& tree, Lex::TokenizedBuffer& tokens,
+                         Lex::TokenDiagnosticEmitter& emitter,
+                         llvm::raw_ostream* vlog_stream,
+                         Lex::TokenIterator begin,
+                         std::optional<Lex::TokenIterator> part_end) -> bool;
+
+  // Parses parts of the file concurrently, as described for `Parse`. Returns
+  // nothing if the file is too small to split or any part has errors.
+  static auto ParseInParallel(Lex::TokenizedBuffer& tokens, int num_threads)
+      -> std::optional<Tree>;
 
   // Prints a single node for Print(). Returns true when preorder and there are
   // children.
@@ -0,0 +1,51 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "toolchain/parse/tree_index.h"
+
+#include "llvm/ADT/Sequence.h"
+
+namespace Carbon::Parse {
+
+TreeIndex::TreeIndex(const Tree& tree)
+    : tree_(&tree),
+      parents_(tree.size(), Node::Invalid),
+      first_children_(tree.size(), Node::Invalid),
+      next_siblings_(tree.size(), Node::Invalid),
+      token_nodes_(tree.tokens_->size(), Node::Invalid) {
+  // In postorder, a node's children precede it, with the last child
+  // immediately before it, and each earlier child before the subtree of the
+  // next one. Walking back from each node visits every node once as a child,
+  // so this is linear in the size of the tree. The roots are found the same
+  // way from the end of the tree.
+  auto link_children = [&](Node parent, int begin, int end) {
+    Node next = Node::Invalid;
+    for (int child = end - 1; child > begin;
+         child -= tree.node_impls_[child].subtree_size) {
+      parents_[child] = parent;
+      next_siblings_[child] = next;
+      next = Node(child);
+    }
+    return next;
+  };
+
+  for (int i : llvm::seq(0, tree.size())) {
+    const auto& node_impl = tree.node_impls_[i];
+    first_children_[i] = link_children(Node(i), i - node_impl.subtree_size, i);
+    token_nodes_[node_impl.token.index] = Node(i);
+  }
+  link_children(Node::Invalid, -1, tree.size());
+}
+
+auto TreeIndex::FindChild(Node n, NodeKind kind) const -> Node {
+  for (Node child = first_child(n); child.is_valid();
+       child = next_sibling(child)) {
+    if (tree_->node_kind(child) == kind) {
+      return child;
+    }
+  }
+  return Node::Invalid;
+}
+
+}  // namespace Carbon::Parse
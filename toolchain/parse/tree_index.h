@@ -0,0 +1,79 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_TOOLCHAIN_PARSE_TREE_INDEX_H_
+#define CARBON_TOOLCHAIN_PARSE_TREE_INDEX_H_
+
+#include "common/check.h"
+#include "llvm/ADT/SmallVector.h"
+#include "toolchain/lex/tokenized_buffer.h"
+#include "toolchain/parse/node_kind.h"
+#include "toolchain/parse/tree.h"
+
+namespace Carbon::Parse {
+
+// Links between the nodes of a parse tree, for clients which navigate the tree
+// by more than the postorder and reverse postorder traversals that `Tree`
+// supports directly.
+//
+// `Tree` only stores each node's subtree size, so finding a node's parent, or
+// the node for a token, requires a scan. This index is built in a single
+// linear pass over the tree, after which those queries and stepping between
+// children are constant time. It takes about 16 bytes per node, so it's only
+// built by clients which ask for it.
+//
+// Children are ordered as in the source, which is the reverse of the order of
+// `Tree::children`.
+class TreeIndex {
+ public:
+  // Builds an index for `tree`, which must outlive the index.
+  explicit TreeIndex(const Tree& tree);
+
+  // Returns the parent of `n`, or `Node::Invalid` for a root.
+  [[nodiscard]] auto parent(Node n) const -> Node {
+    CARBON_CHECK(n.is_valid());
+    return parents_[n.index];
+  }
+
+  // Returns the first child of `n`, or `Node::Invalid` for a leaf.
+  [[nodiscard]] auto first_child(Node n) const -> Node {
+    CARBON_CHECK(n.is_valid());
+    return first_children_[n.index];
+  }
+
+  // Returns the next child of the parent of `n`, or `Node::Invalid` for the
+  // last child. For roots, this is the next root.
+  [[nodiscard]] auto next_sibling(Node n) const -> Node {
+    CARBON_CHECK(n.is_valid());
+    return next_siblings_[n.index];
+  }
+
+  // Returns the first child of `n` of the given kind, or `Node::Invalid` if
+  // there is none.
+  [[nodiscard]] auto FindChild(Node n, NodeKind kind) const -> Node;
+
+  // Returns the node for `token`, or `Node::Invalid` if the token was skipped
+  // by error recovery.
+  [[nodiscard]] auto GetNodeForToken(Lex::Token token) const -> Node {
+    CARBON_CHECK(token.index >= 0 &&
+                 token.index < static_cast<int>(token_nodes_.size()))
+        << "Token " << token << " isn't in the tree's token buffer.";
+    return token_nodes_[token.index];
+  }
+
+ private:
+  const Tree* tree_;
+
+  // Each of these is indexed by the node's postorder index.
+  llvm::SmallVector<Node> parents_;
+  llvm::SmallVector<Node> first_children_;
+  llvm::SmallVector<Node> next_siblings_;
+
+  // The node for each token, indexed by the token's index.
+  llvm::SmallVector<Node> token_nodes_;
+};
+
+}  // namespace Carbon::Parse
+
+#endif  // CARBON_TOOLCHAIN_PARSE_TREE_INDEX_H_
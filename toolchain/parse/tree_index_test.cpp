@@ -0,0 +1,102 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "toolchain/parse/tree_index.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "toolchain/diagnostics/diagnostic_emitter.h"
+#include "toolchain/lex/tokenized_buffer.h"
+#include "toolchain/parse/tree.h"
+
+namespace Carbon::Parse {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class TreeIndexTest : public ::testing::Test {
+ protected:
+  auto Parse(llvm::StringRef text) -> const Tree& {
+    CARBON_CHECK(fs_.addFile("test.carbon", /*ModificationTime=*/0,
+                             llvm::MemoryBuffer::getMemBuffer(text)));
+    source_ = SourceBuffer::CreateFromFile(fs_, "test.carbon", consumer_);
+    tokens_ = Lex::TokenizedBuffer::Lex(*source_, consumer_);
+    tree_ = Tree::Parse(*tokens_, consumer_, /*vlog_stream=*/nullptr);
+    return *tree_;
+  }
+
+  // Returns the children of `n` as found by following the index's links.
+  static auto IndexChildren(const TreeIndex& index, Node n)
+      -> llvm::SmallVector<Node> {
+    llvm::SmallVector<Node> children;
+    for (Node child = index.first_child(n); child.is_valid();
+         child = index.next_sibling(child)) {
+      EXPECT_EQ(index.parent(child), n);
+      children.push_back(child);
+    }
+    return children;
+  }
+
+  llvm::vfs::InMemoryFileSystem fs_;
+  DiagnosticConsumer& consumer_ = ConsoleDiagnosticConsumer();
+  std::optional<SourceBuffer> source_;
+  std::optional<Lex::TokenizedBuffer> tokens_;
+  std::optional<Tree> tree_;
+};
+
+TEST_F(TreeIndexTest, MatchesTree) {
+  const Tree& tree = Parse(R"carbon(
+    namespace N;
+    fn N.F(a: i32, b: i32) -> i32 {
+      var c: i32 = (a + b) * 2;
+      return c;
+    }
+    class C { fn G[self: Self]() {} }
+  )carbon");
+  ASSERT_FALSE(tree.has_errors());
+  TreeIndex index(tree);
+
+  for (Node n : tree.postorder()) {
+    auto children = llvm::to_vector(tree.children(n));
+    std::reverse(children.begin(), children.end());
+    EXPECT_THAT(IndexChildren(index, n), ElementsAreArray(children));
+    EXPECT_EQ(index.GetNodeForToken(tree.node_token(n)), n);
+  }
+
+  auto roots = llvm::to_vector(tree.roots());
+  std::reverse(roots.begin(), roots.end());
+  llvm::SmallVector<Node> index_roots;
+  for (Node root = roots.front(); root.is_valid();
+       root = index.next_sibling(root)) {
+    EXPECT_FALSE(index.parent(root).is_valid());
+    index_roots.push_back(root);
+  }
+  EXPECT_THAT(index_roots, ElementsAreArray(roots));
+}
+
+TEST_F(TreeIndexTest, FindChild) {
+  const Tree& tree = Parse("fn F() {}");
+  ASSERT_FALSE(tree.has_errors());
+  TreeIndex index(tree);
+
+  // The nodes are FileStart, FunctionIntroducer, Name, ParameterListStart,
+  // ParameterList, FunctionDefinitionStart, FunctionDefinition and FileEnd.
+  Node start(5);
+  ASSERT_EQ(tree.node_kind(start), NodeKind::FunctionDefinitionStart);
+  Node name = index.FindChild(start, NodeKind::Name);
+  ASSERT_TRUE(name.is_valid());
+  EXPECT_EQ(tree.GetNodeText(name), "F");
+  EXPECT_EQ(index.parent(name), start);
+  EXPECT_EQ(index.parent(start), Node(6));
+  EXPECT_FALSE(index.FindChild(start, NodeKind::ReturnType).is_valid());
+  EXPECT_FALSE(index.first_child(name).is_valid());
+}
+
+}  // namespace
+}  // namespace Carbon::Parse
@@ -130,5 +130,53 @@ TEST_F(TreeTest, HighRecursion) {
   EXPECT_FALSE(tree.has_errors());
 }
 
+// Returns code with enough declarations to be parsed in parallel.
+static auto ManyDeclarations(llvm::StringRef last_declaration) -> std::string {
+  std::string code = "package P api;\n";
+  llvm::raw_string_ostream out(code);
+  for (int i = 0; i < 2000; ++i) {
+    out << "fn F" << i << "(x: i32) -> i32 { return (x + " << i << "); }\n";
+    out << "var v" << i << ": i32 = " << i << ";\n";
+  }
+  out << last_declaration;
+  return code;
+}
+
+TEST_F(TreeTest, ParallelMatchesSequential) {
+  std::string code = ManyDeclarations("");
+  Lex::TokenizedBuffer& tokens = GetTokenizedBuffer(code);
+  ASSERT_FALSE(tokens.has_errors());
+  Testing::MockDiagnosticConsumer consumer;
+  Tree sequential = Tree::Parse(tokens, consumer, /*vlog_stream=*/nullptr);
+  Tree parallel = Tree::Parse(tokens, consumer, /*vlog_stream=*/nullptr,
+                              /*num_threads=*/4);
+  EXPECT_FALSE(parallel.has_errors());
+  TestRawOstream sequential_stream;
+  sequential.Print(sequential_stream);
+  TestRawOstream parallel_stream;
+  parallel.Print(parallel_stream);
+  EXPECT_EQ(parallel_stream.TakeStr(), sequential_stream.TakeStr());
+}
+
+TEST_F(TreeTest, ParallelFallsBackOnErrors) {
+  std::string code = ManyDeclarations("fn G() { return }\n");
+  Lex::TokenizedBuffer& tokens = GetTokenizedBuffer(code);
+  ASSERT_FALSE(tokens.has_errors());
+  // Errors are only diagnosed by the sequential parse, so they're the same
+  // with and without threads.
+  TestRawOstream sequential_stream;
+  StreamDiagnosticConsumer sequential_consumer(sequential_stream);
+  Tree sequential =
+      Tree::Parse(tokens, sequential_consumer, /*vlog_stream=*/nullptr);
+  TestRawOstream parallel_stream;
+  StreamDiagnosticConsumer parallel_consumer(parallel_stream);
+  Tree parallel = Tree::Parse(tokens, parallel_consumer,
+                              /*vlog_stream=*/nullptr, /*num_threads=*/4);
+  EXPECT_TRUE(parallel.has_errors());
+  std::string sequential_diagnostics = sequential_stream.TakeStr();
+  EXPECT_FALSE(sequential_diagnostics.empty());
+  EXPECT_EQ(parallel_stream.TakeStr(), sequential_diagnostics);
+}
+
 }  // namespace
 }  // namespace Carbon::Parse
@@ -530,7 +530,9 @@ auto GetExpressionCategory(const File& file, NodeId node_id)
   }
 }
 
-auto GetValueRepresentation(const File& file, TypeId type_id)
+// Computes the value representation of a type by walking the nodes that
+// describe it. This is done once per type, by `File::AddType`.
+static auto ComputeValueRepresentation(const File& file, TypeId type_id)
     -> ValueRepresentation {
   const File* ir = &file;
   NodeId node_id = ir->GetTypeAllowBuiltinTypes(type_id);
@@ -662,9 +664,10 @@ auto GetValueRepresentation(const File& file, TypeId type_id)
   }
 }
 
-auto GetInitializingRepresentation(const File& file, TypeId type_id)
+// Computes the initializing representation of a type from its value
+// representation.
+static auto ComputeInitializingRepresentation(ValueRepresentation value_rep)
     -> InitializingRepresentation {
-  auto value_rep = GetValueRepresentation(file, type_id);
   switch (value_rep.kind) {
     case ValueRepresentation::None:
       return {.kind = InitializingRepresentation::None};
@@ -680,4 +683,35 @@ auto GetInitializingRepresentation(const File& file, TypeId type_id)
   }
 }
 
+auto File::AddType(NodeId node_id) -> TypeId {
+  TypeId type_id(types_.size());
+  // Should never happen, will always overflow node_ids first.
+  CARBON_DCHECK(type_id.index >= 0);
+  types_.push_back(node_id);
+  auto value_rep = ComputeValueRepresentation(*this, type_id);
+  type_infos_.push_back(
+      {.value_representation = value_rep,
+       .initializing_representation =
+           ComputeInitializingRepresentation(value_rep)});
+  return type_id;
+}
+
+auto GetValueRepresentation(const File& file, TypeId type_id)
+    -> ValueRepresentation {
+  // The builtin TypeType and Error types aren't in the type table.
+  if (type_id.index < 0) {
+    return ComputeValueRepresentation(file, type_id);
+  }
+  return file.GetTypeInfo(type_id).value_representation;
+}
+
+auto GetInitializingRepresentation(const File& file, TypeId type_id)
+    -> InitializingRepresentation {
+  if (type_id.index < 0) {
+    return ComputeInitializingRepresentation(
+        ComputeValueRepresentation(file, type_id));
+  }
+  return file.GetTypeInfo(type_id).initializing_representation;
+}
+
 }  // namespace Carbon::SemIR
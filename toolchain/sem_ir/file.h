@@ -68,6 +68,62 @@ struct Real : public Printable<Real> {
   bool is_decimal;
 };
 
+// The value representation to use when passing by value.
+struct ValueRepresentation {
+  enum Kind : int8_t {
+    // The type has no value representation. This is used for empty types, such
+    // as `()`, where there is no value.
+    None,
+    // The value representation is a copy of the value. On call boundaries, the
+    // value itself will be passed. `type` is the value type.
+    // TODO: `type` should be `const`-qualified, but is currently not.
+    Copy,
+    // The value representation is a pointer to an object. When used as a
+    // parameter, the argument is a reference expression. `type` is the pointee
+    // type.
+    // TODO: `type` should be `const`-qualified, but is currently not.
+    Pointer,
+    // The value representation has been customized, and has the same behavior
+    // as the value representation of some other type.
+    // TODO: This is not implemented or used yet.
+    Custom,
+  };
+  // The kind of value representation used by this type.
+  Kind kind;
+  // The type used to model the value representation.
+  TypeId type;
+};
+
+// The initializing representation to use when returning by value.
+struct InitializingRepresentation {
+  enum Kind : int8_t {
+    // The type has no initializing representation. This is used for empty
+    // types, where no initialization is necessary.
+    None,
+    // An initializing expression produces a value, which is copied into the
+    // initialized object.
+    ByCopy,
+    // An initializing expression takes a location as input, which is
+    // initialized as a side effect of evaluating the expression.
+    InPlace,
+    // TODO: Consider adding a kind where the expression takes an advisory
+    // location and returns a value plus an indicator of whether the location
+    // was actually initialized.
+  };
+  // The kind of initializing representation used by this type.
+  Kind kind;
+
+  // Returns whether a return slot is used when returning this type.
+  auto has_return_slot() const -> bool { return kind == InPlace; }
+};
+
+// Information about a type which is computed once, when the type is added to
+// the IR, so that later queries from checking and lowering are array lookups.
+struct TypeInfo {
+  ValueRepresentation value_representation;
+  InitializingRepresentation initializing_representation;
+};
+
 // Provides semantic analysis on a Parse::Tree.
 class File : public Printable<File> {
  public:
@@ -126,7 +182,7 @@ class File : public Printable<File> {
     IntegerId id(integers_.size());
     // TODO: Return failure on overflow instead of crashing.
     CARBON_CHECK(id.index >= 0);
-    integers_.push_back(integer);
+    integers_.push_back(std::move(integer));
     return id;
   }
 
@@ -269,14 +325,9 @@ class File : public Printable<File> {
     return strings_[string_id.index];
   }
 
-  // Adds a type, returning an ID to reference it.
-  auto AddType(NodeId node_id) -> TypeId {
-    TypeId type_id(types_.size());
-    // Should never happen, will always overflow node_ids first.
-    CARBON_DCHECK(type_id.index >= 0);
-    types_.push_back(node_id);
-    return type_id;
-  }
+  // Adds a type, returning an ID to reference it. The type's representation
+  // is computed here, so any types it's built from must already be added.
+  auto AddType(NodeId node_id) -> TypeId;
 
   // Gets the node ID for a type. This doesn't handle TypeType or InvalidType in
   // order to avoid a check; callers that need that should use
@@ -288,6 +339,14 @@ class File : public Printable<File> {
     return types_[type_id.index];
   }
 
+  // Gets the information computed for a type when it was added. As with
+  // GetType, TypeType and InvalidType aren't handled.
+  auto GetTypeInfo(TypeId type_id) const -> const TypeInfo& {
+    CARBON_CHECK(type_id.index >= 0)
+        << "Invalid argument for GetTypeInfo: " << type_id;
+    return type_infos_[type_id.index];
+  }
+
   auto GetTypeAllowBuiltinTypes(TypeId type_id) const -> NodeId {
     if (type_id == TypeId::TypeType) {
       return NodeId::BuiltinTypeType;
@@ -329,6 +388,7 @@ class File : public Printable<File> {
   auto functions_size() const -> int { return functions_.size(); }
   auto nodes_size() const -> int { return nodes_.size(); }
   auto node_blocks_size() const -> int { return node_blocks_.size(); }
+  auto name_scopes_size() const -> int { return name_scopes_.size(); }
 
   auto types() const -> llvm::ArrayRef<NodeId> { return types_; }
 
@@ -398,6 +458,9 @@ class File : public Printable<File> {
   // by lowering.
   llvm::SmallVector<NodeId> types_;
 
+  // Information about each type in types_, indexed in the same way.
+  llvm::SmallVector<TypeInfo> type_infos_;
+
   // Type blocks within the IR. These reference entries in types_. Storage for
   // the data is provided by allocator_.
   llvm::SmallVector<llvm::MutableArrayRef<TypeId>> type_blocks_;
@@ -443,59 +506,10 @@ enum class ExpressionCategory : int8_t {
 auto GetExpressionCategory(const File& file, NodeId node_id)
     -> ExpressionCategory;
 
-// The value representation to use when passing by value.
-struct ValueRepresentation {
-  enum Kind : int8_t {
-    // The type has no value representation. This is used for empty types, such
-    // as `()`, where there is no value.
-    None,
-    // The value representation is a copy of the value. On call boundaries, the
-    // value itself will be passed. `type` is the value type.
-    // TODO: `type` should be `const`-qualified, but is currently not.
-    Copy,
-    // The value representation is a pointer to an object. When used as a
-    // parameter, the argument is a reference expression. `type` is the pointee
-    // type.
-    // TODO: `type` should be `const`-qualified, but is currently not.
-    Pointer,
-    // The value representation has been customized, and has the same behavior
-    // as the value representation of some other type.
-    // TODO: This is not implemented or used yet.
-    Custom,
-  };
-  // The kind of value representation used by this type.
-  Kind kind;
-  // The type used to model the value representation.
-  TypeId type;
-};
-
 // Returns information about the value representation to use for a type.
 auto GetValueRepresentation(const File& file, TypeId type_id)
     -> ValueRepresentation;
 
-// The initializing representation to use when returning by value.
-struct InitializingRepresentation {
-  enum Kind : int8_t {
-    // The type has no initializing representation. This is used for empty
-    // types, where no initialization is necessary.
-    None,
-    // An initializing expression produces a value, which is copied into the
-    // initialized object.
-    ByCopy,
-    // An initializing expression takes a location as input, which is
-    // initialized as a side effect of evaluating the expression.
-    InPlace,
-    // TODO: Consider adding a kind where the expression takes an advisory
-    // location and returns a value plus an indicator of whether the location
-    // was actually initialized.
-  };
-  // The kind of initializing representation used by this type.
-  Kind kind;
-
-  // Returns whether a return slot is used when returning this type.
-  auto has_return_slot() const -> bool { return kind == InPlace; }
-};
-
 // Returns information about the initializing representation to use for a type.
 auto GetInitializingRepresentation(const File& file, TypeId type_id)
     -> InitializingRepresentation;
@@ -10,6 +10,9 @@
 #include "llvm/Support/VirtualFileSystem.h"
 #include "testing/base/test_raw_ostream.h"
 #include "toolchain/driver/driver.h"
+#include "toolchain/parse/tree.h"
+#include "toolchain/sem_ir/file.h"
+#include "toolchain/sem_ir/node.h"
 #include "toolchain/testing/yaml_test_helpers.h"
 
 namespace Carbon::SemIR {
@@ -79,5 +82,44 @@ TEST(SemIRTest, YAML) {
               IsYaml(ElementsAre(root)));
 }
 
+TEST(SemIRTest, TypeInfo) {
+  File builtins;
+  File file("test.carbon", &builtins);
+  auto add_tuple_type = [&](llvm::ArrayRef<TypeId> type_ids) {
+    return file.AddType(file.AddNodeInNoBlock(TupleType(
+        Parse::Node::Invalid, TypeId::TypeType, file.AddTypeBlock(type_ids))));
+  };
+
+  auto int_type = file.AddType(NodeId::BuiltinIntegerType);
+  auto empty_type = add_tuple_type({});
+  auto one_tuple_type = add_tuple_type({int_type});
+  auto pair_type = add_tuple_type({int_type, int_type});
+
+  const auto& int_info = file.GetTypeInfo(int_type);
+  EXPECT_EQ(int_info.value_representation.kind, ValueRepresentation::Copy);
+  EXPECT_EQ(int_info.value_representation.type, int_type);
+  EXPECT_EQ(int_info.initializing_representation.kind,
+            InitializingRepresentation::ByCopy);
+
+  EXPECT_EQ(file.GetTypeInfo(empty_type).value_representation.kind,
+            ValueRepresentation::None);
+  EXPECT_EQ(file.GetTypeInfo(empty_type).initializing_representation.kind,
+            InitializingRepresentation::None);
+
+  EXPECT_EQ(file.GetTypeInfo(one_tuple_type).value_representation.kind,
+            ValueRepresentation::Copy);
+
+  EXPECT_EQ(file.GetTypeInfo(pair_type).value_representation.kind,
+            ValueRepresentation::Pointer);
+  EXPECT_TRUE(file.GetTypeInfo(pair_type)
+                  .initializing_representation.has_return_slot());
+
+  // The free functions read the same table.
+  EXPECT_EQ(GetValueRepresentation(file, pair_type).kind,
+            ValueRepresentation::Pointer);
+  EXPECT_EQ(GetInitializingRepresentation(file, int_type).kind,
+            InitializingRepresentation::ByCopy);
+}
+
 }  // namespace
 }  // namespace Carbon::SemIR
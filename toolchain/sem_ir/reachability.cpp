@@ -0,0 +1,67 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "toolchain/sem_ir/reachability.h"
+
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/SmallVector.h"
+#include "toolchain/sem_ir/entry_point.h"
+#include "toolchain/sem_ir/node.h"
+
+namespace Carbon::SemIR {
+
+auto ComputeReachableFunctions(const File& file) -> llvm::BitVector {
+  llvm::BitVector reachable(file.functions_size());
+
+  // Only prune when the file is known to be in the `Main` package and its
+  // `Run` is known to be the entry point:
+  // - Check doesn't accept `package` directives yet, so a file without errors
+  //   has none and is in the `Main` package.
+  // - Functions don't record their enclosing namespace, so a `Run` might be
+  //   `N.Run` when the file declares any namespace.
+  // TODO: Use the file's package and the function's scope once SemIR records
+  // them.
+  if (file.has_errors() || file.name_scopes_size() > 0) {
+    reachable.set();
+    return reachable;
+  }
+
+  llvm::SmallVector<FunctionId> function_worklist;
+  for (auto i : llvm::seq(file.functions_size())) {
+    if (IsEntryPoint(file, FunctionId(i))) {
+      reachable.set(i);
+      function_worklist.push_back(FunctionId(i));
+    }
+  }
+
+  // TODO: Once there are access modifiers, use private functions of library
+  // files as roots only when they're used by other roots.
+  if (function_worklist.empty()) {
+    reachable.set();
+    return reachable;
+  }
+
+  llvm::SmallVector<NodeBlockId> block_worklist;
+  while (!function_worklist.empty()) {
+    const auto& function = file.GetFunction(function_worklist.pop_back_val());
+    block_worklist.append(function.body_block_ids.begin(),
+                          function.body_block_ids.end());
+    while (!block_worklist.empty()) {
+      for (auto node_id : file.GetNodeBlock(block_worklist.pop_back_val())) {
+        auto node = file.GetNode(node_id);
+        if (auto call = node.TryAs<Call>()) {
+          if (!reachable.test(call->function_id.index)) {
+            reachable.set(call->function_id.index);
+            function_worklist.push_back(call->function_id);
+          }
+        } else if (auto splice = node.TryAs<SpliceBlock>()) {
+          block_worklist.push_back(splice->block_id);
+        }
+      }
+    }
+  }
+  return reachable;
+}
+
+}  // namespace Carbon::SemIR
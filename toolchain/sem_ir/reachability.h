@@ -0,0 +1,25 @@
+// Part of the Carbon Language project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CARBON_TOOLCHAIN_SEM_IR_REACHABILITY_H_
+#define CARBON_TOOLCHAIN_SEM_IR_REACHABILITY_H_
+
+#include "llvm/ADT/BitVector.h"
+#include "toolchain/sem_ir/file.h"
+
+namespace Carbon::SemIR {
+
+// Returns the functions in `file` which can be called from outside it, either
+// directly or through other functions, indexed by FunctionId.
+//
+// A file which defines the program's entry point is in the `Main` package,
+// which can't be imported, so only the entry point is called from outside it.
+// In any other file, every function is externally visible. When the file
+// can't be shown to be in the `Main` package, every function is treated as
+// reachable.
+auto ComputeReachableFunctions(const File& file) -> llvm::BitVector;
+
+}  // namespace Carbon::SemIR
+
+#endif  // CARBON_TOOLCHAIN_SEM_IR_REACHABILITY_H_
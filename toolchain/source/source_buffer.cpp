@@ -18,6 +18,20 @@ struct FilenameTranslator : DiagnosticLocationTranslator<llvm::StringRef> {
 };
 }  // namespace
 
+// Diagnoses inputs that are too large for the toolchain to handle. Returns
+// false if the size is not supported.
+static auto CheckSize(DiagnosticEmitter<llvm::StringRef>& emitter,
+                      llvm::StringRef filename, int64_t size) -> bool {
+  if (size >= std::numeric_limits<int32_t>::max()) {
+    CARBON_DIAGNOSTIC(FileTooLarge, Error,
+                      "File is over the 2GiB input limit; size is {0} bytes.",
+                      int64_t);
+    emitter.Emit(filename, FileTooLarge, size);
+    return false;
+  }
+  return true;
+}
+
 auto SourceBuffer::CreateFromFile(llvm::vfs::FileSystem& fs,
                                   llvm::StringRef filename,
                                   DiagnosticConsumer& consumer)
@@ -42,11 +56,7 @@ auto SourceBuffer::CreateFromFile(llvm::vfs::FileSystem& fs,
     return std::nullopt;
   }
   int64_t size = status->getSize();
-  if (size >= std::numeric_limits<int32_t>::max()) {
-    CARBON_DIAGNOSTIC(FileTooLarge, Error,
-                      "File is over the 2GiB input limit; size is {0} bytes.",
-                      int64_t);
-    emitter.Emit(filename, FileTooLarge, size);
+  if (!CheckSize(emitter, filename, size)) {
     return std::nullopt;
   }
 
@@ -62,4 +72,19 @@ auto SourceBuffer::CreateFromFile(llvm::vfs::FileSystem& fs,
   return SourceBuffer(filename.str(), std::move(buffer.get()));
 }
 
+auto SourceBuffer::CreateFromText(llvm::StringRef text,
+                                  llvm::StringRef filename,
+                                  DiagnosticConsumer& consumer)
+    -> std::optional<SourceBuffer> {
+  FilenameTranslator translator;
+  DiagnosticEmitter<llvm::StringRef> emitter(translator, consumer);
+
+  if (!CheckSize(emitter, filename, text.size())) {
+    return std::nullopt;
+  }
+
+  return SourceBuffer(filename.str(),
+                      llvm::MemoryBuffer::getMemBufferCopy(text, filename));
+}
+
 }  // namespace Carbon
@@ -41,6 +41,13 @@ class SourceBuffer {
                              DiagnosticConsumer& consumer)
       -> std::optional<SourceBuffer>;
 
+  // Creates a buffer holding a copy of `text`, as if it had been read from a
+  // file named `filename`. This is used for text that isn't on disk, such as a
+  // document being edited. Prints an error and returns nullopt on failure.
+  static auto CreateFromText(llvm::StringRef text, llvm::StringRef filename,
+                             DiagnosticConsumer& consumer)
+      -> std::optional<SourceBuffer>;
+
   // Use one of the factory functions above to create a source buffer.
   SourceBuffer() = delete;
 
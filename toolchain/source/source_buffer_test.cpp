@@ -65,5 +65,17 @@ TEST(SourceBufferTest, EmptyFile) {
   EXPECT_EQ("", buffer->text());
 }
 
+TEST(SourceBufferTest, FromText) {
+  std::string text = "Hello World";
+  auto buffer = SourceBuffer::CreateFromText(text, TestFileName,
+                                             ConsoleDiagnosticConsumer());
+  ASSERT_TRUE(buffer);
+  // The buffer owns a copy of the text.
+  text = "Goodbye";
+
+  EXPECT_EQ(TestFileName, buffer->filename());
+  EXPECT_EQ("Hello World", buffer->text());
+}
+
 }  // namespace
 }  // namespace Carbon